@@ -89,7 +89,11 @@ typedef DSMap<LdsHash, SLdsCache>     CScriptCache;     // script cache map
 typedef DSList<ILdsValueBase *>       CLdsValueTypes;   // value type list
 
 // 64-bit integer
-typedef __int64 LONG64;
+#ifdef _MSC_VER
+  typedef __int64 LONG64;
+#else
+  typedef long long LONG64;
+#endif
 
 // I/O function types
 typedef void (*CLdsWriteFunc)(void *pStream, const void *pData, const LdsSize &iSize);
@@ -102,3 +106,6 @@ typedef void (*CLdsPrintFunc)(const char *);
 #include "LdsCompatibility.h"
 #include "LdsFormatting.h"
 #include "LdsCommon.h"
+#include "LdsBufferStream.h"
+#include "LdsFileWatcher.h"
+#include "LdsSymbols.h"
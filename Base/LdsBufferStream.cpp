@@ -0,0 +1,187 @@
+/* Copyright (c) 2021 Dreamy Cecil
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#include "StdH.h"
+#include "LdsBufferStream.h"
+
+#include <stdio.h>
+#include <string.h>
+
+// Free the buffer
+void CLdsBufferStream::Clear(void) {
+  if (bs_pData != NULL) {
+    delete[] bs_pData;
+  }
+
+  bs_pData = NULL;
+  bs_ctSize = 0;
+  bs_ctAllocated = 0;
+  bs_iPos = 0;
+  bs_bReading = false;
+};
+
+// Make sure the buffer can hold a certain amount of bytes
+void CLdsBufferStream::Reserve(const LdsSize &ctBytes) {
+  if (ctBytes <= bs_ctAllocated) {
+    return;
+  }
+
+  // grow in big steps to avoid reallocating on every write
+  LdsSize ctNew = (bs_ctAllocated > 0 ? bs_ctAllocated : 1024);
+
+  while (ctNew < ctBytes) {
+    // exact size if doubling would overflow
+    if (ctNew > ~LdsSize(0) / 2) {
+      ctNew = ctBytes;
+      break;
+    }
+
+    ctNew *= 2;
+  }
+
+  char *pNew = new char[ctNew];
+
+  if (bs_pData != NULL) {
+    memcpy(pNew, bs_pData, bs_ctSize);
+    delete[] bs_pData;
+  }
+
+  bs_pData = pNew;
+  bs_ctAllocated = ctNew;
+};
+
+// Write data at the end of the buffer
+void CLdsBufferStream::Write(const void *pData, const LdsSize &iSize) {
+  if (iSize > ~LdsSize(0) - bs_ctSize) {
+    LdsThrow(LER_WRITE, "Cannot write %lu more bytes into the buffer of %lu bytes", iSize, bs_ctSize);
+  }
+
+  Reserve(bs_ctSize + iSize);
+  bs_bReading = false;
+
+  memcpy(bs_pData + bs_ctSize, pData, iSize);
+  bs_ctSize += iSize;
+};
+
+// Read data from the current position
+void CLdsBufferStream::Read(void *pData, const LdsSize &iSize) {
+  bs_bReading = true;
+
+  if (iSize > bs_ctSize - bs_iPos) {
+    LdsThrow(LER_READ, "Cannot read %lu bytes at %lu (buffer size: %lu)", iSize, bs_iPos, bs_ctSize);
+  }
+
+  memcpy(pData, bs_pData + bs_iPos, iSize);
+  bs_iPos += iSize;
+};
+
+// Copy some data into the buffer
+void CLdsBufferStream::FromMemory(const void *pData, const LdsSize &ctBytes) {
+  bs_ctSize = 0;
+  bs_iPos = 0;
+
+  Write(pData, ctBytes);
+  bs_bReading = true;
+};
+
+// Write the whole buffer into another stream in one go
+void CLdsBufferStream::FlushTo(void *pStream, CLdsWriteFunc pWrite) {
+  if (bs_ctSize > 0) {
+    pWrite(pStream, bs_pData, bs_ctSize);
+  }
+};
+
+// Fill the buffer with some amount of bytes from another stream in one go
+void CLdsBufferStream::ReadFrom(void *pStream, CLdsReadFunc pRead, const LdsSize &ctBytes) {
+  bs_ctSize = 0;
+  bs_iPos = 0;
+
+  Reserve(ctBytes);
+
+  if (ctBytes > 0) {
+    pRead(pStream, bs_pData, ctBytes);
+  }
+
+  bs_ctSize = ctBytes;
+  bs_bReading = true;
+};
+
+// Save the buffer into a file
+bool CLdsBufferStream::SaveFile(const char *strFile) {
+  FILE *file = fopen(strFile, "wb");
+
+  if (file == NULL) {
+    return false;
+  }
+
+  bool bWritten = (fwrite(bs_pData, 1, bs_ctSize, file) == bs_ctSize);
+  fclose(file);
+
+  return bWritten;
+};
+
+// Load the buffer from a file
+bool CLdsBufferStream::LoadFile(const char *strFile) {
+  FILE *file = fopen(strFile, "rb");
+
+  if (file == NULL) {
+    return false;
+  }
+
+  // get file size
+  fseek(file, 0, SEEK_END);
+  long lSize = ftell(file);
+  fseek(file, 0, SEEK_SET);
+
+  bs_ctSize = 0;
+  bs_iPos = 0;
+  bs_bReading = true;
+
+  if (lSize < 0) {
+    fclose(file);
+    return false;
+  }
+
+  const LdsSize ctBytes = lSize;
+
+  if (ctBytes > 0) {
+    Reserve(ctBytes);
+    bs_ctSize = fread(bs_pData, 1, ctBytes, file);
+  }
+
+  fclose(file);
+
+  return (bs_ctSize == ctBytes);
+};
+
+// Write data into the buffer
+void LdsBufferWrite(void *pStream, const void *pData, const LdsSize &iSize) {
+  ((CLdsBufferStream *)pStream)->Write(pData, iSize);
+};
+
+// Read data from the buffer
+void LdsBufferRead(void *pStream, void *pData, const LdsSize &iSize) {
+  ((CLdsBufferStream *)pStream)->Read(pData, iSize);
+};
+
+// Get current position in the buffer
+int LdsBufferTell(void *pStream) {
+  return (int)((CLdsBufferStream *)pStream)->Tell();
+};
@@ -0,0 +1,89 @@
+/* Copyright (c) 2021 Dreamy Cecil
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#pragma once
+
+#include "LdsBase.h"
+
+// Growable memory buffer that can be used as a data stream
+class LDS_API CLdsBufferStream {
+  public:
+    char *bs_pData; // buffer data
+    LdsSize bs_ctSize; // amount of written bytes (writing position)
+    LdsSize bs_ctAllocated; // allocated bytes
+    LdsSize bs_iPos; // current reading position
+    bool bs_bReading; // the buffer is being read rather than written
+
+  public:
+    // Constructor
+    CLdsBufferStream(void) :
+      bs_pData(NULL), bs_ctSize(0), bs_ctAllocated(0), bs_iPos(0), bs_bReading(false) {};
+
+    // Destructor
+    ~CLdsBufferStream(void) {
+      Clear();
+    };
+
+    // Copy constructor (illegal)
+    CLdsBufferStream(const CLdsBufferStream &bsOther);
+
+    // Assignment (illegal)
+    CLdsBufferStream &operator=(const CLdsBufferStream &bsOther);
+
+    // Free the buffer
+    void Clear(void);
+
+    // Make sure the buffer can hold a certain amount of bytes
+    void Reserve(const LdsSize &ctBytes);
+
+    // Write data at the end of the buffer
+    void Write(const void *pData, const LdsSize &iSize);
+    // Read data from the current position
+    void Read(void *pData, const LdsSize &iSize);
+
+    // Move back to the beginning for reading
+    inline void Rewind(void) {
+      bs_iPos = 0;
+      bs_bReading = true;
+    };
+
+    // Current position of reading or writing, whichever has been done last
+    inline LdsSize Tell(void) const {
+      return (bs_bReading ? bs_iPos : bs_ctSize);
+    };
+
+    // Copy some data into the buffer
+    void FromMemory(const void *pData, const LdsSize &ctBytes);
+
+    // Write the whole buffer into another stream in one go
+    void FlushTo(void *pStream, CLdsWriteFunc pWrite);
+    // Fill the buffer with some amount of bytes from another stream in one go
+    void ReadFrom(void *pStream, CLdsReadFunc pRead, const LdsSize &ctBytes);
+
+    // Save the buffer into a file
+    bool SaveFile(const char *strFile);
+    // Load the buffer from a file
+    bool LoadFile(const char *strFile);
+};
+
+// Stream functions for the buffer (set via CLdsScriptEngine::LdsStreamFunctions)
+LDS_API void LdsBufferWrite(void *pStream, const void *pData, const LdsSize &iSize);
+LDS_API void LdsBufferRead(void *pStream, void *pData, const LdsSize &iSize);
+LDS_API int LdsBufferTell(void *pStream);
@@ -98,6 +98,11 @@ enum ELdsError {
   LEX_NOACCESS   = 0x6a, // no accessor reference
   LEX_NOFUNC     = 0x6b, // no function pointer
   LEX_CALL       = 0x6c, // external function error
+
+  LEX_QUOTABYTES   = 0x70, // memory limit exceeded
+  LEX_QUOTASTACK   = 0x71, // too many values on the stacks
+  LEX_QUOTACALLS   = 0x72, // too many inline calls within each other
+  LEX_QUOTAACTIONS = 0x73, // action limit exceeded
 };
 
 // LDS error
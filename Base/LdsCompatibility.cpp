@@ -23,6 +23,23 @@ SOFTWARE. */
 
 #include <fstream>
 
+#ifdef PLATFORM_UNIX
+  #include <time.h>
+#else
+  #include <windows.h>
+#endif
+
+// Processor timestamp counter
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+  #include <intrin.h>
+  #define LDS_RDTSC 1
+#elif defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+  #include <x86intrin.h>
+  #define LDS_RDTSC 1
+#else
+  #define LDS_RDTSC 0
+#endif
+
 // Standard script loading
 bool LdsLoadScriptFile(const char *strFile, string &strScript) {
   std::ifstream strm;
@@ -68,6 +85,38 @@ int LdsFileTell(void *pStream) {
   return ftell(file);
 };
 
+// Get time in seconds from a high-resolution monotonic clock
+double LdsGetTime(void) {
+#ifdef PLATFORM_UNIX
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return double(ts.tv_sec) + double(ts.tv_nsec) * 1e-9;
+
+#else
+  static LARGE_INTEGER liFrequency = { 0 };
+
+  if (liFrequency.QuadPart == 0) {
+    QueryPerformanceFrequency(&liFrequency);
+  }
+
+  LARGE_INTEGER liCounter;
+  QueryPerformanceCounter(&liCounter);
+
+  return double(liCounter.QuadPart) / double(liFrequency.QuadPart);
+#endif
+};
+
+// Get cheap timestamp for measuring very short periods (units depend on the platform)
+LONG64 LdsGetTicks(void) {
+#if LDS_RDTSC
+  return (LONG64)__rdtsc();
+
+#else
+  return LONG64(LdsGetTime() * 1e9);
+#endif
+};
+
 // Add new value type
 void CLdsScriptEngine::AddValueType(const ILdsValueBase &val) {
   _ldsValueTypes.Add() = val.MakeCopy();
@@ -77,7 +126,7 @@ void CLdsScriptEngine::AddValueType(const ILdsValueBase &val) {
 void CLdsScriptEngine::LdsOutputFunctions(void *pPrint, void *pError) {
   // reset to standard printing function
   if (pPrint == NULL) {
-    pPrint = LDS_pLogFunction;
+    pPrint = (void *)LDS_pLogFunction;
   }
   _pLdsPrintFunction = (void (*)(const char *))pPrint;
 
@@ -95,6 +144,11 @@ void CLdsScriptEngine::LdsStreamFunctions(void *pWrite, void *pRead, void *pTell
   _pLdsStreamTell = (int (*)(void *))pTell;
 };
 
+// Use buffer stream functions
+void CLdsScriptEngine::LdsBufferStreamFunctions(void) {
+  LdsStreamFunctions((void *)LdsBufferWrite, (void *)LdsBufferRead, (void *)LdsBufferTell);
+};
+
 // Print out formatted string
 void CLdsScriptEngine::LdsOut(const char *strFormat, ...) {
   va_list arg;
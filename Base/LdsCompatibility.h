@@ -43,3 +43,8 @@ LDS_API void LdsWriteFile(void *pStream, const void *pData, const LdsSize &iSize
 LDS_API void LdsReadFile(void *pStream, void *pData, const LdsSize &iSize);
 // Get current position in a file
 LDS_API int LdsFileTell(void *pStream);
+
+// Get time in seconds from a high-resolution monotonic clock
+LDS_API double LdsGetTime(void);
+// Get cheap timestamp for measuring very short periods (units depend on the platform)
+LDS_API LONG64 LdsGetTicks(void);
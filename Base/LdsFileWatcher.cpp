@@ -0,0 +1,201 @@
+/* Copyright (c) 2021 Dreamy Cecil
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#include "StdH.h"
+#include "LdsFileWatcher.h"
+
+#include <sys/stat.h>
+
+#if defined(PLATFORM_UNIX) && defined(__linux__)
+  #define LDS_INOTIFY
+
+  #include <unistd.h>
+  #include <sys/inotify.h>
+#endif
+
+// Get last modification time of a file (0 if it doesn't exist)
+static LONG64 FileModified(const char *strFile) {
+  struct stat st;
+
+  if (stat(strFile, &st) != 0) {
+    return 0;
+  }
+
+  return (LONG64)st.st_mtime;
+};
+
+// Split path into the directory and the file name
+static void SplitPath(const string &strFile, string &strDir, string &strName) {
+  size_t iSlash = strFile.find_last_of("/\\");
+
+  if (iSlash == string::npos) {
+    strDir = ".";
+    strName = strFile;
+    return;
+  }
+
+  strDir = strFile.substr(0, iSlash + 1);
+  strName = strFile.substr(iSlash + 1);
+};
+
+// Constructor
+CLdsFileWatcher::CLdsFileWatcher(void) : fw_iNotify(-1) {
+#ifdef LDS_INOTIFY
+  fw_iNotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#endif
+};
+
+// Stop watching all files
+void CLdsFileWatcher::Clear(void) {
+  while (fw_aFiles.Count() > 0) {
+    RemoveFile(fw_aFiles[fw_aFiles.Count() - 1].wf_strFile.c_str());
+  }
+
+#ifdef LDS_INOTIFY
+  if (fw_iNotify != -1) {
+    close(fw_iNotify);
+    fw_iNotify = -1;
+  }
+#endif
+};
+
+// Find watched file
+int CLdsFileWatcher::FindFile(const string &strFile) {
+  for (int iFile = 0; iFile < fw_aFiles.Count(); iFile++) {
+    if (fw_aFiles[iFile].wf_strFile == strFile) {
+      return iFile;
+    }
+  }
+
+  return -1;
+};
+
+// Start watching a file
+bool CLdsFileWatcher::AddFile(const char *strFile) {
+  // already watching
+  if (FindFile(strFile) != -1) {
+    return true;
+  }
+
+  SLdsWatchedFile wf;
+  wf.wf_strFile = strFile;
+  wf.wf_llModified = FileModified(strFile);
+
+  string strDir;
+  SplitPath(wf.wf_strFile, strDir, wf.wf_strName);
+
+#ifdef LDS_INOTIFY
+  // watch the directory instead of the file because editors often replace files when saving them
+  if (fw_iNotify != -1) {
+    wf.wf_iWatch = inotify_add_watch(fw_iNotify, strDir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+
+    if (wf.wf_iWatch == -1) {
+      return false;
+    }
+  }
+#endif
+
+  fw_aFiles.Add() = wf;
+  return true;
+};
+
+// Stop watching a file
+void CLdsFileWatcher::RemoveFile(const char *strFile) {
+  int iFile = FindFile(strFile);
+
+  if (iFile == -1) {
+    return;
+  }
+
+  int iWatch = fw_aFiles[iFile].wf_iWatch;
+  fw_aFiles.Delete(iFile);
+
+#ifdef LDS_INOTIFY
+  if (iWatch == -1 || fw_iNotify == -1) {
+    return;
+  }
+
+  // directory is still used by other files
+  for (int iOther = 0; iOther < fw_aFiles.Count(); iOther++) {
+    if (fw_aFiles[iOther].wf_iWatch == iWatch) {
+      return;
+    }
+  }
+
+  inotify_rm_watch(fw_iNotify, iWatch);
+#endif
+};
+
+// Get files that have changed since the last check without waiting (returns amount of files)
+int CLdsFileWatcher::Poll(DSList<string> &astrChanged) {
+  const int ctFiles = fw_aFiles.Count();
+  int iFile;
+
+  // files that have changed
+  DSList<int> aiChanged;
+
+#ifdef LDS_INOTIFY
+  if (fw_iNotify != -1) {
+    // read all pending events
+    char aBuffer[4096];
+    int ctRead;
+
+    while ((ctRead = read(fw_iNotify, aBuffer, sizeof(aBuffer))) > 0) {
+      int iOffset = 0;
+
+      while (iOffset < ctRead) {
+        const struct inotify_event *pEvent = (const struct inotify_event *)(aBuffer + iOffset);
+        iOffset += sizeof(struct inotify_event) + pEvent->len;
+
+        if (pEvent->len <= 0) {
+          continue;
+        }
+
+        // match the file in the directory
+        for (iFile = 0; iFile < ctFiles; iFile++) {
+          SLdsWatchedFile &wf = fw_aFiles[iFile];
+
+          if (wf.wf_iWatch == pEvent->wd && wf.wf_strName == pEvent->name && aiChanged.FindIndex(iFile) == -1) {
+            aiChanged.Add() = iFile;
+          }
+        }
+      }
+    }
+  } else
+#endif
+  {
+    // compare modification times
+    for (iFile = 0; iFile < ctFiles; iFile++) {
+      SLdsWatchedFile &wf = fw_aFiles[iFile];
+      LONG64 llModified = FileModified(wf.wf_strFile.c_str());
+
+      if (llModified != wf.wf_llModified) {
+        wf.wf_llModified = llModified;
+        aiChanged.Add() = iFile;
+      }
+    }
+  }
+
+  for (iFile = 0; iFile < aiChanged.Count(); iFile++) {
+    astrChanged.Add() = fw_aFiles[aiChanged[iFile]].wf_strFile;
+  }
+
+  return aiChanged.Count();
+};
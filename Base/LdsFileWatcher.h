@@ -0,0 +1,70 @@
+/* Copyright (c) 2021 Dreamy Cecil
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#pragma once
+
+#include "LdsBase.h"
+
+// Watched script file
+struct LDS_API SLdsWatchedFile {
+  string wf_strFile; // path to the file
+  string wf_strName; // file name within the directory
+  int wf_iWatch; // watch descriptor of the directory (-1 if polling)
+  LONG64 wf_llModified; // last modification time (only used when polling)
+
+  // Constructor
+  SLdsWatchedFile(void) : wf_iWatch(-1), wf_llModified(0) {};
+};
+
+// Watcher for changes in script files (inotify on Linux, modification time polling elsewhere)
+class LDS_API CLdsFileWatcher {
+  public:
+    DSList<SLdsWatchedFile> fw_aFiles; // watched files
+
+  private:
+    int fw_iNotify; // inotify instance (-1 if polling)
+
+  public:
+    // Constructor
+    CLdsFileWatcher(void);
+
+    // Destructor
+    ~CLdsFileWatcher(void) {
+      Clear();
+    };
+
+    // Assignment (illegal)
+    CLdsFileWatcher &operator=(const CLdsFileWatcher &fwOther);
+
+    // Stop watching all files
+    void Clear(void);
+
+    // Start watching a file
+    bool AddFile(const char *strFile);
+    // Stop watching a file
+    void RemoveFile(const char *strFile);
+
+    // Get files that have changed since the last check without waiting (returns amount of files)
+    int Poll(DSList<string> &astrChanged);
+
+  private:
+    // Find watched file
+    int FindFile(const string &strFile);
+};
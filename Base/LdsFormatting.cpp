@@ -24,6 +24,10 @@ SOFTWARE. */
 // Don't notify about '_vsnprintf'
 #pragma warning(disable: 4996)
 
+#ifndef _MSC_VER
+  #define _vsnprintf vsnprintf
+#endif
+
 // Resize raw string
 void LdsResizeString(char **pMem, int ctSize) {
   char *pNew = new char[ctSize];
@@ -20,16 +20,20 @@ SOFTWARE. */
 
 #include "StdH.h"
 
+#include <string.h>
+
 // Compiled scripts I/O
 
 // Write program
 void CLdsScriptEngine::LdsWriteProgram(void *pStream, CLdsProgram &pgProgram) {
-  int ctActions = pgProgram.acaProgram.Count();
+  CActionList &aca = pgProgram.Actions();
+
+  int ctActions = aca.Count();
   _pLdsWrite(pStream, &ctActions, sizeof(int));
 
   // for each action
   for (int iAction = 0; iAction < ctActions; iAction++) {
-    LdsWriteAction(pStream, pgProgram.acaProgram[iAction]);
+    LdsWriteAction(pStream, aca[iAction]);
   }
 };
 
@@ -38,15 +42,162 @@ void CLdsScriptEngine::LdsReadProgram(void *pStream, CLdsProgram &pgProgram) {
   int ctActions = 0;
   _pLdsRead(pStream, &ctActions, sizeof(int));
 
+  CActionList &aca = pgProgram.Modify();
+
   // for each action
   for (int iAction = 0; iAction < ctActions; iAction++) {
     CCompAction caAction;
     LdsReadAction(pStream, caAction);
 
-    pgProgram.acaProgram.Add() = caAction;
+    aca.Add() = caAction;
+  }
+
+  // reject malformed programs before they can be executed
+  try {
+    pgProgram.Verify();
+
+  } catch (SLdsError leError) {
+    LdsThrow(LER_READ, "Cannot read malformed program: %s", leError.le_strMessage.c_str());
   }
 };
 
+// Hash shared actions of some program
+static inline unsigned int HashProgramData(const SLdsProgramData *pData) {
+  size_t iAddress = (size_t)pData;
+  return (unsigned int)(iAddress ^ (iAddress >> 16)) * 2654435761U;
+};
+
+// Find slot for the program with some shared actions
+static int FindProgramSlot(DSArray<int> &aiSlots, DSList<CLdsProgram> &apgTable, const SLdsProgramData *pData) {
+  // amount of slots is always a power of two
+  const int iMask = aiSlots.Count() - 1;
+  int iSlot = HashProgramData(pData) & iMask;
+
+  while (true) {
+    int iProgram = aiSlots[iSlot];
+
+    // empty slot or the same actions
+    if (iProgram == -1 || apgTable[iProgram].SharedData() == pData) {
+      return iSlot;
+    }
+
+    iSlot = (iSlot + 1) & iMask;
+  }
+};
+
+// Resize hash slots and put all programs from the table into them
+static void RehashProgramTable(DSArray<int> &aiSlots, DSList<CLdsProgram> &apgTable, const int &ctSlots) {
+  aiSlots.Clear();
+  aiSlots.New(ctSlots);
+
+  int iSlot;
+
+  for (iSlot = 0; iSlot < ctSlots; iSlot++) {
+    aiSlots[iSlot] = -1;
+  }
+
+  for (int iProgram = 0; iProgram < apgTable.Count(); iProgram++) {
+    const SLdsProgramData *pData = apgTable[iProgram].SharedData();
+
+    // empty programs are never shared
+    if (pData == NULL) {
+      continue;
+    }
+
+    iSlot = FindProgramSlot(aiSlots, apgTable, pData);
+
+    // keep the first one if the same program has been read twice
+    if (aiSlots[iSlot] == -1) {
+      aiSlots[iSlot] = iProgram;
+    }
+  }
+};
+
+// Start using the program table
+void CLdsScriptEngine::LdsBeginProgramTable(void) {
+  if (_ctProgramTableUsers++ <= 0) {
+    _apgProgramTable.Clear();
+    _aiProgramSlots.Clear();
+  }
+};
+
+// Stop using the program table
+void CLdsScriptEngine::LdsEndProgramTable(void) {
+  if (--_ctProgramTableUsers <= 0) {
+    _ctProgramTableUsers = 0;
+    _apgProgramTable.Clear();
+    _aiProgramSlots.Clear();
+  }
+};
+
+// Write program through the program table
+void CLdsScriptEngine::LdsWriteProgramRef(void *pStream, CLdsProgram &pgProgram) {
+  // no table
+  if (_ctProgramTableUsers <= 0) {
+    LdsWriteProgram(pStream, pgProgram);
+    return;
+  }
+
+  // keep slots at most half full
+  if (_aiProgramSlots.Count() < (_apgProgramTable.Count() + 1) * 2) {
+    RehashProgramTable(_aiProgramSlots, _apgProgramTable, _aiProgramSlots.Count() > 0 ? _aiProgramSlots.Count() * 2 : 64);
+  }
+
+  // find the same program
+  const SLdsProgramData *pData = pgProgram.SharedData();
+  int iSlot = -1;
+  int iProgram = -1;
+
+  if (pData != NULL) {
+    iSlot = FindProgramSlot(_aiProgramSlots, _apgProgramTable, pData);
+    iProgram = _aiProgramSlots[iSlot];
+  }
+
+  // write program index
+  _pLdsWrite(pStream, &iProgram, sizeof(int));
+
+  // write new program (added before writing the actions to keep the same order as when reading)
+  if (iProgram == -1) {
+    if (iSlot != -1) {
+      _aiProgramSlots[iSlot] = _apgProgramTable.Count();
+    }
+
+    _apgProgramTable.Add() = pgProgram;
+    LdsWriteProgram(pStream, pgProgram);
+  }
+};
+
+// Read program through the program table
+void CLdsScriptEngine::LdsReadProgramRef(void *pStream, CLdsProgram &pgProgram) {
+  // no table
+  if (_ctProgramTableUsers <= 0) {
+    LdsReadProgram(pStream, pgProgram);
+    return;
+  }
+
+  // read program index
+  int iProgram = -1;
+  _pLdsRead(pStream, &iProgram, sizeof(int));
+
+  // read new program
+  if (iProgram == -1) {
+    iProgram = _apgProgramTable.Count();
+    _apgProgramTable.Add();
+
+    CLdsProgram pgRead;
+    LdsReadProgram(pStream, pgRead);
+
+    _apgProgramTable[iProgram] = pgRead;
+  }
+
+  if (iProgram < 0 || iProgram >= _apgProgramTable.Count()) {
+    LdsThrow(LER_READ, "Cannot read program %d (%d/%d) at %d!", iProgram, iProgram + 1, _apgProgramTable.Count(), _pLdsStreamTell(pStream));
+  }
+
+  // share the program
+  pgProgram = _apgProgramTable[iProgram];
+};
+
 // Write action
 void CLdsScriptEngine::LdsWriteAction(void *pStream, CCompAction &caAction) {
   // write type and position
@@ -56,8 +207,8 @@ void CLdsScriptEngine::LdsWriteAction(void *pStream, CCompAction &caAction) {
   // write certain action
   switch (caAction.lt_eType) {
     // all data
-    case LCA_VAL: case LCA_BIN: case LCA_VAR:
-    case LCA_CALL: case LCA_INLINE:
+    case LCA_VAL: case LCA_BIN: case LCA_BIN_NUM: case LCA_VAR:
+    case LCA_CALL: case LCA_INLINE: case LCA_TAILCALL:
     case LCA_SET: case LCA_GET: case LCA_DIR:
       LdsWriteValue(pStream, caAction.lt_valValue);
       _pLdsWrite(pStream, &caAction.lt_iArg, sizeof(int));
@@ -77,6 +228,7 @@ void CLdsScriptEngine::LdsWriteAction(void *pStream, CCompAction &caAction) {
     // only argument
     case LCA_JUMP: case LCA_JUMPUNLESS: case LCA_JUMPIF:
     case LCA_AND: case LCA_OR: case LCA_SWITCH:
+    case LCA_SWITCH_TABLE:
       _pLdsWrite(pStream, &caAction.lt_iArg, sizeof(int));
       break;
 
@@ -98,8 +250,8 @@ void CLdsScriptEngine::LdsReadAction(void *pStream, CCompAction &caAction) {
   // read certain action
   switch (caAction.lt_eType) {
     // all data
-    case LCA_VAL: case LCA_BIN: case LCA_VAR:
-    case LCA_CALL: case LCA_INLINE:
+    case LCA_VAL: case LCA_BIN: case LCA_BIN_NUM: case LCA_VAR:
+    case LCA_CALL: case LCA_INLINE: case LCA_TAILCALL:
     case LCA_SET: case LCA_GET: case LCA_DIR:
       LdsReadValue(pStream, caAction.lt_valValue);
       _pLdsRead(pStream, &caAction.lt_iArg, sizeof(int));
@@ -119,6 +271,7 @@ void CLdsScriptEngine::LdsReadAction(void *pStream, CCompAction &caAction) {
     // only argument
     case LCA_JUMP: case LCA_JUMPUNLESS: case LCA_JUMPIF:
     case LCA_AND: case LCA_OR: case LCA_SWITCH:
+    case LCA_SWITCH_TABLE:
       _pLdsRead(pStream, &caAction.lt_iArg, sizeof(int));
       break;
 
@@ -155,7 +308,7 @@ void CLdsScriptEngine::LdsWriteInlineFunc(void *pStream, SLdsInlineFunc &inFunc)
   }
 
   // write the function
-  LdsWriteProgram(pStream, inFunc.in_pgFunc);
+  LdsWriteProgramRef(pStream, inFunc.in_pgFunc);
 };
 
 // Read inline function
@@ -189,7 +342,7 @@ void CLdsScriptEngine::LdsReadInlineFunc(void *pStream, SLdsInlineFunc &inFunc)
   }
 
   // read the function
-  LdsReadProgram(pStream, inFunc.in_pgFunc);
+  LdsReadProgramRef(pStream, inFunc.in_pgFunc);
 };
 
 // Script values I/O
@@ -375,23 +528,56 @@ void CLdsScriptEngine::LdsReadString(void *pStream, string &str) {
   int ctLen = 0;
   _pLdsRead(pStream, &ctLen, sizeof(int));
 
-  // make a new string
-  char *strRead = new char[ctLen + 1];
-  strRead[ctLen] = 0;
-      
-  // read the string
-  _pLdsRead(pStream, strRead, sizeof(char) * ctLen);
+  if (ctLen < 0) {
+    LdsThrow(LER_READ, "Cannot read string of length %d at %d!", ctLen, _pLdsStreamTell(pStream));
+  }
 
-  str = strRead;
+  // read the string directly
+  str.resize(ctLen);
 
-  // discard the string
-  delete[] strRead;
+  if (ctLen > 0) {
+    _pLdsRead(pStream, &str[0], sizeof(char) * ctLen);
+  }
 };
 
 // Current scripts I/O
 
+// Stream format signature
+static const char _aStreamID[4] = { 'L', 'D', 'S', 'V' };
+
+// Write format version of engine and thread streams
+void CLdsScriptEngine::LdsWriteStreamVersion(void *pStream) {
+  int iVersion = LDS_STREAM_VERSION;
+
+  _pLdsWrite(pStream, _aStreamID, sizeof(_aStreamID));
+  _pLdsWrite(pStream, &iVersion, sizeof(int));
+};
+
+// Check format version of engine and thread streams
+void CLdsScriptEngine::LdsReadStreamVersion(void *pStream) {
+  char aID[4] = { 0, 0, 0, 0 };
+  _pLdsRead(pStream, aID, sizeof(aID));
+
+  // streams from before versioning start with other data
+  if (memcmp(aID, _aStreamID, sizeof(aID)) != 0) {
+    LdsThrow(LER_READ, "Unversioned engine or thread stream at %d!", _pLdsStreamTell(pStream));
+  }
+
+  int iVersion = 0;
+  _pLdsRead(pStream, &iVersion, sizeof(int));
+
+  if (iVersion != LDS_STREAM_VERSION) {
+    LdsThrow(LER_READ, "Unsupported stream version %d (expected %d)!", iVersion, LDS_STREAM_VERSION);
+  }
+};
+
 // Write the script engine
 void CLdsScriptEngine::LdsWriteEngine(void *pStream) {
+  LdsWriteStreamVersion(pStream);
+
+  // share programs between threads
+  SLdsProgramTableScope ptsScope(this);
+
   // write script caching
   char bCaching = _bUseScriptCaching;
   _pLdsWrite(pStream, &bCaching, sizeof(char));
@@ -412,7 +598,7 @@ void CLdsScriptEngine::LdsWriteEngine(void *pStream) {
       // write compiled program
       SLdsCache &scCache = mapCache.GetValue(iCache);
 
-      LdsWriteProgram(pStream, scCache.pgCache);
+      LdsWriteProgramRef(pStream, scCache.pgCache);
 
       char bExpression = scCache.bExpression;
       _pLdsWrite(pStream, &bExpression, sizeof(char));
@@ -450,6 +636,11 @@ void CLdsScriptEngine::LdsWriteEngine(void *pStream) {
 
 // Read the script engine
 void CLdsScriptEngine::LdsReadEngine(void *pStream) {
+  LdsReadStreamVersion(pStream);
+
+  // share programs between threads
+  SLdsProgramTableScope ptsScope(this);
+
   // read script caching
   char bCaching = false;
   _pLdsRead(pStream, &bCaching, sizeof(char));
@@ -469,7 +660,7 @@ void CLdsScriptEngine::LdsReadEngine(void *pStream) {
 
       // read compiled program
       CLdsProgram pgCache;
-      LdsReadProgram(pStream, pgCache);
+      LdsReadProgramRef(pStream, pgCache);
 
       char bExpression = false;
       _pLdsRead(pStream, &bExpression, sizeof(char));
@@ -520,6 +711,11 @@ void CLdsScriptEngine::LdsWriteThread(void *pStream, CLdsThread &sth, bool bHand
     return;
   }
 
+  LdsWriteStreamVersion(pStream);
+
+  // share programs between inline calls
+  SLdsProgramTableScope ptsScope(this);
+
   // write status and error
   char iStatus = sth.sth_eStatus;
   int iError = sth.sth_eError;
@@ -530,7 +726,7 @@ void CLdsScriptEngine::LdsWriteThread(void *pStream, CLdsThread &sth, bool bHand
   _pLdsWrite(pStream, &sth.sth_iPos, sizeof(int));
 
   // write executed action count
-  _pLdsWrite(pStream, &sth.sth_ctActions, sizeof(int));
+  _pLdsWrite(pStream, &sth.sth_ctActions, sizeof(LONG64));
 
   // write the result
   LdsWriteValue(pStream, sth.sth_valResult);
@@ -610,11 +806,11 @@ void CLdsScriptEngine::LdsWriteThread(void *pStream, CLdsThread &sth, bool bHand
     }
 
     // write program to return
-    LdsWriteProgram(pStream, icCall.pgReturn);
+    LdsWriteProgramRef(pStream, icCall.pgReturn);
   }
 
   // write thread program
-  LdsWriteProgram(pStream, sth.sth_pgProgram);
+  LdsWriteProgramRef(pStream, sth.sth_pgProgram);
 
   // write handler if needed
   if (bHandler) {
@@ -637,6 +833,11 @@ void CLdsScriptEngine::LdsReadThread(void *pStream, CLdsThread &sth, bool bHandl
   // set as this engine's thread
   sth.sth_pldsEngine = this;
 
+  LdsReadStreamVersion(pStream);
+
+  // share programs between inline calls
+  SLdsProgramTableScope ptsScope(this);
+
   // read status and error
   char iStatus = -1;
   int iError = -1;
@@ -650,7 +851,7 @@ void CLdsScriptEngine::LdsReadThread(void *pStream, CLdsThread &sth, bool bHandl
   _pLdsRead(pStream, &sth.sth_iPos, sizeof(int));
 
   // read executed action count
-  _pLdsRead(pStream, &sth.sth_ctActions, sizeof(int));
+  _pLdsRead(pStream, &sth.sth_ctActions, sizeof(LONG64));
 
   // read the result
   LdsReadValue(pStream, sth.sth_valResult);
@@ -746,14 +947,14 @@ void CLdsScriptEngine::LdsReadThread(void *pStream, CLdsThread &sth, bool bHandl
     }
 
     // read program to return
-    LdsReadProgram(pStream, icCall.pgReturn);
+    LdsReadProgramRef(pStream, icCall.pgReturn);
 
     // add inline call
     sth.sth_aicCalls.Push() = icCall;
   }
 
   // read thread program
-  LdsReadProgram(pStream, sth.sth_pgProgram);
+  LdsReadProgramRef(pStream, sth.sth_pgProgram);
 
   // read handler if needed
   if (bHandler) {
@@ -0,0 +1,72 @@
+/* Copyright (c) 2021 Dreamy Cecil
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#include "StdH.h"
+
+// Names of counted value types
+static const char *_astrCountedTypes[EVT_LAST + 1] = {
+  "integer", "float", "string", "array", "object", "custom",
+};
+
+// Print one allocation counter
+static string PrintCounter(const char *strName, const SLdsAllocCounter &ac) {
+  return LdsPrintF("  %-10s %12lld live %12lld total %12lld peak\n", strName, ac.ac_ctLive, ac.ac_ctTotal, ac.ac_ctPeak);
+};
+
+// Add approximate memory used by all threads of the engine
+void CLdsScriptEngine::LdsMemoryUsage(SLdsMemoryUsage &mu) {
+  for (int iThread = 0; iThread < _athhThreadHandlers.Count(); iThread++) {
+    CLdsThread *psth = _athhThreadHandlers[iThread].psthThread;
+
+    if (psth != NULL) {
+      psth->MemoryUsage(mu);
+    }
+  }
+};
+
+// Make a report of script allocations and memory used by the threads
+string CLdsScriptEngine::LdsMemoryReport(void) {
+  string strReport = "Allocations:\n";
+
+  for (int iType = 0; iType <= EVT_LAST; iType++) {
+    strReport += PrintCounter(_astrCountedTypes[iType], LDS_alAllocs.al_aacTypes[iType]);
+  }
+
+  strReport += PrintCounter("values", LDS_alAllocs.al_acValues);
+  strReport += PrintCounter("variables", LDS_alAllocs.al_acVars);
+  strReport += PrintCounter("programs", LDS_alAllocs.al_acPrograms);
+
+  // memory of running threads
+  SLdsMemoryUsage mu;
+  LdsMemoryUsage(mu);
+
+  strReport += LdsPrintF("\nMemory used by %d threads:\n", mu.mu_ctThreads);
+  strReport += LdsPrintF("  programs %12lu bytes\n", mu.mu_iPrograms);
+  strReport += LdsPrintF("  stacks   %12lu bytes\n", mu.mu_iStacks);
+  strReport += LdsPrintF("  locals   %12lu bytes\n", mu.mu_iLocals);
+  strReport += LdsPrintF("  calls    %12lu bytes\n", mu.mu_iCalls);
+  strReport += LdsPrintF("  total    %12lu bytes\n", mu.Total());
+
+  if (_bMeasureMemory) {
+    strReport += LdsPrintF("  peak     %12lu bytes (all threads together)\n", _iPeakMemory);
+  }
+
+  return strReport;
+};
@@ -0,0 +1,92 @@
+/* Copyright (c) 2021 Dreamy Cecil
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#pragma once
+
+#include "../Values/LdsValue.h"
+
+// Allocation counters of some kind of objects
+struct LDS_API SLdsAllocCounter {
+  LONG64 ac_ctLive; // objects that exist right now
+  LONG64 ac_ctTotal; // objects that have ever been created
+  LONG64 ac_ctPeak; // highest amount of objects that existed at once
+
+  // Constructor
+  SLdsAllocCounter(void) : ac_ctLive(0), ac_ctTotal(0), ac_ctPeak(0) {};
+
+  // Count a new object
+  inline void Alloc(void) {
+    ac_ctTotal++;
+
+    if (++ac_ctLive > ac_ctPeak) {
+      ac_ctPeak = ac_ctLive;
+    }
+  };
+
+  // Count a deleted object
+  inline void Free(void) {
+    ac_ctLive--;
+  };
+};
+
+// Allocation counters of everything that scripts create
+struct LDS_API SLdsAllocStats {
+  SLdsAllocCounter al_aacTypes[EVT_LAST + 1]; // values by their type (custom types are counted together in the last one)
+  SLdsAllocCounter al_acValues; // values of all types
+  SLdsAllocCounter al_acVars; // variables, array values and object properties
+  SLdsAllocCounter al_acPrograms; // unique copies of compiled actions
+
+  // Counter of some value type
+  inline SLdsAllocCounter &Type(const int &iType) {
+    return al_aacTypes[(iType >= 0 && iType < EVT_LAST) ? iType : EVT_LAST];
+  };
+
+  // Count a new value
+  inline void AddValue(const int &iType) {
+    Type(iType).Alloc();
+    al_acValues.Alloc();
+  };
+
+  // Count a deleted value
+  inline void RemoveValue(const int &iType) {
+    Type(iType).Free();
+    al_acValues.Free();
+  };
+};
+
+// Allocations of the whole process (values aren't bound to any engine)
+LDS_API extern SLdsAllocStats LDS_alAllocs;
+
+// Approximate memory used by script threads in bytes
+struct LDS_API SLdsMemoryUsage {
+  LdsSize mu_iPrograms; // compiled actions of programs and inline functions
+  LdsSize mu_iStacks; // values on the stacks
+  LdsSize mu_iLocals; // local variables
+  LdsSize mu_iCalls; // inline function calls
+  int mu_ctThreads; // amount of counted threads
+
+  // Constructor
+  SLdsMemoryUsage(void) : mu_iPrograms(0), mu_iStacks(0), mu_iLocals(0), mu_iCalls(0), mu_ctThreads(0) {};
+
+  // Memory used by everything
+  inline LdsSize Total(void) const {
+    return mu_iPrograms + mu_iStacks + mu_iLocals + mu_iCalls;
+  };
+};
@@ -36,6 +36,42 @@ struct LDS_API SLdsCache {
   };
 };
 
+// Format version of engine and thread streams
+// (programs are shared through the program table since version 2, executed actions are 64-bit since version 3)
+#define LDS_STREAM_VERSION 3
+
+// Default limit of nodes in inline functions that get expanded at call sites
+#define LDS_INLINE_NODES 32
+
+// Compilation statistics
+struct LDS_API SLdsCompileStats {
+  int cs_ctCompiled; // amount of compilations
+  int cs_ctCacheHits; // programs taken from the script cache
+  int cs_ctCacheMisses; // programs compiled with script caching enabled
+  int cs_ctErrors; // failed compilations
+
+  double cs_dParseTime; // time spent parsing in seconds
+  double cs_dBuildTime; // time spent building nodes in seconds
+  double cs_dCompileTime; // time spent compiling nodes in seconds
+  double cs_dTotalTime; // time spent in total in seconds
+
+  int cs_ctTokens; // amount of parsed tokens
+  int cs_ctNodes; // amount of built nodes
+  int cs_ctActions; // amount of compiled actions
+  int cs_iPeakMemory; // estimated peak memory of tokens, nodes and actions in bytes (highest one when combined)
+
+  // Constructor
+  SLdsCompileStats(void) {
+    Clear();
+  };
+
+  // Reset statistics
+  void Clear(void);
+
+  // Combine with other statistics
+  void Add(const SLdsCompileStats &csOther);
+};
+
 class LDS_API CLdsScriptEngine {
   // Compatibility
   public:
@@ -73,6 +109,8 @@ class LDS_API CLdsScriptEngine {
 
     // Set stream functions
     void LdsStreamFunctions(void *pWrite, void *pRead, void *pTell);
+    // Use CLdsBufferStream as a data stream
+    void LdsBufferStreamFunctions(void);
 
     // Compiled scripts I/O
 
@@ -88,6 +126,25 @@ class LDS_API CLdsScriptEngine {
     void LdsWriteInlineFunc(void *pStream, SLdsInlineFunc &inFunc);
     void LdsReadInlineFunc(void *pStream, SLdsInlineFunc &inFunc);
 
+    // Program table for sharing programs between threads and inline calls
+    DSList<CLdsProgram> _apgProgramTable; // programs written or read so far
+    DSArray<int> _aiProgramSlots; // hash slots with indices of written programs by their shared actions (-1 if empty)
+    int _ctProgramTableUsers; // amount of active users of the table
+
+    // Start and stop using the program table (it's cleared when nothing uses it)
+    void LdsBeginProgramTable(void);
+    void LdsEndProgramTable(void);
+
+    // Write and read programs through the program table (same as LdsWriteProgram/LdsReadProgram without it)
+    void LdsWriteProgramRef(void *pStream, CLdsProgram &pgProgram);
+    void LdsReadProgramRef(void *pStream, CLdsProgram &pgProgram);
+
+    // Write and read flat program images
+    void LdsWriteImage(void *pStream, CLdsProgram &pgProgram);
+    void LdsReadImage(void *pStream, CLdsProgramImage &piImage);
+    // Expand validated image into a program
+    void LdsLoadImage(CLdsProgramImage &piImage, CLdsProgram &pgProgram);
+
     // Script values I/O
 
     // Write and read one variable
@@ -108,6 +165,10 @@ class LDS_API CLdsScriptEngine {
 
     // Current scripts I/O
 
+    // Write and check format version of engine and thread streams (throws LER_READ if it's different)
+    void LdsWriteStreamVersion(void *pStream);
+    void LdsReadStreamVersion(void *pStream);
+
     // Write and read the script engine (always called before thread I/O)
     void LdsWriteEngine(void *pStream);
     void LdsReadEngine(void *pStream);
@@ -115,6 +176,30 @@ class LDS_API CLdsScriptEngine {
     // Write and read threads
     void LdsWriteThread(void *pStream, CLdsThread &sth, bool bHandler);
     void LdsReadThread(void *pStream, CLdsThread &sth, bool bHandler);
+
+    // Snapshots I/O
+
+    int _iStateVersion; // version of the last written or read snapshot
+    int _iNextThreadID; // ID for the next created thread
+    int _ctSnapshotCache; // amount of cached scripts at the last snapshot
+
+    // Mark variable as changed since the last snapshot
+    inline void MarkChanged(SLdsVar &var) {
+      var.var_iVersion = _iStateVersion + 1;
+    };
+
+    // Write full snapshot of the engine state or only changes since the last snapshot
+    void LdsWriteSnapshot(void *pStream, bool bDelta);
+    // Read full or delta snapshot and apply it to the engine state
+    void LdsReadSnapshot(void *pStream);
+    // Apply delta snapshots to the base snapshot and write the result as a new base (doesn't change the engine state)
+    void LdsCompactSnapshots(void *pBase, void **apDeltas, const int &ctDeltas, void *pOut);
+
+  private:
+    // Write snapshot of a certain version
+    void LdsWriteSnapshotVersion(void *pStream, bool bDelta, const int &iVersion);
+    // Delete all threads and their handlers
+    void LdsDeleteThreads(void);
     
   // Functions
   public:
@@ -142,34 +227,45 @@ class LDS_API CLdsScriptEngine {
     void SetCustomVariables(CLdsVars &aFrom);
     // Add more variables and replace ones that already exist
     void AddCustomVariables(CLdsVars &aFrom);
+    // Mark all variables as changed since the last snapshot
+    void MarkAllChanged(void);
   
   // Parser
   public:
     CLdsMap _mapLdsConstants; // custom constants
+    CLdsSymbolTable _stSymbols; // unique identifier names (symbol IDs are arguments of identifier tokens)
 
     CLdsFuncPtrMap _mapLdsDefUnary; // default unary operators
     CLdsFuncPtrMap _mapLdsUnaryOps; // custom unary operators
+    DSList<string> _astrDefPureUnary; // default unary operators without side effects
+    DSList<string> _astrPureUnary; // custom unary operators without side effects
     
     // Set custom constants
     void SetParserConstants(CLdsMap &mapFrom);
 
-    // Set custom unary operators
-    void SetUnaryOperators(CLdsFuncPtrMap &mapFrom);
+    // Set custom unary operators (pure ones can be computed during compilation)
+    void SetUnaryOperators(CLdsFuncPtrMap &mapFrom, bool bPure = false);
     // Add more operators and replace ones that already exist
-    void AddUnaryOperators(CLdsFuncPtrMap &mapFrom);
+    void AddUnaryOperators(CLdsFuncPtrMap &mapFrom, bool bPure = false);
+
+    // Check if the unary operator always gives the same result for the same value and has no side effects
+    bool PureUnaryOperator(const string &strOperator);
+    // Check if the function call can be computed during compilation
+    bool PureFunction(const string &strFunc);
     
   private:
     CTokenList _aetTokens; // tokens from the script
 
     // Parse the script
-    void ParseScript(string strScript);
+    void ParseScript(const string &strScript);
 
     // Add one token to the list
     void AddParserToken(const ELdsToken &eType, const int &iPos);
-    void AddParserToken(const ELdsToken &eType, const int &iPos, const CLdsValue &valValue);
+    void AddParserToken(const ELdsToken &eType, const int &iPos, const CLdsValue &valValue, const int &iArg = -1);
     
   // Builder
   private:
+    CBuildNodeArena _bnaNodes; // all build nodes of the current compilation
     CBuildNode _bnNode; // current build node
     int _iBuildPos; // current node index
     int _ctBuildLen; // amount of nodes
@@ -181,6 +277,8 @@ class LDS_API CLdsScriptEngine {
     
     // Main builder
     void LdsBuild(bool bExpression);
+    // Free all build nodes at once
+    void LdsFreeBuild(void);
 
     // Build statement
     void StatementBuilder(void);
@@ -204,19 +302,55 @@ class LDS_API CLdsScriptEngine {
   public:
     CScriptCache _mapScriptCache; // cached scripts by their hash value (used in I/O)
     bool _bUseScriptCaching; // cache scripts or not
+
+    bool _bCompileStats; // record statistics of every compilation
+    SLdsCompileStats _csCompileStats; // combined statistics of all recorded compilations
+
+    int _ctInlineNodes; // expand calls to inline functions with up to this many nodes in their body (0 to disable)
     
-    // General compilation
-    ELdsError LdsCompileGeneral(const string &strSource, CLdsProgram &pgProgram, const bool &bExpression);
+    // General compilation (records statistics if asked for them or if enabled for the engine)
+    ELdsError LdsCompileGeneral(const string &strSource, CLdsProgram &pgProgram, const bool &bExpression, SLdsCompileStats *pcsStats = NULL);
     
     // Compile the script
-    ELdsError LdsCompileScript(const string &strScript, CLdsProgram &pgProgram);
+    ELdsError LdsCompileScript(const string &strScript, CLdsProgram &pgProgram, SLdsCompileStats *pcsStats = NULL);
     // Compile the expression
-    ELdsError LdsCompileExpression(const string &strExpression, CLdsProgram &pgProgram);
+    ELdsError LdsCompileExpression(const string &strExpression, CLdsProgram &pgProgram, SLdsCompileStats *pcsStats = NULL);
 
     // Cache a certain script
     void LdsCacheScript(const string &strScript, CLdsProgram &pgProgram);
 
+  // Hot reload
+  public:
+    DSMap<string, CLdsProgram> _mapScriptFiles; // compiled script files by their paths
+
+    // Load and compile the script file and remember it for reloading
+    ELdsError LdsCompileFile(const char *strFile, CLdsProgram &pgProgram);
+    // Recompile the script file and move paused threads to the new program (returns amount of moved threads or -1 on error)
+    int LdsReloadFile(const char *strFile);
+    // Reload all changed script files from the watcher (returns amount of reloaded files)
+    int LdsReloadChanged(CLdsFileWatcher &fwWatcher);
+
+  // Transpiler
+  public:
+    // Transpile compiled program into C++ source of a script function (throws LER_WRITE if it can't be transpiled)
+    void LdsTranspileProgram(CLdsProgram &pgProgram, const string &strFunc, const CLdsInlineArgs &astrArgs, string &strSource);
+    // Compile the script and transpile it into C++ source of a script function
+    ELdsError LdsTranspileScript(const string &strScript, const string &strFunc, const CLdsInlineArgs &astrArgs, string &strSource);
+
   private:
+    CDynamicNodeList _apbnHoisted; // expressions that have been computed before their loops in the current compilation
+    DSList<string> _astrHoisted; // hidden local variables that hold values of hoisted expressions
+    int _ctHoisted; // amount of hoisted expressions in the current compilation
+
+    bool _bFuncBody; // compiling the body of an inline function definition
+    DSMap<string, CBuildNode *> _mapInlineBodies; // bodies of inline functions that can be expanded at call sites
+    DSList<string> _astrExpanding; // inline functions that are being expanded right now (innermost last)
+    DSList<string> _astrExpandedLocals; // local variables of the functions that are being expanded ("func:var")
+    DSMap<string, int> _mapVarTypes; // inferred types of local variables by their names
+
+    // Pass statistics to the caller and add them to the engine statistics
+    void LdsRecordStats(const SLdsCompileStats &cs, SLdsCompileStats *pcsStats);
+
     // Get the variable
     void CompileGetter(CBuildNode &bn, CActionList &aca);
     // Set the variable
@@ -227,6 +361,26 @@ class LDS_API CLdsScriptEngine {
     void CompileJumpShift(CActionList &aca, int iStart, int iShift);
     // Accessors
     void CompileAccessors(CBuildNode &bn, CActionList &aca, bool bSet);
+    // Expand inline function call in place (returns false if it can't be expanded)
+    bool CompileInlineCall(CBuildNode &bn, CActionList &aca);
+    // Compute loop-invariant expressions before the loop
+    void CompileInvariants(CDynamicNodeList &apbnInvariants, CActionList &aca);
+    // Stop using values of expressions that have been hoisted out of the loop
+    void ForgetInvariants(const int &ctKeep);
+    // Forget about optimizations of the previous compilation
+    void ResetCompileState(void);
+    // Local variable name within the function that is being expanded
+    string ExpandedLocal(const string &strVar);
+    // Type of the expression value
+    int ExpressionType(CBuildNode &bn);
+    // Merge another possible type of the variable (returns true if it has changed)
+    bool MergeVarType(const string &strVar, const int &iType);
+    // Merge types of values assigned to variables (returns true if any type has changed)
+    bool GatherVarTypes(CBuildNode &bn);
+    // Infer types of local variables from values that are assigned to them
+    void InferVarTypes(CBuildNode &bnRoot);
+    // Compute repeated pure function calls of the statement once (returns amount of values to keep after the statement)
+    int CompileCommonCalls(CBuildNode &bn, CActionList &aca);
 
     // Compile nodes recursively
     void Compile(CBuildNode &bn, CActionList &aca);
@@ -245,9 +399,39 @@ class LDS_API CLdsScriptEngine {
     DSList<SLdsHandler> _athhThreadHandlers;
     int _iThreadTickRate; // how many ticks to wait per second (higher = more precise)
     LONG64 _llCurrentTick; // current timer tick (used in I/O)
+    int _ctJitHits; // compile hot loops and inline functions into native code after this many hits (0 to disable)
+
+    bool _bProfileActions; // record time spent in each action type and script position
+    CLdsProfile _pfActions; // recorded action profile
+    CLdsSampler _smpStacks; // sampled call stacks of running threads
+
+    bool _bProfileCalls; // record time spent in native functions
+    CLdsCallProfile _cpCalls; // recorded native function calls
+
+    CLdsTrace _trcActions; // latest actions of each thread in binary records
+    bool _bMeasureMemory; // measure memory of threads during limit checks even without memory limits
+    LdsSize _iPeakMemory; // highest approximate memory used by all threads of this engine together in bytes
+
+    SLdsQuota _qtThreads; // execution limits of each new thread
+    SLdsQuota _qtEngine; // execution limits of all threads together (only memory and actions)
+    LdsSize _iQuotaMemory; // approximate memory used by all threads during their last measurements
+    LONG64 _ctQuotaActions; // actions executed by all threads with execution limits
   
     // Create a new thread
     CLdsThread *ThreadCreate(const CLdsProgram &pgProgram, CLdsVars &aArgs);
+
+    // Make a report of the action profile sorted by self time (0 entries for all of them)
+    string LdsProfileReport(const int &ctEntries);
+    // Make a report of native function calls as text or JSON
+    string LdsCallReport(const bool &bJson);
+
+    // Write traced actions of all threads into a data stream (see LdsDecodeTrace)
+    void LdsWriteTrace(void *pStream);
+
+    // Add approximate memory used by all threads of the engine
+    void LdsMemoryUsage(SLdsMemoryUsage &mu);
+    // Make a report of script allocations and memory used by the threads
+    string LdsMemoryReport(void);
     
   public:
     // Constructor
@@ -261,6 +445,10 @@ class LDS_API CLdsScriptEngine {
       _pLdsWrite(LdsWriteFile),
       _pLdsRead(LdsReadFile),
       _pLdsStreamTell((int (*)(void *))LdsFileTell),
+      _ctProgramTableUsers(0),
+      _iStateVersion(0),
+      _iNextThreadID(0),
+      _ctSnapshotCache(0),
       
       // Builder
       _iBuildPos(0),
@@ -270,10 +458,21 @@ class LDS_API CLdsScriptEngine {
 
       // Compiler
       _bUseScriptCaching(false),
+      _bCompileStats(false),
+      _ctInlineNodes(LDS_INLINE_NODES),
+      _ctHoisted(0),
+      _bFuncBody(false),
       
       // Threads
       _iThreadTickRate(64),
-      _llCurrentTick(0)
+      _llCurrentTick(0),
+      _ctJitHits(LDS_JIT_HITS),
+      _bProfileActions(false),
+      _bProfileCalls(false),
+      _bMeasureMemory(false),
+      _iPeakMemory(0),
+      _iQuotaMemory(0),
+      _ctQuotaActions(0)
     {
       // set default functions and variables
       SetDefaultFunctions();
@@ -302,13 +501,7 @@ class LDS_API CLdsScriptEngine {
       }
       
       // delete remaining threads
-      int ctThreads = _athhThreadHandlers.Count();
-
-      while (--ctThreads >= 0) {
-        delete _athhThreadHandlers[ctThreads].psthThread;
-      }
-
-      _athhThreadHandlers.Clear();
+      LdsDeleteThreads();
     };
 
     // Assignment (illegal)
@@ -320,3 +513,18 @@ class LDS_API CLdsScriptEngine {
     // Get handler index of some thread if it exists
     int ThreadHandlerIndex(CLdsThread *psth);
 };
+
+// Program table usage within a scope
+struct SLdsProgramTableScope {
+  CLdsScriptEngine *pts_plds;
+
+  // Constructor
+  SLdsProgramTableScope(CLdsScriptEngine *plds) : pts_plds(plds) {
+    pts_plds->LdsBeginProgramTable();
+  };
+
+  // Destructor
+  ~SLdsProgramTableScope(void) {
+    pts_plds->LdsEndProgramTable();
+  };
+};
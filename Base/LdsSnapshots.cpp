@@ -0,0 +1,382 @@
+/* Copyright (c) 2021 Dreamy Cecil
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#include "StdH.h"
+
+#include <string.h>
+
+// Snapshot signature
+static const char _aSnapshotID[4] = { 'L', 'D', 'S', 'S' };
+
+// Write full snapshot of the engine state or only changes since the last snapshot
+void CLdsScriptEngine::LdsWriteSnapshot(void *pStream, bool bDelta) {
+  // nothing to compare against
+  if (_iStateVersion <= 0) {
+    bDelta = false;
+  }
+
+  LdsWriteSnapshotVersion(pStream, bDelta, _iStateVersion + 1);
+};
+
+// Write snapshot of a certain version
+void CLdsScriptEngine::LdsWriteSnapshotVersion(void *pStream, bool bDelta, const int &iVersion) {
+  // write snapshot header
+  _pLdsWrite(pStream, _aSnapshotID, sizeof(_aSnapshotID));
+
+  char bWriteDelta = bDelta;
+  int iPrevious = (bDelta ? _iStateVersion : -1);
+
+  _pLdsWrite(pStream, &bWriteDelta, sizeof(char));
+  _pLdsWrite(pStream, &iVersion, sizeof(int));
+  _pLdsWrite(pStream, &iPrevious, sizeof(int));
+
+  // write next thread ID
+  _pLdsWrite(pStream, &_iNextThreadID, sizeof(int));
+
+  int ctThreads = _athhThreadHandlers.Count();
+  int ctCached = _mapScriptCache.Count();
+
+  // full snapshot
+  if (!bDelta) {
+    // write thread IDs in order
+    _pLdsWrite(pStream, &ctThreads, sizeof(int));
+
+    for (int iThread = 0; iThread < ctThreads; iThread++) {
+      _pLdsWrite(pStream, &_athhThreadHandlers[iThread].psthThread->sth_iID, sizeof(int));
+    }
+
+    // write the whole engine
+    LdsWriteEngine(pStream);
+
+    _iStateVersion = iVersion;
+    _ctSnapshotCache = ctCached;
+    return;
+  }
+
+  // share programs between cached scripts and threads
+  SLdsProgramTableScope ptsScope(this);
+
+  // write script caching
+  char bCaching = _bUseScriptCaching;
+  _pLdsWrite(pStream, &bCaching, sizeof(char));
+
+  // write new cached scripts (all of them if the cache has been reset)
+  int iFirstCache = (ctCached >= _ctSnapshotCache ? _ctSnapshotCache : 0);
+  char bResetCache = (iFirstCache == 0);
+
+  _pLdsWrite(pStream, &bResetCache, sizeof(char));
+
+  int ctNewCache = ctCached - iFirstCache;
+  _pLdsWrite(pStream, &ctNewCache, sizeof(int));
+
+  for (int iCache = iFirstCache; iCache < ctCached; iCache++) {
+    LdsHash iHash = _mapScriptCache.GetKey(iCache);
+    _pLdsWrite(pStream, &iHash, sizeof(LdsHash));
+
+    SLdsCache &scCache = _mapScriptCache.GetValue(iCache);
+    LdsWriteProgramRef(pStream, scCache.pgCache);
+
+    char bExpression = scCache.bExpression;
+    _pLdsWrite(pStream, &bExpression, sizeof(char));
+  }
+
+  // write variable count
+  int ctVars = _aLdsVariables.Count();
+  _pLdsWrite(pStream, &ctVars, sizeof(int));
+
+  // count changed variables
+  int iVar;
+  int ctChanged = 0;
+
+  for (iVar = 0; iVar < ctVars; iVar++) {
+    if (_aLdsVariables[iVar].var_iVersion > _iStateVersion) {
+      ctChanged++;
+    }
+  }
+
+  _pLdsWrite(pStream, &ctChanged, sizeof(int));
+
+  // write changed variables with their indices
+  for (iVar = 0; iVar < ctVars; iVar++) {
+    if (_aLdsVariables[iVar].var_iVersion <= _iStateVersion) {
+      continue;
+    }
+
+    _pLdsWrite(pStream, &iVar, sizeof(int));
+    LdsWriteOneVar(pStream, _aLdsVariables, iVar);
+  }
+
+  // write current tick
+  _pLdsWrite(pStream, &_llCurrentTick, sizeof(LONG64));
+
+  // write paused threads
+  _pLdsWrite(pStream, &ctThreads, sizeof(int));
+
+  for (int iThread = 0; iThread < ctThreads; iThread++) {
+    SLdsHandler &thh = _athhThreadHandlers[iThread];
+    CLdsThread &sth = *thh.psthThread;
+
+    // write ID and wait times
+    _pLdsWrite(pStream, &sth.sth_iID, sizeof(int));
+    _pLdsWrite(pStream, &thh.llStartTime, sizeof(LONG64));
+    _pLdsWrite(pStream, &thh.llEndTime, sizeof(LONG64));
+
+    // write the thread only if it has changed
+    char bChanged = (sth.sth_iVersion > _iStateVersion);
+    _pLdsWrite(pStream, &bChanged, sizeof(char));
+
+    if (bChanged) {
+      LdsWriteThread(pStream, sth, false);
+    }
+  }
+
+  _iStateVersion = iVersion;
+  _ctSnapshotCache = ctCached;
+};
+
+// Read full or delta snapshot and apply it to the engine state
+void CLdsScriptEngine::LdsReadSnapshot(void *pStream) {
+  // read snapshot header
+  char aID[4] = { 0, 0, 0, 0 };
+  _pLdsRead(pStream, aID, sizeof(aID));
+
+  if (memcmp(aID, _aSnapshotID, sizeof(aID)) != 0) {
+    LdsThrow(LER_READ, "Invalid snapshot signature at %d!", _pLdsStreamTell(pStream));
+  }
+
+  char bDelta = false;
+  int iVersion = 0;
+  int iPrevious = -1;
+
+  _pLdsRead(pStream, &bDelta, sizeof(char));
+  _pLdsRead(pStream, &iVersion, sizeof(int));
+  _pLdsRead(pStream, &iPrevious, sizeof(int));
+
+  // deltas should be applied in order
+  if (bDelta && iPrevious != _iStateVersion) {
+    LdsThrow(LER_READ, "Snapshot %d is based on snapshot %d but the current state is %d!", iVersion, iPrevious, _iStateVersion);
+  }
+
+  // read next thread ID
+  int iNextThreadID = 0;
+  _pLdsRead(pStream, &iNextThreadID, sizeof(int));
+
+  int i, ct;
+
+  // full snapshot
+  if (!bDelta) {
+    // read thread IDs
+    ct = 0;
+    _pLdsRead(pStream, &ct, sizeof(int));
+
+    DSList<int> aiIDs;
+
+    for (i = 0; i < ct; i++) {
+      _pLdsRead(pStream, &aiIDs.Add(), sizeof(int));
+    }
+
+    // replace the whole state
+    LdsDeleteThreads();
+    _aLdsVariables.Clear();
+    _mapScriptCache.Clear();
+
+    LdsReadEngine(pStream);
+
+    if (_athhThreadHandlers.Count() != ct) {
+      LdsThrow(LER_READ, "Snapshot %d has %d thread IDs for %d threads!", iVersion, ct, _athhThreadHandlers.Count());
+    }
+
+    for (i = 0; i < ct; i++) {
+      CLdsThread &sth = *_athhThreadHandlers[i].psthThread;
+      sth.sth_iID = aiIDs[i];
+      sth.sth_iVersion = iVersion;
+    }
+
+    _iNextThreadID = iNextThreadID;
+    _iStateVersion = iVersion;
+    _ctSnapshotCache = _mapScriptCache.Count();
+    return;
+  }
+
+  // share programs between cached scripts and threads
+  SLdsProgramTableScope ptsScope(this);
+
+  // read script caching
+  char bCaching = false;
+  _pLdsRead(pStream, &bCaching, sizeof(char));
+
+  _bUseScriptCaching = (bCaching != 0);
+
+  // read new cached scripts
+  char bResetCache = false;
+  _pLdsRead(pStream, &bResetCache, sizeof(char));
+
+  if (bResetCache) {
+    _mapScriptCache.Clear();
+  }
+
+  ct = 0;
+  _pLdsRead(pStream, &ct, sizeof(int));
+
+  for (i = 0; i < ct; i++) {
+    LdsHash iHash;
+    _pLdsRead(pStream, &iHash, sizeof(LdsHash));
+
+    CLdsProgram pgCache;
+    LdsReadProgramRef(pStream, pgCache);
+
+    char bExpression = false;
+    _pLdsRead(pStream, &bExpression, sizeof(char));
+
+    _mapScriptCache.Add(iHash, SLdsCache(pgCache, bExpression != 0));
+  }
+
+  // resize the variable list
+  int ctVars = 0;
+  _pLdsRead(pStream, &ctVars, sizeof(int));
+
+  while (_aLdsVariables.Count() > ctVars) {
+    _aLdsVariables.Delete(_aLdsVariables.Count() - 1);
+  }
+
+  while (_aLdsVariables.Count() < ctVars) {
+    _aLdsVariables.Add();
+  }
+
+  // read changed variables
+  ct = 0;
+  _pLdsRead(pStream, &ct, sizeof(int));
+
+  for (i = 0; i < ct; i++) {
+    int iVar = -1;
+    _pLdsRead(pStream, &iVar, sizeof(int));
+
+    if (iVar < 0 || iVar >= ctVars) {
+      LdsThrow(LER_READ, "Cannot read variable %d (%d/%d) at %d!", iVar, iVar + 1, ctVars, _pLdsStreamTell(pStream));
+    }
+
+    CLdsVars aRead;
+    LdsReadOneVar(pStream, aRead);
+
+    _aLdsVariables[iVar] = aRead[0];
+  }
+
+  // read current tick
+  _pLdsRead(pStream, &_llCurrentTick, sizeof(LONG64));
+
+  // read paused threads
+  ct = 0;
+  _pLdsRead(pStream, &ct, sizeof(int));
+
+  DSList<SLdsHandler> athhNew;
+
+  for (i = 0; i < ct; i++) {
+    int iID = -1;
+    LONG64 llStart = 0;
+    LONG64 llEnd = 0;
+    char bChanged = false;
+
+    _pLdsRead(pStream, &iID, sizeof(int));
+    _pLdsRead(pStream, &llStart, sizeof(LONG64));
+    _pLdsRead(pStream, &llEnd, sizeof(LONG64));
+    _pLdsRead(pStream, &bChanged, sizeof(char));
+
+    // find thread with the same ID
+    CLdsThread *psth = NULL;
+    int iHandler;
+
+    for (iHandler = 0; iHandler < _athhThreadHandlers.Count(); iHandler++) {
+      if (_athhThreadHandlers[iHandler].psthThread->sth_iID == iID) {
+        psth = _athhThreadHandlers[iHandler].psthThread;
+        break;
+      }
+    }
+
+    if (bChanged) {
+      // replace the old thread
+      if (psth != NULL) {
+        delete psth;
+        _athhThreadHandlers.Delete(iHandler);
+      }
+
+      psth = new CLdsThread(CLdsProgram(), this);
+      LdsReadThread(pStream, *psth, false);
+
+      psth->sth_iID = iID;
+      psth->sth_iVersion = iVersion;
+
+    } else if (psth != NULL) {
+      // keep the old thread
+      _athhThreadHandlers.Delete(iHandler);
+
+    } else {
+      LdsThrow(LER_READ, "Unchanged thread %d is missing from the current state!", iID);
+    }
+
+    athhNew.Add() = SLdsHandler(psth, llStart, llEnd);
+  }
+
+  // delete threads that aren't there anymore
+  LdsDeleteThreads();
+  _athhThreadHandlers.CopyArray(athhNew);
+
+  _iNextThreadID = iNextThreadID;
+  _iStateVersion = iVersion;
+  _ctSnapshotCache = _mapScriptCache.Count();
+};
+
+// Apply delta snapshots to the base snapshot and write the result as a new base (doesn't change the engine state)
+void CLdsScriptEngine::LdsCompactSnapshots(void *pBase, void **apDeltas, const int &ctDeltas, void *pOut) {
+  // replay snapshots in a separate engine that reads and writes them the same way
+  CLdsScriptEngine ldsScratch;
+
+  ldsScratch._pLdsPrintFunction = _pLdsPrintFunction;
+  ldsScratch._pLdsErrorFunction = _pLdsErrorFunction;
+
+  ldsScratch._pLdsWrite = _pLdsWrite;
+  ldsScratch._pLdsRead = _pLdsRead;
+  ldsScratch._pLdsStreamTell = _pLdsStreamTell;
+
+  // custom value types after the default ones
+  for (int iType = ldsScratch._ldsValueTypes.Count(); iType < _ldsValueTypes.Count(); iType++) {
+    ldsScratch.AddValueType(*_ldsValueTypes[iType]);
+  }
+
+  ldsScratch.LdsReadSnapshot(pBase);
+
+  for (int iDelta = 0; iDelta < ctDeltas; iDelta++) {
+    ldsScratch.LdsReadSnapshot(apDeltas[iDelta]);
+  }
+
+  // keep the same version so the following deltas still apply to it
+  const int iVersion = ldsScratch._iStateVersion;
+  ldsScratch.LdsWriteSnapshotVersion(pOut, false, iVersion);
+};
+
+// Delete all threads and their handlers
+void CLdsScriptEngine::LdsDeleteThreads(void) {
+  int ctThreads = _athhThreadHandlers.Count();
+
+  while (--ctThreads >= 0) {
+    delete _athhThreadHandlers[ctThreads].psthThread;
+  }
+
+  _athhThreadHandlers.Clear();
+};
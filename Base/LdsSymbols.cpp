@@ -0,0 +1,125 @@
+/* Copyright (c) 2021 Dreamy Cecil
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#include "StdH.h"
+#include "LdsSymbols.h"
+
+#include <string.h>
+
+// Hash some name (FNV-1a)
+static inline unsigned int HashName(const char *strName, const int &ctLen) {
+  unsigned int iHash = 2166136261U;
+
+  for (int iChar = 0; iChar < ctLen; iChar++) {
+    iHash ^= (unsigned char)strName[iChar];
+    iHash *= 16777619U;
+  }
+
+  return iHash;
+};
+
+// Clear the table
+void CLdsSymbolTable::Clear(void) {
+  st_astrNames.Clear();
+  st_aiHashes.Clear();
+  st_aiSlots.Clear();
+};
+
+// Find slot for some name
+int CLdsSymbolTable::FindSlot(const char *strName, const int &ctLen, const unsigned int &iHash) {
+  // amount of slots is always a power of two
+  const int iMask = st_aiSlots.Count() - 1;
+  int iSlot = iHash & iMask;
+
+  while (true) {
+    int iID = st_aiSlots[iSlot];
+
+    // empty slot or the same name
+    if (iID == -1) {
+      return iSlot;
+    }
+
+    const string &strSymbol = st_astrNames[iID];
+
+    if (st_aiHashes[iID] == iHash && (int)strSymbol.length() == ctLen
+     && memcmp(strSymbol.c_str(), strName, ctLen) == 0) {
+      return iSlot;
+    }
+
+    iSlot = (iSlot + 1) & iMask;
+  }
+};
+
+// Resize hash slots and put all names into them
+void CLdsSymbolTable::Rehash(const int &ctSlots) {
+  st_aiSlots.Clear();
+  st_aiSlots.New(ctSlots);
+
+  int iSlot;
+
+  for (iSlot = 0; iSlot < ctSlots; iSlot++) {
+    st_aiSlots[iSlot] = -1;
+  }
+
+  for (int iID = 0; iID < st_astrNames.Count(); iID++) {
+    iSlot = st_aiHashes[iID] & (ctSlots - 1);
+
+    // names are unique so only an empty slot is needed
+    while (st_aiSlots[iSlot] != -1) {
+      iSlot = (iSlot + 1) & (ctSlots - 1);
+    }
+
+    st_aiSlots[iSlot] = iID;
+  }
+};
+
+// Get ID of some name and add it if it doesn't exist
+int CLdsSymbolTable::Intern(const char *strName, const int &ctLen) {
+  // keep slots at most half full
+  if (st_aiSlots.Count() < (st_astrNames.Count() + 1) * 2) {
+    Rehash(st_aiSlots.Count() > 0 ? st_aiSlots.Count() * 2 : 64);
+  }
+
+  unsigned int iHash = HashName(strName, ctLen);
+  int iSlot = FindSlot(strName, ctLen, iHash);
+
+  // already exists
+  if (st_aiSlots[iSlot] != -1) {
+    return st_aiSlots[iSlot];
+  }
+
+  // add new name
+  int iID = st_astrNames.Count();
+  st_astrNames.Add() = string(strName, ctLen);
+  st_aiHashes.Add() = iHash;
+
+  st_aiSlots[iSlot] = iID;
+  return iID;
+};
+
+// Find ID of some name (-1 if it doesn't exist)
+int CLdsSymbolTable::Find(const char *strName, const int &ctLen) {
+  if (st_aiSlots.Count() <= 0) {
+    return -1;
+  }
+
+  int iSlot = FindSlot(strName, ctLen, HashName(strName, ctLen));
+  return st_aiSlots[iSlot];
+};
@@ -0,0 +1,70 @@
+/* Copyright (c) 2021 Dreamy Cecil
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#pragma once
+
+#include "LdsBase.h"
+
+// Table of unique identifier names that can be compared by their IDs
+class LDS_API CLdsSymbolTable {
+  public:
+    DSList<string> st_astrNames; // names by their IDs
+
+  private:
+    DSList<unsigned int> st_aiHashes; // name hashes by their IDs
+    DSArray<int> st_aiSlots; // hash slots with IDs (-1 if empty)
+
+  public:
+    // Constructor
+    CLdsSymbolTable(void) {};
+
+    // Clear the table
+    void Clear(void);
+
+    // Get ID of some name and add it if it doesn't exist
+    int Intern(const char *strName, const int &ctLen);
+
+    inline int Intern(const string &strName) {
+      return Intern(strName.c_str(), (int)strName.length());
+    };
+
+    // Find ID of some name (-1 if it doesn't exist)
+    int Find(const char *strName, const int &ctLen);
+
+    inline int Find(const string &strName) {
+      return Find(strName.c_str(), (int)strName.length());
+    };
+
+    // Get name by its ID
+    inline const string &Name(const int &iID) {
+      return st_astrNames[iID];
+    };
+
+    // Amount of names
+    inline int Count(void) const {
+      return st_astrNames.Count();
+    };
+
+  private:
+    // Find slot for some name
+    int FindSlot(const char *strName, const int &ctLen, const unsigned int &iHash);
+    // Resize hash slots and put all names into them
+    void Rehash(const int &ctSlots);
+};
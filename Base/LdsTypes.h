@@ -24,6 +24,7 @@ SOFTWARE. */
 
 // Script values (any type)
 #include "Values/LdsValue.h"
+#include "Base/LdsMemory.h"
 #include "Types/LdsValueRef.h"
 
 #include "Values/LdsValueTypes.h"
@@ -33,6 +34,7 @@ SOFTWARE. */
 #include "Types/LdsBuildNode.h"
 #include "Types/LdsAction.h"
 #include "Execution/LdsProgram.h"
+#include "Execution/LdsProgramImage.h"
 
 // Script functions and variables
 #include "Types/LdsFunc.h"
@@ -43,3 +45,6 @@ SOFTWARE. */
 #include "Execution/LdsThread.h"
 #include "Execution/LdsHandler.h"
 #include "Execution/LdsQuickRun.h"
+#include "Execution/LdsAot.h"
+#include "Execution/LdsProfile.h"
+#include "Execution/LdsTrace.h"
@@ -0,0 +1,627 @@
+/* Copyright (c) 2021 Dreamy Cecil
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+// Benchmark of compiling and running test scripts and synthetic workloads
+//
+// Build and run on Linux (needs the DreamyStructures submodule):
+//   git submodule update --init
+//   cmake -S . -B build -DCMAKE_BUILD_TYPE=Release
+//   cmake --build build --target benchmark
+//
+// Usage:
+//   LdsBenchmark [-w warmup runs] [-n measured runs] [-s synthetic scale] [-j output.json] [scripts...]
+//
+// Without scripts it runs every TestScripts/*.lds file and all synthetic scripts.
+// Peak resident memory is measured for each script separately on Linux and for the whole process elsewhere.
+
+// Don't import the library for the benchmark
+#define LDS_EXPORT
+
+// Lilac Dragon Script
+#include "LilacDragonScript.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef WIN32
+  #include <windows.h>
+  #include <psapi.h>
+#else
+  #include <dirent.h>
+  #include <sys/resource.h>
+#endif
+
+// Script engine
+static CLdsScriptEngine _ldsEngine;
+
+// Benchmark settings
+static int _ctWarmup = 2; // runs before measuring
+static int _ctRuns = 10; // measured runs
+static int _iScale = 1; // size multiplier of synthetic scripts
+
+// Peak memory is measured for each script separately
+static bool _bScriptRSS = true;
+
+// Script to measure
+struct SBenchScript {
+  string strName; // script name
+  string strSource; // script source
+};
+
+// Measured timings of one script
+struct SBenchTimes {
+  double dMedian; // median time in seconds
+  double dP99; // 99th percentile in seconds
+  double dMin; // fastest time in seconds
+};
+
+// Results of one script
+struct SBenchResult {
+  string strName; // script name
+  bool bOK; // compiled and ran without errors
+  string strError; // error message
+
+  LONG64 ctActions; // actions executed in one run
+  SBenchTimes btCompile; // compilation times
+  SBenchTimes btRun; // execution times
+
+  LONG64 ctValues; // values created in one run
+  LONG64 ctVars; // variables created in one run
+  long iPeakRSS; // peak resident memory while running the script in kilobytes (see _bScriptRSS)
+};
+
+// Random number function (always the same numbers)
+LDS_FUNC(LDS_Random) {
+  static unsigned int iSeed = 1;
+  iSeed = iSeed * 1103515245 + 12345;
+
+  return int((iSeed >> 16) & 0x7FFF);
+};
+
+// Console printing function (output is ignored)
+LDS_FUNC(LDS_ConsolePrint) {
+  LDS_NEXT_ARG;
+  return 0;
+};
+
+// Suspend execution for some time (doesn't wait)
+LDS_FUNC(LDS_Sleep) {
+  LDS_NEXT_NUM;
+  return 0;
+};
+
+// Return an array or an object with some data
+LDS_FUNC(LDS_Data) {
+  int iObject = LDS_NEXT_INT;
+
+  CLdsArrayType aData;
+  aData.Add(0xFF);
+  aData.Add(0x7F);
+
+  if (iObject != 0) {
+    CLdsVars aFields;
+    aFields.Add() = SLdsVar("info", string("Two bytes"), true);
+    aFields.Add() = SLdsVar("data", aData, true);
+
+    return CLdsObjectType(-1, aFields, true);
+  }
+
+  CLdsArrayType valArray;
+  valArray.Add(string("Two bytes"));
+  valArray.Add(aData);
+
+  return valArray;
+};
+
+// Unary operation for getting value type name
+LDS_FUNC(LDS_UnaryValueType) {
+  return LDS_NEXT_ARG->TypeName();
+};
+
+// Unary operation for adding all array entries together
+LDS_FUNC(LDS_UnaryArrayAdd) {
+  CLdsVars &aArray = LDS_NEXT_LIST(0);
+
+  double dResult = 0.0;
+  
+  for (int i = 0; i < aArray.Count(); i++) {
+    dResult += aArray[i]->GetNumber();
+  }
+
+  return dResult;
+};
+
+// Script output function (output is ignored)
+void SilentOutput(const char *strOutput) {
+  (void)strOutput;
+};
+
+// Error output function
+void ErrorOutput(const char *strError) {
+  fprintf(stderr, "[LDS ERROR]: %s", strError);
+};
+
+// Same setup as the usage example
+static void SetupLDS(void) {
+  // don't flood the report with debug output of the scripts
+  _ldsEngine.LdsOutputFunctions((void *)SilentOutput, (void *)ErrorOutput);
+
+  // compile scripts every time
+  _ldsEngine._bUseScriptCaching = false;
+
+  CLdsFuncMap mapFunc;
+  mapFunc.Add("Random") = SLdsFunc(0, &LDS_Random);
+  mapFunc.Add("Out") = SLdsFunc(1, &LDS_ConsolePrint);
+  mapFunc.Add("Sleep") = SLdsFunc(1, &LDS_Sleep);
+  mapFunc.Add("GetData") = SLdsFunc(1, &LDS_Data);
+
+  _ldsEngine.SetCustomFunctions(mapFunc);
+
+  CLdsVars aVars;
+  aVars.Add() = SLdsVar("MAX_COUNT", 10, true);
+  aVars.Add() = SLdsVar("strHello", string("Hello, world!"));
+  
+  _ldsEngine.SetCustomVariables(aVars);
+
+  CLdsFuncPtrMap mapUnary;
+  mapUnary.Add("type") = &LDS_UnaryValueType;
+  mapUnary.Add("array_add") = &LDS_UnaryArrayAdd;
+
+  _ldsEngine.SetUnaryOperators(mapUnary, true);
+};
+
+// Add synthetic scripts that stress different parts of the engine
+static void AddSyntheticScripts(DSList<SBenchScript> &abs) {
+  // integer arithmetic in a loop
+  SBenchScript &bsMath = abs.Add();
+  bsMath.strName = "synthetic:arithmetic";
+  bsMath.strSource = LdsPrintF(
+    "var sum = 0;\n"
+    "var i = 0;\n"
+    "while (i < %d) {\n"
+    "  sum = (sum + i * 3) %% 1000;\n"
+    "  i = i + 1;\n"
+    "}\n"
+    "return sum;\n", 100000 * _iScale);
+
+  // growing strings
+  SBenchScript &bsStrings = abs.Add();
+  bsStrings.strName = "synthetic:strings";
+  bsStrings.strSource = LdsPrintF(
+    "var str = \"\";\n"
+    "var i = 0;\n"
+    "while (i < %d) {\n"
+    "  str = str + \"ab\";\n"
+    "  i = i + 1;\n"
+    "}\n"
+    "return str == %d;\n", 10000 * _iScale, 20000 * _iScale);
+
+  // array indexing (each access copies the array)
+  SBenchScript &bsArrays = abs.Add();
+  bsArrays.strName = "synthetic:arrays";
+  bsArrays.strSource = LdsPrintF(
+    "var a = [0] * %d;\n"
+    "var i = 0;\n"
+    "while (i < %d) {\n"
+    "  a[i] = i * 2;\n"
+    "  i = i + 1;\n"
+    "}\n"
+    "var sum = 0;\n"
+    "i = 0;\n"
+    "while (i < %d) {\n"
+    "  sum = sum + a[i];\n"
+    "  i = i + 1;\n"
+    "}\n"
+    "return sum;\n", 500 * _iScale, 500 * _iScale, 500 * _iScale);
+
+  // inline function calls
+  SBenchScript &bsCalls = abs.Add();
+  bsCalls.strName = "synthetic:calls";
+  bsCalls.strSource = LdsPrintF(
+    "function add(x, y) {\n"
+    "  return x + y;\n"
+    "}\n"
+    "function twice(x) {\n"
+    "  return add(x, x);\n"
+    "}\n"
+    "var sum = 0;\n"
+    "var i = 0;\n"
+    "while (i < %d) {\n"
+    "  sum = add(sum, twice(i)) %% 100000;\n"
+    "  i = i + 1;\n"
+    "}\n"
+    "return sum;\n", 10000 * _iScale);
+};
+
+// Sort script names alphabetically
+static int CompareScripts(const void *pScript1, const void *pScript2) {
+  const SBenchScript *pbs1 = *(const SBenchScript **)pScript1;
+  const SBenchScript *pbs2 = *(const SBenchScript **)pScript2;
+
+  return pbs1->strName.compare(pbs2->strName);
+};
+
+// Add all scripts from the test directory
+static void AddTestScripts(DSList<SBenchScript> &abs) {
+  DSList<SBenchScript> absFound;
+
+  #ifdef WIN32
+  WIN32_FIND_DATA fndData;
+  HANDLE hFind = FindFirstFile("TestScripts\\*.lds", &fndData);
+
+  while (hFind != INVALID_HANDLE_VALUE) {
+    absFound.Add().strName = string("TestScripts\\") + fndData.cFileName;
+
+    if (!FindNextFile(hFind, &fndData)) {
+      FindClose(hFind);
+      break;
+    }
+  }
+
+  #else
+  DIR *pDir = opendir("TestScripts");
+
+  if (pDir != NULL) {
+    dirent *pEntry;
+
+    while ((pEntry = readdir(pDir)) != NULL) {
+      string strFile = pEntry->d_name;
+
+      if (strFile.length() > 4 && strFile.substr(strFile.length() - 4) == ".lds") {
+        absFound.Add().strName = "TestScripts/" + strFile;
+      }
+    }
+
+    closedir(pDir);
+  }
+  #endif
+
+  // same order on every system
+  DSList<SBenchScript *> apbs;
+
+  for (int iScript = 0; iScript < absFound.Count(); iScript++) {
+    apbs.Add() = &absFound[iScript];
+  }
+
+  if (apbs.Count() > 1) {
+    qsort(&apbs[0], apbs.Count(), sizeof(SBenchScript *), CompareScripts);
+  }
+
+  for (int iScript = 0; iScript < apbs.Count(); iScript++) {
+    abs.Add().strName = apbs[iScript]->strName;
+  }
+};
+
+// Reset peak resident memory of the process to the current one (returns false if it can't be reset)
+static bool ResetPeakRSS(void) {
+  #ifdef __linux__
+  FILE *file = fopen("/proc/self/clear_refs", "w");
+
+  if (file == NULL) {
+    return false;
+  }
+
+  bool bReset = (fputs("5", file) >= 0);
+
+  // buffered write fails on closing
+  if (fclose(file) != 0) {
+    bReset = false;
+  }
+
+  return bReset;
+
+  #else
+  return false;
+  #endif
+};
+
+// Peak resident memory of the process since the last reset in kilobytes
+static long PeakRSS(void) {
+  #ifdef __linux__
+  // maximum in rusage isn't reset
+  FILE *file = fopen("/proc/self/status", "r");
+
+  if (file != NULL) {
+    char strLine[256];
+    long iPeak = -1;
+
+    while (fgets(strLine, sizeof(strLine), file) != NULL) {
+      if (sscanf(strLine, "VmHWM: %ld kB", &iPeak) == 1) {
+        break;
+      }
+    }
+
+    fclose(file);
+
+    if (iPeak >= 0) {
+      return iPeak;
+    }
+  }
+  #endif
+
+  #ifdef WIN32
+  PROCESS_MEMORY_COUNTERS pmc;
+
+  if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc))) {
+    return long(pmc.PeakWorkingSetSize / 1024);
+  }
+
+  return 0;
+
+  #else
+  struct rusage ru;
+
+  if (getrusage(RUSAGE_SELF, &ru) == 0) {
+    return ru.ru_maxrss;
+  }
+
+  return 0;
+  #endif
+};
+
+// Sort times from fastest to slowest
+static int CompareTimes(const void *pTime1, const void *pTime2) {
+  const double d1 = *(const double *)pTime1;
+  const double d2 = *(const double *)pTime2;
+
+  return (d1 < d2 ? -1 : (d1 > d2 ? 1 : 0));
+};
+
+// Compute statistics of measured times
+static SBenchTimes TimeStats(DSArray<double> &adTimes) {
+  SBenchTimes bt;
+  const int ct = adTimes.Count();
+
+  qsort(&adTimes[0], ct, sizeof(double), CompareTimes);
+
+  bt.dMin = adTimes[0];
+  bt.dMedian = (ct % 2 != 0 ? adTimes[ct / 2] : (adTimes[ct / 2 - 1] + adTimes[ct / 2]) * 0.5);
+
+  // nearest rank
+  int iP99 = int(ceil(ct * 0.99)) - 1;
+  bt.dP99 = adTimes[iP99 < 0 ? 0 : iP99];
+
+  return bt;
+};
+
+// Compile and run one script several times
+static SBenchResult RunBenchmark(const SBenchScript &bs) {
+  SBenchResult br;
+  br.strName = bs.strName;
+  br.bOK = false;
+  br.ctActions = 0;
+  br.ctValues = 0;
+  br.ctVars = 0;
+  br.iPeakRSS = 0;
+
+  memset(&br.btCompile, 0, sizeof(SBenchTimes));
+  memset(&br.btRun, 0, sizeof(SBenchTimes));
+
+  // measure memory of this script only
+  if (!ResetPeakRSS()) {
+    _bScriptRSS = false;
+  }
+
+  DSArray<double> adCompile;
+  DSArray<double> adRun;
+  adCompile.New(_ctRuns);
+  adRun.New(_ctRuns);
+
+  for (int iRun = -_ctWarmup; iRun < _ctRuns; iRun++) {
+    // compile
+    CLdsProgram pgProgram;
+    double dStart = LdsGetTime();
+
+    if (_ldsEngine.LdsCompileScript(bs.strSource, pgProgram) != LER_OK) {
+      br.strError = "compilation failed";
+      return br;
+    }
+
+    double dCompile = LdsGetTime() - dStart;
+
+    // run in one go
+    CLdsVars aArgs;
+    CLdsInFuncMap mapInline;
+
+    const LONG64 ctValues = LDS_alAllocs.al_acValues.ac_ctTotal;
+    const LONG64 ctVars = LDS_alAllocs.al_acVars.ac_ctTotal;
+
+    dStart = LdsGetTime();
+    CLdsQuickRun qrScript(_ldsEngine, pgProgram, aArgs, mapInline);
+    double dRun = LdsGetTime() - dStart;
+
+    if (qrScript.GetStatus() != ETS_FINISHED) {
+      br.strError = qrScript.GetResult()->Print();
+      return br;
+    }
+
+    // warm-up runs aren't measured
+    if (iRun < 0) {
+      continue;
+    }
+
+    adCompile[iRun] = dCompile;
+    adRun[iRun] = dRun;
+
+    br.ctActions = qrScript.qr_psthThread->sth_ctActions;
+    br.ctValues = LDS_alAllocs.al_acValues.ac_ctTotal - ctValues;
+    br.ctVars = LDS_alAllocs.al_acVars.ac_ctTotal - ctVars;
+  }
+
+  br.btCompile = TimeStats(adCompile);
+  br.btRun = TimeStats(adRun);
+  br.iPeakRSS = PeakRSS();
+  br.bOK = true;
+
+  return br;
+};
+
+// Escape a string for JSON
+static string JsonString(const string &str) {
+  string strEscaped = "\"";
+
+  for (size_t iChar = 0; iChar < str.length(); iChar++) {
+    const char ch = str[iChar];
+
+    if (ch == '"' || ch == '\\') {
+      strEscaped += '\\';
+      strEscaped += ch;
+
+    } else if ((unsigned char)ch < 0x20) {
+      strEscaped += LdsPrintF("\\u%04x", (unsigned char)ch);
+
+    } else {
+      strEscaped += ch;
+    }
+  }
+
+  return strEscaped + "\"";
+};
+
+// Print timings in milliseconds as a JSON object
+static string JsonTimes(const SBenchTimes &bt) {
+  return LdsPrintF("{\"median_ms\": %.4f, \"p99_ms\": %.4f, \"min_ms\": %.4f}", bt.dMedian * 1000.0, bt.dP99 * 1000.0, bt.dMin * 1000.0);
+};
+
+// Make a JSON report of all results
+static string JsonReport(DSList<SBenchResult> &abr) {
+  string strJson = LdsPrintF("{\n  \"warmup\": %d,\n  \"runs\": %d,\n  \"scale\": %d,\n  \"peak_rss_per_script\": %s,\n  \"scripts\": [",
+                             _ctWarmup, _ctRuns, _iScale, (_bScriptRSS ? "true" : "false"));
+
+  for (int iResult = 0; iResult < abr.Count(); iResult++) {
+    const SBenchResult &br = abr[iResult];
+    strJson += (iResult > 0 ? ",\n    {" : "\n    {");
+    strJson += "\"name\": " + JsonString(br.strName);
+
+    if (!br.bOK) {
+      strJson += ", \"ok\": false, \"error\": " + JsonString(br.strError) + "}";
+      continue;
+    }
+
+    const double dActionsPerSec = (br.btRun.dMedian > 0.0 ? br.ctActions / br.btRun.dMedian : 0.0);
+
+    strJson += LdsPrintF(", \"ok\": true, \"actions\": %lld, \"actions_per_sec\": %.0f, ", br.ctActions, dActionsPerSec);
+    strJson += "\"compile\": " + JsonTimes(br.btCompile) + ", \"run\": " + JsonTimes(br.btRun);
+    strJson += LdsPrintF(", \"values_per_run\": %lld, \"vars_per_run\": %lld, \"peak_rss_kb\": %ld}", br.ctValues, br.ctVars, br.iPeakRSS);
+  }
+
+  strJson += "\n  ]\n}\n";
+  return strJson;
+};
+
+// Entry point
+int main(int argc, char **argv) {
+  DSList<SBenchScript> abs;
+  const char *strJsonFile = NULL;
+
+  // read arguments
+  for (int iArg = 1; iArg < argc; iArg++) {
+    string strArg = argv[iArg];
+    const bool bValue = (iArg + 1 < argc);
+
+    if (strArg == "-w" && bValue) {
+      _ctWarmup = atoi(argv[++iArg]);
+
+    } else if (strArg == "-n" && bValue) {
+      _ctRuns = atoi(argv[++iArg]);
+
+    } else if (strArg == "-s" && bValue) {
+      _iScale = atoi(argv[++iArg]);
+
+    } else if (strArg == "-j" && bValue) {
+      strJsonFile = argv[++iArg];
+
+    } else {
+      abs.Add().strName = strArg;
+    }
+  }
+
+  if (_ctWarmup < 0) _ctWarmup = 0;
+  if (_ctRuns < 1) _ctRuns = 1;
+  if (_iScale < 1) _iScale = 1;
+
+  SetupLDS();
+
+  // everything by default
+  if (abs.Count() == 0) {
+    AddTestScripts(abs);
+    AddSyntheticScripts(abs);
+  }
+
+  DSList<SBenchResult> abr;
+
+  printf("%-36s %10s %12s %12s %12s %12s %14s %10s\n", "Script", "actions", "compile ms",
+         "run ms", "run p99 ms", "actions/s", "values/run", "peak KB");
+
+  for (int iScript = 0; iScript < abs.Count(); iScript++) {
+    SBenchScript &bs = abs[iScript];
+
+    // load script files
+    if (bs.strSource == "" && !LdsLoadScriptFile(bs.strName.c_str(), bs.strSource)) {
+      SBenchResult &br = abr.Add();
+      br.strName = bs.strName;
+      br.bOK = false;
+      br.strError = "couldn't load the script file";
+
+      printf("%-36s %s\n", bs.strName.c_str(), br.strError.c_str());
+      continue;
+    }
+
+    SBenchResult &br = abr.Add();
+    br = RunBenchmark(bs);
+
+    if (!br.bOK) {
+      printf("%-36s %s\n", br.strName.c_str(), br.strError.c_str());
+      continue;
+    }
+
+    const double dActionsPerSec = (br.btRun.dMedian > 0.0 ? br.ctActions / br.btRun.dMedian : 0.0);
+
+    printf("%-36s %10lld %12.4f %12.4f %12.4f %12.0f %14lld %10ld\n", br.strName.c_str(), br.ctActions,
+           br.btCompile.dMedian * 1000.0, br.btRun.dMedian * 1000.0, br.btRun.dP99 * 1000.0,
+           dActionsPerSec, br.ctValues, br.iPeakRSS);
+  }
+
+  if (!_bScriptRSS) {
+    printf("\nPeak memory couldn't be reset between scripts and is of the whole process so far\n");
+  }
+
+  // machine-readable results
+  if (strJsonFile != NULL) {
+    string strJson = JsonReport(abr);
+
+    if (string(strJsonFile) == "-") {
+      fputs(strJson.c_str(), stdout);
+
+    } else {
+      FILE *file = fopen(strJsonFile, "w");
+
+      if (file == NULL) {
+        fprintf(stderr, "Couldn't create \"%s\"\n", strJsonFile);
+        return 1;
+      }
+
+      fputs(strJson.c_str(), file);
+      fclose(file);
+    }
+  }
+
+  return 0;
+};
@@ -57,6 +57,13 @@ void CLdsScriptEngine::LdsBuild(bool bExpression) {
   _bnNode = CBuildNode(EBN_BLOCK, -1, -1, abnNodes.Count(), &abnNodes);
 };
 
+// Free all build nodes at once
+void CLdsScriptEngine::LdsFreeBuild(void) {
+  // forget about nodes in the arena before freeing it
+  _bnNode = CBuildNode();
+  _bnaNodes.Clear();
+};
+
 // Build one statement
 void CLdsScriptEngine::StatementBuilder(void) {
   if (_ctBuildLen <= 0) {
@@ -789,8 +796,8 @@ void CLdsScriptEngine::ExpressionBuilder(const LdsFlags &ubFlags) {
         // built expression
         CBuildNode bnUnaryExp = _bnNode;
 
-        // if it's a pure value
-        if (bnUnaryExp.lt_eType == EBN_RAW_VAL) {
+        // if it's a pure value and an operation without side effects
+        if (bnUnaryExp.lt_eType == EBN_RAW_VAL && PureUnaryOperator(strOperation)) {
           // perform operation in place
           CLdsToken tknOp(LTK_OPERATOR, et.lt_iPos, strOperation, -1);
 
@@ -809,7 +816,7 @@ void CLdsScriptEngine::ExpressionBuilder(const LdsFlags &ubFlags) {
           // add pure value
           _bnNode = CBuildNode(EBN_RAW_VAL, et.lt_iPos, valRef.vr_val, -1);
 
-        // if an identifier
+        // if an identifier or a custom operation
         } else {
           // build unary operation
           _bnNode = CBuildNode(EBN_UNARY_OP, et.lt_iPos, strOperation, -1);
@@ -23,8 +23,424 @@ SOFTWARE. */
 // Compiling the expression
 static bool _bExpression = true;
 
-// General compilation
-ELdsError CLdsScriptEngine::LdsCompileGeneral(const string &strSource, CLdsProgram &pgProgram, const bool &bExpression) {
+// Value type that can't be inferred
+#define LDS_TYPE_UNKNOWN (-1)
+// Variable that hasn't been assigned anything yet
+#define LDS_TYPE_NONE (-2)
+
+// Forget about optimizations of the previous compilation
+void CLdsScriptEngine::ResetCompileState(void) {
+  _bFuncBody = false;
+  _mapInlineBodies.Clear();
+  _astrExpanding.Clear();
+  _astrExpandedLocals.Clear();
+
+  _mapVarTypes.Clear();
+};
+
+// Gather bodies of inline functions from the script (skips functions within functions)
+static void GatherInlineBodies(CBuildNode &bn, DSMap<string, CBuildNode *> &mapBodies) {
+  if (bn.lt_eType == EBN_FUNC_DEF) {
+    mapBodies.Add(bn->GetString()) = bn.bn_abnNodes[0];
+    return;
+  }
+
+  for (int iNode = 0; iNode < bn.bn_abnNodes.Count(); iNode++) {
+    GatherInlineBodies(*bn.bn_abnNodes[iNode], mapBodies);
+  }
+};
+
+// Count nodes in the inline function body (-1 if it can't or shouldn't be expanded)
+static int InlineBodyNodes(CBuildNode &bn, bool bInSwitch) {
+  switch (bn.lt_eType) {
+    // functions within functions
+    case EBN_FUNC_DEF: return -1;
+
+    // one call is nothing next to the loop but the whole loop would be copied
+    case EBN_WHILE_LOOP: case EBN_DO_LOOP: case EBN_FOR_LOOP: return -1;
+
+    // switch header value needs to be discarded before returning
+    case EBN_RETURN_ACT:
+      if (bInSwitch) {
+        return -1;
+      }
+      break;
+
+    case EBN_SWITCH: bInSwitch = true; break;
+  }
+
+  int ctNodes = 1;
+
+  for (int iNode = 0; iNode < bn.bn_abnNodes.Count(); iNode++) {
+    int ctSubNodes = InlineBodyNodes(*bn.bn_abnNodes[iNode], bInSwitch);
+
+    if (ctSubNodes == -1) {
+      return -1;
+    }
+
+    ctNodes += ctSubNodes;
+  }
+
+  return ctNodes;
+};
+
+// Check if nodes call some inline function directly or through other inline functions
+static bool CallsInlineFunction(CBuildNode &bn, DSMap<string, CBuildNode *> &mapBodies, const string &strFunc, DSList<string> &astrVisited) {
+  if (bn.lt_eType == EBN_CALL_ACT) {
+    string strCall = bn->GetString();
+
+    if (strCall == strFunc) {
+      return true;
+    }
+
+    // go through the called function once
+    int iBody = mapBodies.FindKeyIndex(strCall);
+
+    if (iBody != -1 && astrVisited.FindIndex(strCall) == -1) {
+      astrVisited.Add(strCall);
+
+      if (CallsInlineFunction(*mapBodies.GetValue(iBody), mapBodies, strFunc, astrVisited)) {
+        return true;
+      }
+    }
+  }
+
+  for (int iNode = 0; iNode < bn.bn_abnNodes.Count(); iNode++) {
+    if (CallsInlineFunction(*bn.bn_abnNodes[iNode], mapBodies, strFunc, astrVisited)) {
+      return true;
+    }
+  }
+
+  return false;
+};
+
+// Gather names of local variables defined in the inline function body
+static void GatherBodyLocals(CBuildNode &bn, DSList<string> &astrLocals) {
+  if (bn.lt_eType == EBN_VAR_DEF && astrLocals.FindIndex(bn->GetString()) == -1) {
+    astrLocals.Add(bn->GetString());
+  }
+
+  for (int iNode = 0; iNode < bn.bn_abnNodes.Count(); iNode++) {
+    GatherBodyLocals(*bn.bn_abnNodes[iNode], astrLocals);
+  }
+};
+
+// Gather local variables defined in the inline function body
+static void GatherExpandedLocals(CBuildNode &bn, const string &strFunc, DSList<string> &astrExpanded) {
+  if (bn.lt_eType == EBN_VAR_DEF) {
+    string strLocal = strFunc + ":" + bn->GetString();
+
+    if (astrExpanded.FindIndex(strLocal) == -1) {
+      astrExpanded.Add(strLocal);
+    }
+  }
+
+  for (int iNode = 0; iNode < bn.bn_abnNodes.Count(); iNode++) {
+    GatherExpandedLocals(*bn.bn_abnNodes[iNode], strFunc, astrExpanded);
+  }
+};
+
+// Check if locals of the inline function body are only used after they have been defined
+// (otherwise they refer to variables of the caller until then, which can't be expanded)
+static bool LocalsDefinedBeforeUse(CBuildNode &bn, DSList<string> &astrLocals, DSList<string> &astrDefined) {
+  switch (bn.lt_eType) {
+    case EBN_VAR_DEF:
+      astrDefined.Add(bn->GetString());
+      return true;
+
+    case EBN_IDENTIFIER: {
+      string strVar = bn->GetString();
+      return (astrLocals.FindIndex(strVar) == -1 || astrDefined.FindIndex(strVar) != -1);
+    }
+  }
+
+  // locals defined in conditional blocks only exist within them
+  const bool bConditional = (bn.lt_eType == EBN_IF_THEN || bn.lt_eType == EBN_IF_THEN_ELSE || bn.lt_eType == EBN_SWITCH);
+  const int ctDefined = astrDefined.Count();
+
+  for (int iNode = 0; iNode < bn.bn_abnNodes.Count(); iNode++) {
+    if (!LocalsDefinedBeforeUse(*bn.bn_abnNodes[iNode], astrLocals, astrDefined)) {
+      return false;
+    }
+
+    while (bConditional && astrDefined.Count() > ctDefined) {
+      astrDefined.Delete(astrDefined.Count() - 1);
+    }
+  }
+
+  return true;
+};
+
+// Local variable name within the function that is being expanded
+string CLdsScriptEngine::ExpandedLocal(const string &strVar) {
+  const int ctExpanding = _astrExpanding.Count();
+
+  if (ctExpanding <= 0) {
+    return strVar;
+  }
+
+  // same naming as in inline calls
+  string strLocal = _astrExpanding[ctExpanding - 1] + ":" + strVar;
+
+  if (_astrExpandedLocals.FindIndex(strLocal) != -1) {
+    return strLocal;
+  }
+
+  return strVar;
+};
+
+// Type of the binary operation result
+static int BinaryType(const int &iOperation, const int &iType1, const int &iType2) {
+  if (iType1 == LDS_TYPE_UNKNOWN || iType2 == LDS_TYPE_UNKNOWN) {
+    return LDS_TYPE_UNKNOWN;
+  }
+
+  if (iType1 == LDS_TYPE_NONE || iType2 == LDS_TYPE_NONE) {
+    return LDS_TYPE_NONE;
+  }
+
+  switch (iOperation) {
+    // integers unless there are any floats
+    case LOP_ADD: case LOP_SUB: case LOP_MUL: case LOP_DIV: case LOP_FMOD:
+      return (iType1 == EVT_INDEX && iType2 == EVT_INDEX) ? EVT_INDEX : EVT_FLOAT;
+
+    // always integers
+    case LOP_IDIV: case LOP_XOR:
+    case LOP_SH_L: case LOP_SH_R: case LOP_B_AND: case LOP_B_XOR: case LOP_B_OR:
+    case LOP_GT: case LOP_GOE: case LOP_LT: case LOP_LOE: case LOP_EQ: case LOP_NEQ:
+      return EVT_INDEX;
+
+    // one of the values
+    case LOP_AND: case LOP_OR:
+      return (iType1 == iType2) ? iType1 : LDS_TYPE_UNKNOWN;
+  }
+
+  return LDS_TYPE_UNKNOWN;
+};
+
+// Type of the expression value
+int CLdsScriptEngine::ExpressionType(CBuildNode &bn) {
+  switch (bn.lt_eType) {
+    case EBN_RAW_VAL: {
+      int iType = bn.lt_valValue->GetType();
+      return (iType == EVT_INDEX || iType == EVT_FLOAT) ? iType : LDS_TYPE_UNKNOWN;
+    }
+
+    case EBN_IDENTIFIER: {
+      string strVar = bn->GetString();
+      int iVar = _mapVarTypes.FindKeyIndex(strVar);
+
+      if (iVar != -1) {
+        return _mapVarTypes.GetValue(iVar);
+      }
+
+      // current type of a host variable
+      SLdsVar *pvar = _aLdsVariables.Find(strVar);
+
+      if (pvar != NULL) {
+        int iType = pvar->var_valValue->GetType();
+        return (iType == EVT_INDEX || iType == EVT_FLOAT) ? iType : LDS_TYPE_UNKNOWN;
+      }
+    } break;
+
+    case EBN_UNARY_OP: {
+      string strOperator = bn->GetString();
+
+      if (strOperator == "-") {
+        return ExpressionType(*bn.bn_abnNodes[0]);
+      }
+
+      if (strOperator == "!") {
+        return EVT_INDEX;
+      }
+    } break;
+
+    case EBN_BINARY_OP:
+      return BinaryType(bn->GetIndex(), ExpressionType(*bn.bn_abnNodes[0]), ExpressionType(*bn.bn_abnNodes[1]));
+  }
+
+  return LDS_TYPE_UNKNOWN;
+};
+
+// Merge another possible type of the variable (returns true if it has changed)
+bool CLdsScriptEngine::MergeVarType(const string &strVar, const int &iType) {
+  int iVar = _mapVarTypes.FindKeyIndex(strVar);
+
+  if (iVar == -1) {
+    _mapVarTypes.Add(strVar) = iType;
+    return true;
+  }
+
+  int &iVarType = _mapVarTypes.GetValue(iVar);
+
+  if (iType == LDS_TYPE_NONE || iVarType == iType || iVarType == LDS_TYPE_UNKNOWN) {
+    return false;
+  }
+
+  iVarType = (iVarType == LDS_TYPE_NONE) ? iType : LDS_TYPE_UNKNOWN;
+  return true;
+};
+
+// Merge types of values assigned to variables (returns true if any type has changed)
+bool CLdsScriptEngine::GatherVarTypes(CBuildNode &bn) {
+  bool bChanged = false;
+
+  switch (bn.lt_eType) {
+    // defined without a value
+    case EBN_VAR_DEF:
+      bChanged |= MergeVarType(bn->GetString(), LDS_TYPE_NONE);
+      break;
+
+    // arguments can be anything
+    case EBN_FUNC_DEF: {
+      string strFunc = bn->GetString();
+
+      if (_mapInlineFunc.FindKeyIndex(strFunc) != -1) {
+        CLdsInlineArgs &astrArgs = _mapInlineFunc[strFunc];
+
+        for (int iArg = 0; iArg < astrArgs.Count(); iArg++) {
+          bChanged |= MergeVarType(astrArgs[iArg], LDS_TYPE_UNKNOWN);
+        }
+      }
+    } break;
+
+    case EBN_ASSIGN_OP: case EBN_ADJFIX:
+    case EBN_PREFIX: case EBN_POSTFIX: {
+      CBuildNode &bnTarget = *bn.bn_abnNodes[0];
+
+      // only variables themselves
+      if (bnTarget.lt_eType != EBN_IDENTIFIER) {
+        break;
+      }
+
+      int iType = LDS_TYPE_UNKNOWN;
+
+      if (bn.lt_eType != EBN_ASSIGN_OP) {
+        iType = BinaryType(LOP_ADD, ExpressionType(bnTarget), bn.lt_valValue->GetType());
+
+      } else if (bn->GetIndex() == LOP_SET) {
+        iType = ExpressionType(*bn.bn_abnNodes[1]);
+
+      } else {
+        iType = BinaryType(bn->GetIndex(), ExpressionType(bnTarget), ExpressionType(*bn.bn_abnNodes[1]));
+      }
+
+      bChanged |= MergeVarType(bnTarget->GetString(), iType);
+    } break;
+  }
+
+  for (int iNode = 0; iNode < bn.bn_abnNodes.Count(); iNode++) {
+    bChanged |= GatherVarTypes(*bn.bn_abnNodes[iNode]);
+  }
+
+  return bChanged;
+};
+
+// Infer types of local variables from values that are assigned to them
+void CLdsScriptEngine::InferVarTypes(CBuildNode &bnRoot) {
+  bool bChanged = true;
+
+  // repeat until types depending on other variables settle
+  while (bChanged) {
+    bChanged = GatherVarTypes(bnRoot);
+  }
+
+  // variables that have never been assigned stay as zeros
+  for (int iVar = 0; iVar < _mapVarTypes.Count(); iVar++) {
+    int &iType = _mapVarTypes.GetValue(iVar);
+
+    if (iType == LDS_TYPE_NONE) {
+      iType = EVT_INDEX;
+    }
+  }
+};
+
+// Add binary operation that can be specialized for numbers of known types
+static void AddBinaryAction(CActionList &aca, const int &iPos, const int &iOperation, const int &iType1, const int &iType2) {
+  bool bNumbers = (iType1 == EVT_INDEX || iType1 == EVT_FLOAT) && (iType2 == EVT_INDEX || iType2 == EVT_FLOAT);
+
+  // only operations that are performed the same way for all numbers
+  if (bNumbers) {
+    switch (iOperation) {
+      case LOP_ADD: case LOP_SUB: case LOP_MUL: case LOP_DIV: case LOP_FMOD: case LOP_IDIV:
+      case LOP_SH_L: case LOP_SH_R: case LOP_B_AND: case LOP_B_XOR: case LOP_B_OR:
+      case LOP_GT: case LOP_GOE: case LOP_LT: case LOP_LOE: case LOP_EQ: case LOP_NEQ:
+        aca.Add() = CCompAction(LCA_BIN_NUM, iPos, iOperation, LDS_BIN_NUM_ARG(iOperation, iType1, iType2));
+        return;
+    }
+  }
+
+  aca.Add() = CCompAction(LCA_BIN, iPos, iOperation, -1);
+};
+
+// Reset statistics
+void SLdsCompileStats::Clear(void) {
+  cs_ctCompiled = 0;
+  cs_ctCacheHits = 0;
+  cs_ctCacheMisses = 0;
+  cs_ctErrors = 0;
+
+  cs_dParseTime = 0.0;
+  cs_dBuildTime = 0.0;
+  cs_dCompileTime = 0.0;
+  cs_dTotalTime = 0.0;
+
+  cs_ctTokens = 0;
+  cs_ctNodes = 0;
+  cs_ctActions = 0;
+  cs_iPeakMemory = 0;
+};
+
+// Combine with other statistics
+void SLdsCompileStats::Add(const SLdsCompileStats &csOther) {
+  cs_ctCompiled += csOther.cs_ctCompiled;
+  cs_ctCacheHits += csOther.cs_ctCacheHits;
+  cs_ctCacheMisses += csOther.cs_ctCacheMisses;
+  cs_ctErrors += csOther.cs_ctErrors;
+
+  cs_dParseTime += csOther.cs_dParseTime;
+  cs_dBuildTime += csOther.cs_dBuildTime;
+  cs_dCompileTime += csOther.cs_dCompileTime;
+  cs_dTotalTime += csOther.cs_dTotalTime;
+
+  cs_ctTokens += csOther.cs_ctTokens;
+  cs_ctNodes += csOther.cs_ctNodes;
+  cs_ctActions += csOther.cs_ctActions;
+
+  if (csOther.cs_iPeakMemory > cs_iPeakMemory) {
+    cs_iPeakMemory = csOther.cs_iPeakMemory;
+  }
+};
+
+// Get time since the last phase and start the next one
+static inline double PhaseTime(double &dPhaseStart) {
+  double dNow = LdsGetTime();
+  double dTime = dNow - dPhaseStart;
+
+  dPhaseStart = dNow;
+  return dTime;
+};
+
+// Pass statistics to the caller and add them to the engine statistics
+void CLdsScriptEngine::LdsRecordStats(const SLdsCompileStats &cs, SLdsCompileStats *pcsStats) {
+  if (pcsStats != NULL) {
+    *pcsStats = cs;
+  }
+
+  _csCompileStats.Add(cs);
+};
+
+// General compilation (records statistics if asked for them or if enabled for the engine)
+ELdsError CLdsScriptEngine::LdsCompileGeneral(const string &strSource, CLdsProgram &pgProgram, const bool &bExpression, SLdsCompileStats *pcsStats) {
+  // statistics of this compilation
+  const bool bStats = (_bCompileStats || pcsStats != NULL);
+
+  SLdsCompileStats cs;
+  cs.cs_ctCompiled = 1;
+
+  double dStart = (bStats ? LdsGetTime() : 0.0);
+  double dPhase = dStart;
+
   // calculate hash value of the script
   LdsHash iScriptHash;
 
@@ -37,195 +453,913 @@ ELdsError CLdsScriptEngine::LdsCompileGeneral(const string &strSource, CLdsProgr
 
     if (iInCache != -1) {
       pgProgram = _mapScriptCache.GetValue(iInCache).pgCache;
+
+      if (bStats) {
+        cs.cs_ctCacheHits = 1;
+        cs.cs_ctActions = pgProgram.Count();
+        cs.cs_dTotalTime = LdsGetTime() - dStart;
+
+        LdsRecordStats(cs, pcsStats);
+      }
       return LER_OK;
     }
+
+    cs.cs_ctCacheMisses = 1;
   }
 
   CActionList acaCompiled;
   _bExpression = bExpression;
 
+  // build nodes in this engine's arena
+  CBuildNodeArena *pbnaPrev = _pbnaCurrent;
+  _pbnaCurrent = &_bnaNodes;
+
+  ELdsError eResult = LER_OK;
+
+  ResetCompileState();
+  ForgetInvariants(0);
+  _ctHoisted = 0;
+
   try {
     ParseScript(strSource);
+
+    if (bStats) {
+      cs.cs_dParseTime = PhaseTime(dPhase);
+      cs.cs_ctTokens = _aetTokens.Count();
+    }
+
     LdsBuild(bExpression);
+
+    if (bStats) {
+      cs.cs_dBuildTime = PhaseTime(dPhase);
+      cs.cs_ctNodes = _bnaNodes.Count() + 1; // including the root node
+    }
+
+    GatherInlineBodies(_bnNode, _mapInlineBodies);
+    InferVarTypes(_bnNode);
+
     Compile(_bnNode, acaCompiled);
 
+    if (bStats) {
+      cs.cs_dCompileTime = PhaseTime(dPhase);
+      cs.cs_ctActions = acaCompiled.Count();
+    }
+
   } catch (SLdsError leError) {
     LdsErrorOut("%s (code 0x%X)\n", leError.le_strMessage.c_str(), leError.le_eError);
-    return leError.le_eError;
+    eResult = leError.le_eError;
+  }
+
+  ResetCompileState();
+  ForgetInvariants(0);
+
+  LdsFreeBuild();
+  _pbnaCurrent = pbnaPrev;
+
+  if (eResult == LER_OK) {
+    // move compiled actions into a new program
+    pgProgram.Clear();
+    pgProgram.Modify().MoveArray(acaCompiled);
+
+    // verified programs run without extra checks and know their maximum stack depth
+    try {
+      pgProgram.Verify();
+
+    } catch (SLdsError leError) {
+      LdsErrorOut("Compiled program cannot be verified: %s\n", leError.le_strMessage.c_str());
+    }
+
+    // cache the script (shares the actions)
+    if (_bUseScriptCaching) {
+      _mapScriptCache.Add(iScriptHash, SLdsCache(pgProgram, bExpression));
+    }
+  }
+
+  if (bStats) {
+    cs.cs_ctErrors = (eResult != LER_OK ? 1 : 0);
+    cs.cs_dTotalTime = LdsGetTime() - dStart;
+
+    // tokens, nodes and actions all exist right before the nodes are freed
+    cs.cs_iPeakMemory = cs.cs_ctTokens * sizeof(CLdsToken) + cs.cs_ctNodes * sizeof(CBuildNode) + cs.cs_ctActions * sizeof(CCompAction);
+
+    LdsRecordStats(cs, pcsStats);
+  }
+
+  return eResult;
+};
+
+// Compile the script
+ELdsError CLdsScriptEngine::LdsCompileScript(const string &strScript, CLdsProgram &pgProgram, SLdsCompileStats *pcsStats) {
+  return LdsCompileGeneral(strScript, pgProgram, false, pcsStats);
+};
+
+// Compile the expression
+ELdsError CLdsScriptEngine::LdsCompileExpression(const string &strExpression, CLdsProgram &pgProgram, SLdsCompileStats *pcsStats) {
+  return LdsCompileGeneral(strExpression, pgProgram, true, pcsStats);
+};
+
+// Minimal amount of switch cases for a jump table
+#define LDS_SWITCH_TABLE_CASES 4
+
+// Check if switch cases can be put into a jump table
+static bool SwitchTableCases(CDynamicNodeList &abnCases, const int &ctCases) {
+  if (ctCases < LDS_SWITCH_TABLE_CASES) {
+    return false;
+  }
+
+  // range of integer cases
+  int iMin = 0;
+  int iMax = 0;
+  int ctInts = 0;
+
+  for (int iCase = 0; iCase < ctCases; iCase++) {
+    CBuildNode &bnCase = *abnCases[iCase];
+
+    // only constant values
+    if (bnCase.lt_eType != EBN_RAW_VAL) {
+      return false;
+    }
+
+    switch (bnCase->GetType()) {
+      case EVT_INDEX: {
+        int iValue = bnCase->GetIndex();
+
+        if (ctInts == 0 || iValue < iMin) iMin = iValue;
+        if (ctInts == 0 || iValue > iMax) iMax = iValue;
+
+        ctInts++;
+      } break;
+
+      case EVT_STRING: break;
+
+      default: return false;
+    }
+  }
+
+  // integer cases should be dense enough
+  return (ctInts == 0 || double(iMax) - double(iMin) <= ctInts * 4.0 + 16.0);
+};
+
+// Get the variable
+void CLdsScriptEngine::CompileGetter(CBuildNode &bn, CActionList &aca) {
+  switch (bn.lt_eType) {
+    // iVal
+    case EBN_IDENTIFIER: {
+      string strName = bn->GetString();
+      
+      // custom variables and constants
+      if (_aLdsVariables.Find(strName) != NULL) {
+        aca.Add() = CCompAction(LCA_GET, bn.lt_iPos, strName, 0);
+        
+      // locals (if allowed)
+      } else if (!_bExpression) {
+        aca.Add() = CCompAction(LCA_GET, bn.lt_iPos, ExpandedLocal(strName), 1);
+        
+      } else {
+        LdsThrow(LEC_NOVAR, "Variable '%s' does not exist at %s", strName.c_str(), bn.PrintPos().c_str());
+      }
+    } return;
+      
+    // aArr[value][...]
+    case EBN_ACCESS:
+      CompileAccessors(bn, aca, false);
+      return;
+      
+    // ++iVal++ or ++++iVal (iVal++++ requires builder patching)
+    case EBN_PREFIX:
+    case EBN_POSTFIX:
+      Compile(bn, aca);
+      return;
+  }
+
+  LdsThrow(LEC_INVALIDEXP, "Unable to get data from the expression at %s", bn.PrintPos().c_str());
+};
+
+// Set the variable
+void CLdsScriptEngine::CompileSetter(CBuildNode &bn, CActionList &aca) {
+  switch (bn.lt_eType) {
+    // iVal
+    case EBN_IDENTIFIER: {
+      string strName = bn->GetString();
+      SLdsVar *pvarNonLocal = _aLdsVariables.Find(strName);
+      
+      // custom variables
+      if (pvarNonLocal != NULL) {
+        // can't change constants
+        if (pvarNonLocal->var_bConst > 1) {
+          LdsThrow(LEC_CONST, "Cannot change constant variable at %s", bn.PrintPos().c_str());
+        }
+      }
+      
+      // locals of the expanded function
+      if (pvarNonLocal == NULL) {
+        strName = ExpandedLocal(strName);
+      }
+      
+      aca.Add() = CCompAction(LCA_SET, bn.lt_iPos, strName, (pvarNonLocal == NULL));
+    } return;
+      
+    // aArr[value][...]
+    case EBN_ACCESS:
+      CompileAccessors(bn, aca, true);
+      return;
+
+    // ++iVal++ or ++++iVal (iVal++++ requires builder patching)
+    case EBN_PREFIX:
+    case EBN_POSTFIX:
+      Compile(bn, aca);
+      return;
+  }
+
+  LdsThrow(LEC_INVALIDEXP, "Unable to set data to the expression at %s", bn.PrintPos().c_str());
+};
+
+// Breaks and continues
+void CLdsScriptEngine::CompileBreakCont(CActionList &aca, int iStart, int iEnd, int iBreak, int iCont) {
+  for (int i = iStart; i < iEnd; i++) {
+    CCompAction &caAction = aca[i];
+  
+    if (caAction.lt_eType == LCA_JUMP) {
+      switch (caAction.lt_iArg) {
+        // breaks
+        case -10:
+          if (iBreak >= 0) {
+            caAction.lt_iArg = iBreak;
+          }
+          break;
+      
+        // continues
+        case -11:
+          if (iCont >= 0) {
+            caAction.lt_iArg = iCont;
+          }
+          break;
+      }
+    }
+  }
+};
+
+// Shift jumping positions
+void CLdsScriptEngine::CompileJumpShift(CActionList &aca, int iStart, int iShift) {
+  for (int i = iStart; i < aca.Count(); i++) {
+    CCompAction &caAction = aca[i];
+  
+    switch (caAction.lt_eType) {
+      // shift all of the jumping actions
+      case LCA_JUMP: case LCA_JUMPIF: case LCA_JUMPUNLESS:
+      case LCA_AND: case LCA_OR: case LCA_SWITCH:
+        caAction.lt_iArg += iShift;
+        break;
+    }
+  }
+};
+
+// Accessors
+void CLdsScriptEngine::CompileAccessors(CBuildNode &bn, CActionList &aca, bool bSet) {
+  // compile the initial value
+  if (bn.bn_abnNodes[0]->lt_eType != EBN_DISCARD_ACT) {
+    Compile(*bn.bn_abnNodes[0], aca);
+  }
+  
+  // compile every accessor
+  CBuildNode *pbnCurrentAccess = &bn;
+
+  while (pbnCurrentAccess != NULL) {
+    // add accessor value (index or variable name)
+    CBuildNode *pbnAccessVal = pbnCurrentAccess->bn_abnNodes[1];
+    Compile(*pbnAccessVal, aca);
+
+    // add access action
+    aca.Add() = CCompAction(LCA_BIN, pbnCurrentAccess->lt_iPos, LOP_ACCESS, bn.lt_iArg);
+
+    // no more accessors
+    if (pbnCurrentAccess->bn_abnNodes.Count() <= 2) {
+      break;
+    }
+
+    CBuildNode *pbnAccess = pbnCurrentAccess->bn_abnNodes[2];
+  
+    // if it's an accessor, compile it
+    if (pbnAccess->lt_eType == EBN_ACCESS) {
+      pbnCurrentAccess = pbnAccess;
+    
+    // not an accessor
+    } else {
+      pbnCurrentAccess = NULL;
+    }
+  }
+
+  if (bSet) {
+    aca.Add() = CCompAction(LCA_SET_ACCESS, bn.lt_iPos, -1, -1);
+  }
+};
+
+// Gather variables that may change within the loop
+static void GatherLoopWrites(CLdsScriptEngine &lds, CBuildNode &bn, DSList<string> &astrWrites, bool &bCalls) {
+  switch (bn.lt_eType) {
+    // assignments to variables or their elements
+    case EBN_ASSIGN_OP: case EBN_ADJFIX:
+    case EBN_PREFIX: case EBN_POSTFIX: {
+      CBuildNode *pbnTarget = bn.bn_abnNodes[0];
+
+      while (pbnTarget->lt_eType == EBN_ACCESS) {
+        pbnTarget = pbnTarget->bn_abnNodes[0];
+      }
+
+      if (pbnTarget->lt_eType == EBN_IDENTIFIER) {
+        astrWrites.Add(pbnTarget->lt_valValue->GetString());
+      }
+    } break;
+
+    case EBN_VAR_DEF:
+      astrWrites.Add(bn->GetString());
+      break;
+
+    // functions may change any variable unless they are pure
+    case EBN_CALL_ACT:
+      if (!lds.PureFunction(bn->GetString())) {
+        bCalls = true;
+      }
+      break;
+
+    case EBN_FUNC_DEF:
+      bCalls = true;
+      break;
+
+    // custom unary operators are functions too
+    case EBN_UNARY_OP:
+      if (!lds.PureUnaryOperator(bn->GetString())) {
+        bCalls = true;
+      }
+      break;
+  }
+
+  for (int iNode = 0; iNode < bn.bn_abnNodes.Count(); iNode++) {
+    GatherLoopWrites(lds, *bn.bn_abnNodes[iNode], astrWrites, bCalls);
+  }
+};
+
+// Check if the expression gives the same value on each loop iteration
+static bool LoopInvariant(CLdsScriptEngine &lds, CBuildNode &bn, DSList<string> &astrWrites, const bool &bCalls) {
+  switch (bn.lt_eType) {
+    case EBN_RAW_VAL: return true;
+
+    case EBN_IDENTIFIER: {
+      string strName = bn->GetString();
+
+      if (astrWrites.FindIndex(strName) != -1) {
+        return false;
+      }
+
+      // constant host variables
+      SLdsVar *pvar = lds._aLdsVariables.Find(strName);
+
+      if (pvar != NULL && pvar->var_bConst != 0) {
+        return true;
+      }
+
+      // other variables may be changed by called functions
+      return !bCalls;
+    }
+
+    case EBN_UNARY_OP:
+      if (!lds.PureUnaryOperator(bn->GetString())) {
+        return false;
+      }
+      return LoopInvariant(lds, *bn.bn_abnNodes[0], astrWrites, bCalls);
+
+    // pure functions with the same arguments
+    case EBN_CALL_ACT:
+      if (!lds.PureFunction(bn->GetString())) {
+        return false;
+      }
+
+      for (int iArg = 0; iArg < bn.lt_iArg; iArg++) {
+        if (!LoopInvariant(lds, *bn.bn_abnNodes[iArg], astrWrites, bCalls)) {
+          return false;
+        }
+      }
+      return true;
+
+    case EBN_BINARY_OP:
+      return LoopInvariant(lds, *bn.bn_abnNodes[0], astrWrites, bCalls)
+          && LoopInvariant(lds, *bn.bn_abnNodes[1], astrWrites, bCalls);
+
+    case EBN_ACCESS: {
+      // the rest of the accessor chain depends on the previous value
+      if (bn.bn_abnNodes[0]->lt_eType == EBN_DISCARD_ACT
+       || !LoopInvariant(lds, *bn.bn_abnNodes[0], astrWrites, bCalls)) {
+        return false;
+      }
+
+      // go through every accessor in the chain
+      CBuildNode *pbnAccess = &bn;
+
+      while (pbnAccess != NULL) {
+        if (!LoopInvariant(lds, *pbnAccess->bn_abnNodes[1], astrWrites, bCalls)) {
+          return false;
+        }
+
+        if (pbnAccess->bn_abnNodes.Count() <= 2 || pbnAccess->bn_abnNodes[2]->lt_eType != EBN_ACCESS) {
+          break;
+        }
+
+        pbnAccess = pbnAccess->bn_abnNodes[2];
+      }
+    } return true;
+  }
+
+  return false;
+};
+
+// Gather the biggest invariant expressions that are always evaluated together with the node
+static void GatherLoopInvariants(CLdsScriptEngine &lds, CBuildNode &bn, DSList<string> &astrWrites, const bool &bCalls,
+  CDynamicNodeList &apbnHoisted, CDynamicNodeList &apbnInvariants)
+{
+  switch (bn.lt_eType) {
+    // operations are worth computing once
+    case EBN_UNARY_OP: case EBN_BINARY_OP: case EBN_ACCESS: case EBN_CALL_ACT:
+      // already computed before an outer loop
+      if (apbnHoisted.FindIndex(&bn) != -1) {
+        return;
+      }
+
+      if (LoopInvariant(lds, bn, astrWrites, bCalls)) {
+        apbnInvariants.Add(&bn);
+        return;
+      }
+      break;
+
+    case EBN_RAW_VAL: case EBN_IDENTIFIER:
+      return;
+  }
+
+  int ctNodes = bn.bn_abnNodes.Count();
+
+  // right side of '&&' and '||' isn't always evaluated
+  if (bn.lt_eType == EBN_BINARY_OP && (bn->GetIndex() == LOP_AND || bn->GetIndex() == LOP_OR)) {
+    ctNodes = 1;
+  }
+
+  for (int iNode = 0; iNode < ctNodes; iNode++) {
+    GatherLoopInvariants(lds, *bn.bn_abnNodes[iNode], astrWrites, bCalls, apbnHoisted, apbnInvariants);
+  }
+};
+
+// Gather invariant expressions from statements until the first one that can jump somewhere (returns false if found it)
+static bool GatherStraightInvariants(CLdsScriptEngine &lds, CBuildNode &bn, DSList<string> &astrWrites, const bool &bCalls,
+  CDynamicNodeList &apbnHoisted, CDynamicNodeList &apbnInvariants)
+{
+  switch (bn.lt_eType) {
+    case EBN_DISCARD_ACT: case EBN_ASSIGN_OP: case EBN_ADJFIX:
+    case EBN_PREFIX: case EBN_POSTFIX: case EBN_VAR_DEF:
+      GatherLoopInvariants(lds, bn, astrWrites, bCalls, apbnHoisted, apbnInvariants);
+      return true;
+
+    case EBN_BLOCK:
+      for (int iStatement = 0; iStatement < bn.lt_iArg; iStatement++) {
+        if (!GatherStraightInvariants(lds, *bn.bn_abnNodes[iStatement], astrWrites, bCalls, apbnHoisted, apbnInvariants)) {
+          return false;
+        }
+      }
+      return true;
+  }
+
+  return false;
+};
+
+// Find invariant expressions of the loop in its condition and in statements that are always executed at the beginning of its body
+static void FindLoopInvariants(CLdsScriptEngine &lds, CBuildNode &bnLoop, CBuildNode *pbnCond, CBuildNode &bnBody,
+  CDynamicNodeList &apbnHoisted, CDynamicNodeList &apbnCond, CDynamicNodeList &apbnBody)
+{
+  DSList<string> astrWrites;
+  bool bCalls = false;
+
+  GatherLoopWrites(lds, bnLoop, astrWrites, bCalls);
+
+  // condition is always evaluated first
+  if (pbnCond != NULL) {
+    GatherLoopInvariants(lds, *pbnCond, astrWrites, bCalls, apbnHoisted, apbnCond);
+  }
+
+  // called functions may depend on the order of evaluation
+  if (!bCalls) {
+    GatherStraightInvariants(lds, bnBody, astrWrites, bCalls, apbnHoisted, apbnBody);
+  }
+};
+
+// Compute loop-invariant expressions before the loop
+void CLdsScriptEngine::CompileInvariants(CDynamicNodeList &apbnInvariants, CActionList &aca) {
+  for (int iExp = 0; iExp < apbnInvariants.Count(); iExp++) {
+    CBuildNode &bnExp = *apbnInvariants[iExp];
+    string strHoisted = LdsPrintF("#%d", _ctHoisted++);
+
+    aca.Add() = CCompAction(LCA_VAR, bnExp.lt_iPos, strHoisted, 0);
+    Compile(bnExp, aca);
+    aca.Add() = CCompAction(LCA_SET, bnExp.lt_iPos, strHoisted, 1);
+
+    // use the variable from now on
+    _apbnHoisted.Add(&bnExp);
+    _astrHoisted.Add(strHoisted);
+  }
+};
+
+// Stop using values of expressions that have been hoisted out of the loop
+void CLdsScriptEngine::ForgetInvariants(const int &ctKeep) {
+  while (_apbnHoisted.Count() > ctKeep) {
+    _apbnHoisted.Delete(_apbnHoisted.Count() - 1);
+    _astrHoisted.Delete(_astrHoisted.Count() - 1);
+  }
+};
+
+// Compute constant expression with pure functions and operators (returns false if it can't be computed)
+static bool ConstantValue(CLdsScriptEngine &lds, CBuildNode &bn, CLdsValue &valResult) {
+  string strFunc = bn->GetString();
+  int ctArgs = 0;
+
+  switch (bn.lt_eType) {
+    case EBN_RAW_VAL:
+      valResult = bn.lt_valValue;
+      return true;
+
+    case EBN_UNARY_OP:
+      if (!lds.PureUnaryOperator(strFunc)) {
+        return false;
+      }
+      ctArgs = 1;
+      break;
+
+    case EBN_BINARY_OP:
+      // right side of '&&' and '||' isn't always evaluated
+      if (bn->GetIndex() == LOP_AND || bn->GetIndex() == LOP_OR) {
+        return false;
+      }
+      ctArgs = 2;
+      break;
+
+    case EBN_CALL_ACT:
+      // wrong argument count is reported by the compiler
+      if (!lds.PureFunction(strFunc) || lds._mapLdsFunctions[strFunc].ef_iArgs != bn.lt_iArg) {
+        return false;
+      }
+      ctArgs = bn.lt_iArg;
+      break;
+
+    default: return false;
+  }
+
+  // all arguments should be constant
+  CLdsArray aArgs;
+  aArgs.New(ctArgs);
+
+  for (int iArg = 0; iArg < ctArgs; iArg++) {
+    if (!ConstantValue(lds, *bn.bn_abnNodes[iArg], aArgs[iArg])) {
+      return false;
+    }
+  }
+
+  // leave errors until the execution
+  try {
+    switch (bn.lt_eType) {
+      case EBN_UNARY_OP: {
+        CLdsValueRef valRef(aArgs[0]);
+        int iCustom = lds._mapLdsUnaryOps.FindKeyIndex(strFunc);
+
+        if (iCustom != -1) {
+          valRef = lds._mapLdsUnaryOps.GetValue(iCustom)(&valRef.vr_val);
+
+        } else {
+          valRef = valRef.vr_val->UnaryOp(valRef, bn);
+        }
+
+        valResult = valRef.vr_val;
+      } break;
+
+      case EBN_BINARY_OP: {
+        CLdsValueRef valRef1(aArgs[0]);
+        CLdsValueRef valRef2(aArgs[1]);
+
+        valResult = valRef1.vr_val->BinaryOp(valRef1, valRef2, bn).vr_val;
+      } break;
+
+      default:
+        valResult = lds._mapLdsFunctions[strFunc].ef_pFunc(ctArgs > 0 ? &aArgs[0] : NULL).vr_val;
+    }
+
+  } catch (char *strError) {
+    (void)strError;
+    return false;
+
+  } catch (SLdsError leError) {
+    (void)leError;
+    return false;
   }
 
-  // cache the script
-  if (_bUseScriptCaching) {
-    CLdsProgram pgCache(acaCompiled);
-    _mapScriptCache.Add(iScriptHash, SLdsCache(pgCache, bExpression));
+  // only simple values can be stored in actions
+  switch (valResult->GetType()) {
+    case EVT_INDEX: case EVT_FLOAT: case EVT_STRING: return true;
+    default: break;
   }
 
-  // copy compiled actions
-  pgProgram.acaProgram.MoveArray(acaCompiled);
-  return LER_OK;
+  return false;
 };
 
-// Compile the script
-ELdsError CLdsScriptEngine::LdsCompileScript(const string &strScript, CLdsProgram &pgProgram) {
-  return LdsCompileGeneral(strScript, pgProgram, false);
-};
+// Check if two expressions are exactly the same
+static bool SameExpression(CBuildNode &bn1, CBuildNode &bn2) {
+  if (bn1.lt_eType != bn2.lt_eType || bn1.lt_iArg != bn2.lt_iArg
+   || bn1.bn_abnNodes.Count() != bn2.bn_abnNodes.Count()) {
+    return false;
+  }
 
-// Compile the expression
-ELdsError CLdsScriptEngine::LdsCompileExpression(const string &strExpression, CLdsProgram &pgProgram) {
-  return LdsCompileGeneral(strExpression, pgProgram, true);
-};
+  switch (bn1.lt_eType) {
+    case EBN_RAW_VAL: case EBN_BINARY_OP: {
+      ELdsValueType eType = bn1.lt_valValue->GetType();
 
-// Get the variable
-void CLdsScriptEngine::CompileGetter(CBuildNode &bn, CActionList &aca) {
-  switch (bn.lt_eType) {
-    // iVal
-    case EBN_IDENTIFIER: {
-      string strName = bn->GetString();
-      
-      // custom variables and constants
-      if (_aLdsVariables.Find(strName) != NULL) {
-        aca.Add() = CCompAction(LCA_GET, bn.lt_iPos, strName, 0);
-        
-      // locals (if allowed)
-      } else if (!_bExpression) {
-        aca.Add() = CCompAction(LCA_GET, bn.lt_iPos, strName, 1);
-        
-      } else {
-        LdsThrow(LEC_NOVAR, "Variable '%s' does not exist at %s", strName.c_str(), bn.PrintPos().c_str());
+      if (eType != bn2.lt_valValue->GetType()) {
+        return false;
       }
-    } return;
-      
-    // aArr[value][...]
-    case EBN_ACCESS:
-      CompileAccessors(bn, aca, false);
-      return;
-      
-    // ++iVal++ or ++++iVal (iVal++++ requires builder patching)
-    case EBN_PREFIX:
-    case EBN_POSTFIX:
-      Compile(bn, aca);
-      return;
+
+      if (eType == EVT_STRING) {
+        if (bn1->GetString() != bn2->GetString()) {
+          return false;
+        }
+
+      } else if (eType != EVT_INDEX && eType != EVT_FLOAT) {
+        return false;
+
+      } else if (bn1->GetNumber() != bn2->GetNumber()) {
+        return false;
+      }
+    } break;
+
+    case EBN_IDENTIFIER: case EBN_UNARY_OP: case EBN_CALL_ACT:
+      if (bn1->GetString() != bn2->GetString()) {
+        return false;
+      }
+      break;
+
+    default: return false;
   }
 
-  LdsThrow(LEC_INVALIDEXP, "Unable to get data from the expression at %s", bn.PrintPos().c_str());
+  for (int iNode = 0; iNode < bn1.bn_abnNodes.Count(); iNode++) {
+    if (!SameExpression(*bn1.bn_abnNodes[iNode], *bn2.bn_abnNodes[iNode])) {
+      return false;
+    }
+  }
+
+  return true;
 };
 
-// Set the variable
-void CLdsScriptEngine::CompileSetter(CBuildNode &bn, CActionList &aca) {
+// Gather pure function calls that are always evaluated within the expression
+static void GatherPureCalls(CLdsScriptEngine &lds, CBuildNode &bn, DSList<string> &astrWrites, CDynamicNodeList &apbnHoisted, CDynamicNodeList &apbnCalls) {
   switch (bn.lt_eType) {
-    // iVal
-    case EBN_IDENTIFIER: {
-      string strName = bn->GetString();
-      SLdsVar *pvarNonLocal = _aLdsVariables.Find(strName);
-      
-      // custom variables
-      if (pvarNonLocal != NULL) {
-        // can't change constants
-        if (pvarNonLocal->var_bConst > 1) {
-          LdsThrow(LEC_CONST, "Cannot change constant variable at %s", bn.PrintPos().c_str());
+    case EBN_RAW_VAL: case EBN_IDENTIFIER:
+      return;
+
+    case EBN_CALL_ACT:
+      // already computed before the loop
+      if (apbnHoisted.FindIndex(&bn) != -1) {
+        return;
+      }
+
+      if (LoopInvariant(lds, bn, astrWrites, false)) {
+        bool bRepeated = false;
+
+        for (int iCall = 0; iCall < apbnCalls.Count(); iCall++) {
+          if (SameExpression(*apbnCalls[iCall], bn)) {
+            bRepeated = true;
+            break;
+          }
+        }
+
+        apbnCalls.Add(&bn);
+
+        // arguments of the repeated call aren't going to be computed
+        if (bRepeated) {
+          return;
         }
       }
-      
-      aca.Add() = CCompAction(LCA_SET, bn.lt_iPos, strName, (pvarNonLocal == NULL));
-    } return;
-      
-    // aArr[value][...]
-    case EBN_ACCESS:
-      CompileAccessors(bn, aca, true);
-      return;
+      break;
+  }
 
-    // ++iVal++ or ++++iVal (iVal++++ requires builder patching)
-    case EBN_PREFIX:
-    case EBN_POSTFIX:
-      Compile(bn, aca);
-      return;
+  int ctNodes = bn.bn_abnNodes.Count();
+
+  // right side of '&&' and '||' isn't always evaluated
+  if (bn.lt_eType == EBN_BINARY_OP && (bn->GetIndex() == LOP_AND || bn->GetIndex() == LOP_OR)) {
+    ctNodes = 1;
   }
 
-  LdsThrow(LEC_INVALIDEXP, "Unable to set data to the expression at %s", bn.PrintPos().c_str());
+  for (int iNode = 0; iNode < ctNodes; iNode++) {
+    GatherPureCalls(lds, *bn.bn_abnNodes[iNode], astrWrites, apbnHoisted, apbnCalls);
+  }
 };
 
-// Breaks and continues
-void CLdsScriptEngine::CompileBreakCont(CActionList &aca, int iStart, int iEnd, int iBreak, int iCont) {
-  for (int i = iStart; i < iEnd; i++) {
-    CCompAction &caAction = aca[i];
-  
-    if (caAction.lt_eType == LCA_JUMP) {
-      switch (caAction.lt_iArg) {
-        // breaks
-        case -10:
-          if (iBreak >= 0) {
-            caAction.lt_iArg = iBreak;
-          }
-          break;
-      
-        // continues
-        case -11:
-          if (iCont >= 0) {
-            caAction.lt_iArg = iCont;
-          }
-          break;
+// Compute repeated pure function calls of the statement once (returns amount of values to keep after the statement)
+int CLdsScriptEngine::CompileCommonCalls(CBuildNode &bn, CActionList &aca) {
+  int ctKeep = _apbnHoisted.Count();
+
+  // expressions have no local variables
+  if (_bExpression) {
+    return ctKeep;
+  }
+
+  DSList<string> astrWrites;
+  bool bCalls = false;
+
+  GatherLoopWrites(*this, bn, astrWrites, bCalls);
+
+  // called functions may change arguments of other calls
+  if (bCalls) {
+    return ctKeep;
+  }
+
+  CDynamicNodeList apbnCalls;
+  GatherPureCalls(*this, bn, astrWrites, _apbnHoisted, apbnCalls);
+
+  for (int iCall = 0; iCall < apbnCalls.Count(); iCall++) {
+    CBuildNode &bnCall = *apbnCalls[iCall];
+
+    // already computed with the same call
+    if (_apbnHoisted.FindIndex(&bnCall) != -1) {
+      continue;
+    }
+
+    // find the same calls
+    CDynamicNodeList apbnSame;
+
+    for (int iOther = iCall + 1; iOther < apbnCalls.Count(); iOther++) {
+      if (SameExpression(bnCall, *apbnCalls[iOther])) {
+        apbnSame.Add(apbnCalls[iOther]);
       }
     }
+
+    if (apbnSame.Count() <= 0) {
+      continue;
+    }
+
+    string strHoisted = LdsPrintF("#%d", _ctHoisted++);
+
+    aca.Add() = CCompAction(LCA_VAR, bnCall.lt_iPos, strHoisted, 0);
+    Compile(bnCall, aca);
+    aca.Add() = CCompAction(LCA_SET, bnCall.lt_iPos, strHoisted, 1);
+
+    // use the variable for every call
+    _apbnHoisted.Add(&bnCall);
+    _astrHoisted.Add(strHoisted);
+
+    for (int iSame = 0; iSame < apbnSame.Count(); iSame++) {
+      _apbnHoisted.Add(apbnSame[iSame]);
+      _astrHoisted.Add(strHoisted);
+    }
   }
+
+  return ctKeep;
 };
 
-// Shift jumping positions
-void CLdsScriptEngine::CompileJumpShift(CActionList &aca, int iStart, int iShift) {
-  for (int i = iStart; i < aca.Count(); i++) {
-    CCompAction &caAction = aca[i];
-  
-    switch (caAction.lt_eType) {
-      // shift all of the jumping actions
-      case LCA_JUMP: case LCA_JUMPIF: case LCA_JUMPUNLESS:
-      case LCA_AND: case LCA_OR:
-        caAction.lt_iArg += iShift;
-        break;
+// Expand inline function call in place (returns false if it can't be expanded)
+bool CLdsScriptEngine::CompileInlineCall(CBuildNode &bn, CActionList &aca) {
+  // only expand calls from the main program
+  if (_ctInlineNodes <= 0 || _bFuncBody) {
+    return false;
+  }
+
+  string strFunc = bn->GetString();
+  int iBody = _mapInlineBodies.FindKeyIndex(strFunc);
+
+  // function within a function or it's already being expanded
+  if (iBody == -1 || _astrExpanding.FindIndex(strFunc) != -1) {
+    return false;
+  }
+
+  CBuildNode &bnBody = *_mapInlineBodies.GetValue(iBody);
+
+  // too big or can't be expanded
+  int ctNodes = InlineBodyNodes(bnBody, false);
+
+  if (ctNodes == -1 || ctNodes > _ctInlineNodes) {
+    return false;
+  }
+
+  // recursive function
+  DSList<string> astrVisited;
+
+  if (CallsInlineFunction(bnBody, _mapInlineBodies, strFunc, astrVisited)) {
+    return false;
+  }
+
+  // uses variables of the caller with the same names as its locals
+  DSList<string> astrLocals, astrDefined;
+  GatherBodyLocals(bnBody, astrLocals);
+
+  if (!LocalsDefinedBeforeUse(bnBody, astrLocals, astrDefined)) {
+    return false;
+  }
+
+  // compile arguments before switching to function locals
+  int ctArgs = bn.lt_iArg;
+  int iArg;
+
+  for (iArg = 0; iArg < ctArgs; iArg++) {
+    Compile(*bn.bn_abnNodes[iArg], aca);
+  }
+
+  // function locals
+  CLdsInlineArgs &astrArgs = _mapInlineFunc[strFunc];
+  const int ctLocals = _astrExpandedLocals.Count();
+
+  for (iArg = 0; iArg < ctArgs; iArg++) {
+    string strArg = strFunc + ":" + astrArgs[iArg];
+
+    if (_astrExpandedLocals.FindIndex(strArg) == -1) {
+      _astrExpandedLocals.Add(strArg);
     }
   }
-};
 
-// Accessors
-void CLdsScriptEngine::CompileAccessors(CBuildNode &bn, CActionList &aca, bool bSet) {
-  // compile the initial value
-  if (bn.bn_abnNodes[0]->lt_eType != EBN_DISCARD_ACT) {
-    Compile(*bn.bn_abnNodes[0], aca);
+  GatherExpandedLocals(bnBody, strFunc, _astrExpandedLocals);
+  _astrExpanding.Add(strFunc);
+
+  // move argument values into locals (last argument is on top)
+  for (iArg = ctArgs - 1; iArg >= 0; iArg--) {
+    string strArg = strFunc + ":" + astrArgs[iArg];
+
+    aca.Add() = CCompAction(LCA_VAR, bn.lt_iPos, strArg, 0);
+    aca.Add() = CCompAction(LCA_SET, bn.lt_iPos, strArg, 1);
   }
-  
-  // compile every accessor
-  CBuildNode *pbnCurrentAccess = &bn;
 
-  while (pbnCurrentAccess != NULL) {
-    // add accessor value (index or variable name)
-    CBuildNode *pbnAccessVal = pbnCurrentAccess->bn_abnNodes[1];
-    Compile(*pbnAccessVal, aca);
+  // function body
+  int iBodyStart = aca.Count();
+  Compile(bnBody, aca);
 
-    // add access action
-    aca.Add() = CCompAction(LCA_BIN, pbnCurrentAccess->lt_iPos, LOP_ACCESS, bn.lt_iArg);
+  int iBodyEnd = aca.Count();
+  int iAction;
 
-    // no more accessors
-    if (pbnCurrentAccess->bn_abnNodes.Count() <= 2) {
-      break;
+  // check if something jumps right after the last return
+  bool bLastReturn = (iBodyEnd > iBodyStart && aca[iBodyEnd - 1].lt_eType == LCA_JUMP && aca[iBodyEnd - 1].lt_iArg == -12);
+
+  for (iAction = iBodyStart; iAction < iBodyEnd && bLastReturn; iAction++) {
+    switch (aca[iAction].lt_eType) {
+      case LCA_JUMP: case LCA_JUMPIF: case LCA_JUMPUNLESS:
+      case LCA_AND: case LCA_OR: case LCA_SWITCH:
+        if (aca[iAction].lt_iArg == iBodyEnd) {
+          bLastReturn = false;
+        }
+        break;
     }
+  }
 
-    CBuildNode *pbnAccess = pbnCurrentAccess->bn_abnNodes[2];
-  
-    // if it's an accessor, compile it
-    if (pbnAccess->lt_eType == EBN_ACCESS) {
-      pbnCurrentAccess = pbnAccess;
-    
-    // not an accessor
-    } else {
-      pbnCurrentAccess = NULL;
+  // last return doesn't need to jump anywhere
+  if (bLastReturn) {
+    aca.Delete(--iBodyEnd);
+
+  // return nothing at the end of the body
+  } else {
+    aca.Add() = CCompAction(LCA_VAL, bn.lt_iPos, 0, -1);
+    iBodyEnd++;
+  }
+
+  // jump from returns to the end of the body
+  for (iAction = iBodyStart; iAction < iBodyEnd; iAction++) {
+    CCompAction &caAction = aca[iAction];
+
+    if (caAction.lt_eType == LCA_JUMP && caAction.lt_iArg == -12) {
+      caAction.lt_iArg = iBodyEnd;
     }
   }
 
-  if (bSet) {
-    aca.Add() = CCompAction(LCA_SET_ACCESS, bn.lt_iPos, -1, -1);
+  // back to the previous function
+  _astrExpanding.Delete(_astrExpanding.Count() - 1);
+
+  while (_astrExpandedLocals.Count() > ctLocals) {
+    _astrExpandedLocals.Delete(_astrExpandedLocals.Count() - 1);
   }
+
+  return true;
 };
 
 // Compile nodes recursively
 void CLdsScriptEngine::Compile(CBuildNode &bn, CActionList &aca) {
+  // value has been computed before the loop
+  if (_apbnHoisted.Count() > 0) {
+    int iHoisted = _apbnHoisted.FindIndex(&bn);
+
+    if (iHoisted != -1) {
+      aca.Add() = CCompAction(LCA_GET, bn.lt_iPos, _astrHoisted[iHoisted], 1);
+      return;
+    }
+  }
+
+  // compute pure functions and operators with constant arguments right away
+  switch (bn.lt_eType) {
+    case EBN_UNARY_OP: case EBN_BINARY_OP: case EBN_CALL_ACT: {
+      CLdsValue valConst;
+
+      if (ConstantValue(*this, bn, valConst)) {
+        aca.Add() = CCompAction(LCA_VAL, bn.lt_iPos, valConst, -1);
+        return;
+      }
+    } break;
+  }
+
   switch (bn.lt_eType) {
     // values
     case EBN_RAW_VAL: aca.Add() = CCompAction(LCA_VAL, bn.lt_iPos, bn.lt_valValue, -1); break;
@@ -290,7 +1424,7 @@ void CLdsScriptEngine::Compile(CBuildNode &bn, CActionList &aca) {
           Compile(*bn.bn_abnNodes[0], aca);
           Compile(*bn.bn_abnNodes[1], aca);
 
-          aca.Add() = CCompAction(LCA_BIN, bn.lt_iPos, bn.lt_valValue, -1);
+          AddBinaryAction(aca, bn.lt_iPos, bn->GetIndex(), ExpressionType(*bn.bn_abnNodes[0]), ExpressionType(*bn.bn_abnNodes[1]));
       }
       break;
 
@@ -324,6 +1458,11 @@ void CLdsScriptEngine::Compile(CBuildNode &bn, CActionList &aca) {
         LdsThrow(LEC_NOFUNC, "Unknown function '%s' at %s", strFunc.c_str(), bn.PrintPos().c_str());
       }
 
+      // put the function body right here
+      if (eAction == LCA_INLINE && CompileInlineCall(bn, aca)) {
+        break;
+      }
+
       for (int iArg = 0; iArg < ctArgs; iArg++) {
         Compile(*bn.bn_abnNodes[iArg], aca);
       }
@@ -338,7 +1477,12 @@ void CLdsScriptEngine::Compile(CBuildNode &bn, CActionList &aca) {
       
       // compile the function
       CActionList acaFunc;
+
+      bool bPrevBody = _bFuncBody;
+      _bFuncBody = true;
+
       Compile(*bn.bn_abnNodes[0], acaFunc);
+      _bFuncBody = bPrevBody;
       
       // define inline function
       CCompAction caInline = CCompAction(LCA_FUNC, bn.lt_iPos, strFunc, -1);
@@ -362,7 +1506,7 @@ void CLdsScriptEngine::Compile(CBuildNode &bn, CActionList &aca) {
       }
       
       // add new local variable
-      aca.Add() = CCompAction(LCA_VAR, bn.lt_iPos, bn.lt_valValue, bn.lt_iArg);
+      aca.Add() = CCompAction(LCA_VAR, bn.lt_iPos, ExpandedLocal(strVar), bn.lt_iArg);
     } break;
     
     // object property definition
@@ -395,21 +1539,47 @@ void CLdsScriptEngine::Compile(CBuildNode &bn, CActionList &aca) {
     // return a value if possible
     case EBN_RETURN_ACT:
       if (bn.lt_iArg > 0) {
+        int ctHoisted = CompileCommonCalls(*bn.bn_abnNodes[0], aca);
         Compile(*bn.bn_abnNodes[0], aca);
+        ForgetInvariants(ctHoisted);
+
+        // return the result of another inline function from the current one
+        if (_bFuncBody && _astrExpanding.Count() <= 0 && bn.bn_abnNodes[0]->lt_eType == EBN_CALL_ACT) {
+          CCompAction &caLast = aca[aca.Count() - 1];
+
+          if (caLast.lt_eType == LCA_INLINE) {
+            caLast.lt_eType = LCA_TAILCALL;
+          }
+        }
+
+      // expanded functions always return something
+      } else if (_astrExpanding.Count() > 0) {
+        aca.Add() = CCompAction(LCA_VAL, bn.lt_iPos, 0, -1);
+      }
+
+      // jump to the end of the expanded function
+      if (_astrExpanding.Count() > 0) {
+        aca.Add() = CCompAction(LCA_JUMP, bn.lt_iPos, -1, -12);
+        break;
       }
 
       aca.Add() = CCompAction(LCA_RETURN, bn.lt_iPos, -1, -1);
       break;
     
     // discard last value
-    case EBN_DISCARD_ACT:
+    case EBN_DISCARD_ACT: {
+      int ctHoisted = CompileCommonCalls(*bn.bn_abnNodes[0], aca);
       Compile(*bn.bn_abnNodes[0], aca);
+      ForgetInvariants(ctHoisted);
+
       aca.Add() = CCompAction(LCA_DISCARD, bn.lt_iPos, -1, -1);
-      break;
+    } break;
     
     // jump through the 'if' block unless the condition is true
     case EBN_IF_THEN: {
+      int ctHoisted = CompileCommonCalls(*bn.bn_abnNodes[0], aca);
       Compile(*bn.bn_abnNodes[0], aca);
+      ForgetInvariants(ctHoisted);
         
       CCompAction caJump = CCompAction(LCA_JUMPUNLESS, bn.lt_iPos, -1, -1);
       int iJump = aca.Add(caJump);
@@ -421,7 +1591,9 @@ void CLdsScriptEngine::Compile(CBuildNode &bn, CActionList &aca) {
   
     // jump through the 'if' block unless the condition is true, then jump through 'else'
     case EBN_IF_THEN_ELSE: {
+      int ctHoisted = CompileCommonCalls(*bn.bn_abnNodes[0], aca);
       Compile(*bn.bn_abnNodes[0], aca);
+      ForgetInvariants(ctHoisted);
         
       CCompAction caJumpElse = CCompAction(LCA_JUMPUNLESS, bn.lt_iPos, -1, -1);
       int iJumpElse = aca.Add(caJumpElse);
@@ -452,6 +1624,11 @@ void CLdsScriptEngine::Compile(CBuildNode &bn, CActionList &aca) {
     
       // header value
       Compile(*bn.bn_abnNodes[0], aca);
+
+      // jump straight to constant cases
+      if (SwitchTableCases(abnCases, ctCases)) {
+        aca.Add() = CCompAction(LCA_SWITCH_TABLE, bn.lt_iPos, -1, ctCases);
+      }
     
       // compile case value, remember jump position for this case's actions
       for (int iCase = 0; iCase < ctCases; iCase++) {
@@ -500,6 +1677,8 @@ void CLdsScriptEngine::Compile(CBuildNode &bn, CActionList &aca) {
     } break;
     
     case EBN_ASSIGN_OP: {
+      int ctHoisted = CompileCommonCalls(bn, aca);
+
       // get the value
       if (bn->GetIndex() == LOP_SET) {
         Compile(*bn.bn_abnNodes[1], aca);
@@ -509,11 +1688,12 @@ void CLdsScriptEngine::Compile(CBuildNode &bn, CActionList &aca) {
         CompileGetter(*bn.bn_abnNodes[0], aca);
         Compile(*bn.bn_abnNodes[1], aca);
       
-        aca.Add() = CCompAction(LCA_BIN, bn.lt_iPos, bn.lt_valValue, -1);
+        AddBinaryAction(aca, bn.lt_iPos, bn->GetIndex(), ExpressionType(*bn.bn_abnNodes[0]), ExpressionType(*bn.bn_abnNodes[1]));
       }
     
       // set the new value
       CompileSetter(*bn.bn_abnNodes[0], aca);
+      ForgetInvariants(ctHoisted);
     } break;
     
     case EBN_ADJFIX: {
@@ -522,7 +1702,7 @@ void CLdsScriptEngine::Compile(CBuildNode &bn, CActionList &aca) {
 
       // add the value and perform the operation
       aca.Add() = CCompAction(LCA_VAL, bn.lt_iPos, bn.lt_valValue, -1);
-      aca.Add() = CCompAction(LCA_BIN, bn.lt_iPos, LOP_ADD, -1);
+      AddBinaryAction(aca, bn.lt_iPos, LOP_ADD, ExpressionType(*bn.bn_abnNodes[0]), bn.lt_valValue->GetType());
       
       // set the new value
       CompileSetter(*bn.bn_abnNodes[0], aca);
@@ -534,7 +1714,7 @@ void CLdsScriptEngine::Compile(CBuildNode &bn, CActionList &aca) {
       
       // add the value, perform the operation and duplicate the entry
       aca.Add() = CCompAction(LCA_VAL, bn.lt_iPos, bn.lt_valValue, -1);
-      aca.Add() = CCompAction(LCA_BIN, bn.lt_iPos, LOP_ADD, -1);
+      AddBinaryAction(aca, bn.lt_iPos, LOP_ADD, ExpressionType(*bn.bn_abnNodes[0]), bn.lt_valValue->GetType());
       aca.Add() = CCompAction(LCA_DUP, bn.lt_iPos, -1, -1);
       
       // set the new value
@@ -548,7 +1728,7 @@ void CLdsScriptEngine::Compile(CBuildNode &bn, CActionList &aca) {
       // duplicate the entry, add the value and perform the operation
       aca.Add() = CCompAction(LCA_DUP, bn.lt_iPos, -1, -1);
       aca.Add() = CCompAction(LCA_VAL, bn.lt_iPos, bn.lt_valValue, -1);
-      aca.Add() = CCompAction(LCA_BIN, bn.lt_iPos, LOP_ADD, -1);
+      AddBinaryAction(aca, bn.lt_iPos, LOP_ADD, ExpressionType(*bn.bn_abnNodes[0]), bn.lt_valValue->GetType());
       
       // set the new value
       CompileSetter(*bn.bn_abnNodes[0], aca);
@@ -560,6 +1740,30 @@ void CLdsScriptEngine::Compile(CBuildNode &bn, CActionList &aca) {
     } break;
     
     case EBN_WHILE_LOOP: {
+      const int ctHoisted = _apbnHoisted.Count();
+
+      // compute invariant expressions once
+      CDynamicNodeList apbnCond, apbnBody;
+      FindLoopInvariants(*this, bn, bn.bn_abnNodes[0], *bn.bn_abnNodes[1], _apbnHoisted, apbnCond, apbnBody);
+
+      CompileInvariants(apbnCond, aca);
+
+      // body expressions are only computed if the loop is entered
+      int iGuard = -1;
+      int iEnter = -1;
+
+      if (apbnBody.Count() > 0) {
+        Compile(*bn.bn_abnNodes[0], aca);
+
+        CCompAction caGuard = CCompAction(LCA_JUMPUNLESS, bn.lt_iPos, -1, -1);
+        iGuard = aca.Add(caGuard);
+
+        CompileInvariants(apbnBody, aca);
+
+        CCompAction caEnter = CCompAction(LCA_JUMP, bn.lt_iPos, -1, -1);
+        iEnter = aca.Add(caEnter);
+      }
+
       // jump through the loop unless the condition is true
       int iContPos = aca.Count();
     
@@ -577,11 +1781,25 @@ void CLdsScriptEngine::Compile(CBuildNode &bn, CActionList &aca) {
       // break from the loop
       int iBreakPos = aca.Count();
       aca[iJump].lt_iArg = iBreakPos;
+
+      if (iGuard != -1) {
+        aca[iGuard].lt_iArg = iBreakPos;
+        aca[iEnter].lt_iArg = iStartPos;
+      }
     
       CompileBreakCont(aca, iStartPos, iBreakPos, iBreakPos, iContPos);
+      ForgetInvariants(ctHoisted);
     } break;
     
     case EBN_DO_LOOP: {
+      const int ctHoisted = _apbnHoisted.Count();
+
+      // compute invariant expressions once (the body is always entered)
+      CDynamicNodeList apbnCond, apbnBody;
+      FindLoopInvariants(*this, bn, NULL, *bn.bn_abnNodes[0], _apbnHoisted, apbnCond, apbnBody);
+
+      CompileInvariants(apbnBody, aca);
+
       // go through the loop
       int iStartPos = aca.Count();
     
@@ -596,10 +1814,35 @@ void CLdsScriptEngine::Compile(CBuildNode &bn, CActionList &aca) {
       // break from the loop
       int iBreakPos = aca.Count();
       CompileBreakCont(aca, iStartPos, iBreakPos, iBreakPos, iContPos);
+      ForgetInvariants(ctHoisted);
     } break;
     
     case EBN_FOR_LOOP: {
       Compile(*bn.bn_abnNodes[0], aca);
+
+      const int ctHoisted = _apbnHoisted.Count();
+
+      // compute invariant expressions once
+      CDynamicNodeList apbnCond, apbnBody;
+      FindLoopInvariants(*this, bn, bn.bn_abnNodes[1], *bn.bn_abnNodes[3], _apbnHoisted, apbnCond, apbnBody);
+
+      CompileInvariants(apbnCond, aca);
+
+      // body expressions are only computed if the loop is entered
+      int iGuard = -1;
+      int iEnter = -1;
+
+      if (apbnBody.Count() > 0) {
+        Compile(*bn.bn_abnNodes[1], aca);
+
+        CCompAction caGuard = CCompAction(LCA_JUMPUNLESS, bn.lt_iPos, -1, -1);
+        iGuard = aca.Add(caGuard);
+
+        CompileInvariants(apbnBody, aca);
+
+        CCompAction caEnter = CCompAction(LCA_JUMP, bn.lt_iPos, -1, -1);
+        iEnter = aca.Add(caEnter);
+      }
     
       // jump through the loop unless the condition is true
       int iLoopPos = aca.Count();
@@ -623,8 +1866,14 @@ void CLdsScriptEngine::Compile(CBuildNode &bn, CActionList &aca) {
       // break from the loop
       int iBreakPos = aca.Count();
       aca[iJump].lt_iArg = iBreakPos;
+
+      if (iGuard != -1) {
+        aca[iGuard].lt_iArg = iBreakPos;
+        aca[iEnter].lt_iArg = iStartPos;
+      }
     
       CompileBreakCont(aca, iStartPos, iBreakPos, iBreakPos, iContPos);
+      ForgetInvariants(ctHoisted);
     } break;
     
     // break from the statement
@@ -20,6 +20,8 @@ SOFTWARE. */
 
 #include "StdH.h"
 
+#include <string.h>
+
 // Escape character prefix
 #define ESCAPE_CHAR '\\'
 
@@ -36,7 +38,7 @@ static int _iPos;
 #define COUNT_LINE _iLine++; _iLineStart = _iPos
 
 // Parse line comment
-static void ParseLineComment(const string &str) {
+static void ParseLineComment(const char *str) {
   UNTIL_END {
     // line comment end
     if (str[_iPos] == '\r' || str[_iPos] == '\n') {
@@ -48,7 +50,7 @@ static void ParseLineComment(const string &str) {
 };
 
 // Parse block comment
-static void ParseBlockComment(const string &str) {
+static void ParseBlockComment(const char *str) {
   _iPos++;
 
   UNTIL_END {
@@ -66,6 +68,79 @@ static void ParseBlockComment(const string &str) {
   }
 };
 
+// Script keyword
+struct SLdsKeyword {
+  const char *strName;
+  int ctLen;
+  ELdsToken eToken;
+  char ubValue; // 0 - no value, 1 - index, 2 - float
+  double dValue;
+};
+
+// Keywords and their tokens
+static const SLdsKeyword _akwKeywords[] = {
+  // operators
+  { "mod", 3, LTK_OPERATOR, 1, LOP_FMOD },
+  { "div", 3, LTK_OPERATOR, 1, LOP_IDIV },
+  { "and", 3, LTK_OPERATOR, 1, LOP_AND },
+  { "or",  2, LTK_OPERATOR, 1, LOP_OR },
+
+  // constants
+  { "true",  4, LTK_VAL, 1, 1 },
+  { "false", 5, LTK_VAL, 1, 0 },
+  { "pi",    2, LTK_VAL, 2, 3.14159265358979323846 },
+  { "e",     1, LTK_VAL, 2, 2.71828182845904523536 },
+
+  // conditions
+  { "if",     2, LTK_IF,     0, 0 },
+  { "else",   4, LTK_ELSE,   0, 0 },
+  { "return", 6, LTK_RETURN, 0, 0 },
+
+  // loops
+  { "while",    5, LTK_WHILE,    0, 0 },
+  { "do",       2, LTK_DO,       0, 0 },
+  { "for",      3, LTK_FOR,      0, 0 },
+  { "break",    5, LTK_BREAK,    0, 0 },
+  { "continue", 8, LTK_CONTINUE, 0, 0 },
+
+  // switch-case
+  { "switch",  6, LTK_SWITCH,  0, 0 },
+  { "case",    4, LTK_CASE,    0, 0 },
+  { "default", 7, LTK_DEFAULT, 0, 0 },
+
+  // other
+  { "var",      3, LTK_VAR,    1, 0 },
+  { "const",    5, LTK_VAR,    1, 1 },
+  { "static",   6, LTK_STATIC, 0, 0 },
+  { "function", 8, LTK_FUNC,   0, 0 },
+};
+
+// Keyword slots by the perfect hash (indices in the keyword list or -1)
+static const signed char _aiKeywordSlots[64] = {
+  -1,  0, -1,  1, -1, 14, -1, 20,  4, -1, -1, -1, 21, -1, -1, 18,
+  -1, -1, -1, -1,  3, -1, -1, -1, 16, -1, -1, 11, -1, -1,  6, 13,
+   8, -1, 17, -1, -1, -1, 15, -1, -1, -1, -1,  7, -1, -1,  9, -1,
+  -1, -1, -1, -1, 22,  5, -1, -1, -1,  2, 10, -1, -1, -1, 12, 19,
+};
+
+// Find keyword by its name (collision-free for all keywords)
+static const SLdsKeyword *FindKeyword(const char *strName, const int &ctLen) {
+  int iSlot = (ctLen + strName[0] * 6 + strName[ctLen - 1] * 28) & 63;
+  int iKeyword = _aiKeywordSlots[iSlot];
+
+  if (iKeyword == -1) {
+    return NULL;
+  }
+
+  const SLdsKeyword &kw = _akwKeywords[iKeyword];
+
+  if (kw.ctLen != ctLen || memcmp(kw.strName, strName, ctLen) != 0) {
+    return NULL;
+  }
+
+  return &kw;
+};
+
 // Set custom constants from the map
 void CLdsScriptEngine::SetParserConstants(CLdsMap &mapFrom) {
   // reset the map
@@ -75,22 +150,64 @@ void CLdsScriptEngine::SetParserConstants(CLdsMap &mapFrom) {
   _mapLdsConstants.AddFrom(mapFrom, true);
 };
 
-// Set custom unary operators
-void CLdsScriptEngine::SetUnaryOperators(CLdsFuncPtrMap &mapFrom) {
+// Set custom unary operators (pure ones can be computed during compilation)
+void CLdsScriptEngine::SetUnaryOperators(CLdsFuncPtrMap &mapFrom, bool bPure) {
   // reset the map
   _mapLdsUnaryOps.Clear();
+  _astrPureUnary.Clear();
 
   // readd default operators
   _mapLdsUnaryOps.CopyMap(_mapLdsDefUnary);
+  _astrPureUnary.CopyArray(_astrDefPureUnary);
   
   // add custom operators
-  _mapLdsUnaryOps.AddFrom(mapFrom, true);
+  AddUnaryOperators(mapFrom, bPure);
 };
 
 // Add more operators and replace ones that already exist
-void CLdsScriptEngine::AddUnaryOperators(CLdsFuncPtrMap &mapFrom) {
+void CLdsScriptEngine::AddUnaryOperators(CLdsFuncPtrMap &mapFrom, bool bPure) {
   // add custom operators
   _mapLdsUnaryOps.AddFrom(mapFrom, true);
+
+  // replaced operators take purity of the new ones
+  for (int iOperator = 0; iOperator < mapFrom.Count(); iOperator++) {
+    const string &strOperator = mapFrom.GetKey(iOperator);
+    int iPure = _astrPureUnary.FindIndex(strOperator);
+
+    if (bPure && iPure == -1) {
+      _astrPureUnary.Add(strOperator);
+
+    } else if (!bPure && iPure != -1) {
+      _astrPureUnary.Delete(iPure);
+    }
+  }
+};
+
+// Check if the unary operator always gives the same result for the same value and has no side effects
+bool CLdsScriptEngine::PureUnaryOperator(const string &strOperator) {
+  // built-in operators only work with the value
+  if (_mapLdsUnaryOps.FindKeyIndex(strOperator) == -1) {
+    return true;
+  }
+
+  return (_astrPureUnary.FindIndex(strOperator) != -1);
+};
+
+// Check if the function call can be computed during compilation
+bool CLdsScriptEngine::PureFunction(const string &strFunc) {
+  // inline functions take priority over the native ones
+  if (_mapInlineFunc.FindKeyIndex(strFunc) != -1) {
+    return false;
+  }
+
+  int iFunc = _mapLdsFunctions.FindKeyIndex(strFunc);
+
+  if (iFunc == -1) {
+    return false;
+  }
+
+  const SLdsFunc &func = _mapLdsFunctions.GetValue(iFunc);
+  return (func.ef_bPure && func.ef_pFunc != NULL);
 };
 
 // Clamp the value
@@ -99,11 +216,12 @@ static inline int Clamp(const int &iNum, const int &iDown, const int &iUp) {
 };
 
 // Parse the script
-void CLdsScriptEngine::ParseScript(string strScript) {
+void CLdsScriptEngine::ParseScript(const string &strScript) {
   _aetTokens.Clear();
-  string str = strScript;
 
-  _ctLen = str.length();
+  // parse the source directly
+  const char *str = strScript.c_str();
+  _ctLen = strScript.length();
   
   _iLine = 1;
   _iLineStart = 0;
@@ -353,21 +471,21 @@ void CLdsScriptEngine::ParseScript(string strScript) {
 
         // didn't parse past the limit
         if (_iPos < _ctLen) {
-          string strString = str.substr(iStart + 1, _iPos - iStart - 1);
+          // parse escape characters straight from the source
+          string strEscape;
+          strEscape.reserve(_iPos - iStart - 1);
 
-          // parse escape characters
-          std::ostringstream strmEscape;
           bEscapeChar = false;
 
-          for (string::size_type iChar = 0; iChar < strString.length(); iChar++) {
+          for (int iChar = iStart + 1; iChar < _iPos; iChar++) {
             // current character
-            cString = strString[iChar];
+            cString = str[iChar];
 
             switch (cString) {
               case ESCAPE_CHAR: {
                 // has been marked as escape char already, just print it out
                 if (bEscapeChar) {
-                  strmEscape << ESCAPE_CHAR;
+                  strEscape += ESCAPE_CHAR;
                 }
 
                 bEscapeChar = !bEscapeChar;
@@ -377,13 +495,13 @@ void CLdsScriptEngine::ParseScript(string strScript) {
                 // check other symbols
                 if (bEscapeChar) {
                   switch (cString) {
-                    case 'n': strmEscape << '\n'; break;
-                    case 'r': strmEscape << '\r'; break;
-                    case 't': strmEscape << '\t'; break;
-                    case '"': strmEscape << '"'; break;
+                    case 'n': strEscape += '\n'; break;
+                    case 'r': strEscape += '\r'; break;
+                    case 't': strEscape += '\t'; break;
+                    case '"': strEscape += '"'; break;
                   
                     // write backslash
-                    default: strmEscape << ESCAPE_CHAR;
+                    default: strEscape += ESCAPE_CHAR;
                   }
 
                   bEscapeChar = false;
@@ -391,12 +509,12 @@ void CLdsScriptEngine::ParseScript(string strScript) {
                 }
 
                 // regular characters
-                strmEscape << cString;
+                strEscape += cString;
               } break;
             }
           }
 
-          AddParserToken(LTK_VAL, iPrintPos, strmEscape.str());
+          AddParserToken(LTK_VAL, iPrintPos, strEscape);
           _iPos++;
 
         } else {
@@ -463,7 +581,7 @@ void CLdsScriptEngine::ParseScript(string strScript) {
           }
           
           // save the number
-          string strString = str.substr(iStart, _iPos - iStart);
+          string strString(str + iStart, _iPos - iStart);
           
           switch (ubType) {
             case 0: { // index
@@ -504,94 +622,35 @@ void CLdsScriptEngine::ParseScript(string strScript) {
             }
           }
           
-          // copy the name
-          string strName = str.substr(iStart, _iPos - iStart);
-          
-          // operators
-          if (strName == "mod") {
-            AddParserToken(LTK_OPERATOR, iPrintPos, LOP_FMOD);
-
-          } else if (strName == "div") {
-            AddParserToken(LTK_OPERATOR, iPrintPos, LOP_IDIV);
-
-          } else if (strName == "and") {
-            AddParserToken(LTK_OPERATOR, iPrintPos, LOP_AND);
-
-          } else if (strName == "or") {
-            AddParserToken(LTK_OPERATOR, iPrintPos, LOP_OR);
-
-          // constants
-          } else if (strName == "true") {
-            AddParserToken(LTK_VAL, iPrintPos, true);
-            
-          } else if (strName == "false") {
-            AddParserToken(LTK_VAL, iPrintPos, false);
-
-          } else if (strName == "pi") {
-            AddParserToken(LTK_VAL, iPrintPos, 3.14159265358979323846);
-
-          } else if (strName == "e") {
-            AddParserToken(LTK_VAL, iPrintPos, 2.71828182845904523536);
-
-          // conditions
-          } else if (strName == "if") {
-            AddParserToken(LTK_IF, iPrintPos);
-
-          } else if (strName == "else") {
-            AddParserToken(LTK_ELSE, iPrintPos);
-
-          } else if (strName == "return") {
-            AddParserToken(LTK_RETURN, iPrintPos);
-          
-          // loops
-          } else if (strName == "while") {
-            AddParserToken(LTK_WHILE, iPrintPos);
-
-          } else if (strName == "do") {
-            AddParserToken(LTK_DO, iPrintPos);
+          const int ctName = _iPos - iStart;
 
-          } else if (strName == "for") {
-            AddParserToken(LTK_FOR, iPrintPos);
-
-          } else if (strName == "break") {
-            AddParserToken(LTK_BREAK, iPrintPos);
-
-          } else if (strName == "continue") {
-            AddParserToken(LTK_CONTINUE, iPrintPos);
-          
-          // switch-case
-          } else if (strName == "switch") {
-            AddParserToken(LTK_SWITCH, iPrintPos);
+          // keywords
+          const SLdsKeyword *pkw = FindKeyword(str + iStart, ctName);
 
-          } else if (strName == "case") {
-            AddParserToken(LTK_CASE, iPrintPos);
+          if (pkw != NULL) {
+            switch (pkw->ubValue) {
+              case 0: AddParserToken(pkw->eToken, iPrintPos); break;
+              case 1: AddParserToken(pkw->eToken, iPrintPos, (int)pkw->dValue); break;
+              default: AddParserToken(pkw->eToken, iPrintPos, pkw->dValue); break;
+            }
+            break;
+          }
 
-          } else if (strName == "default") {
-            AddParserToken(LTK_DEFAULT, iPrintPos);
-            
-          // other
-          } else if (strName == "var") {
-            AddParserToken(LTK_VAR, iPrintPos, false);
-            
-          } else if (strName == "const") {
-            AddParserToken(LTK_VAR, iPrintPos, true);
-            
-          } else if (strName == "static") {
-            AddParserToken(LTK_STATIC, iPrintPos);
-            
-          } else if (strName == "function") {
-            AddParserToken(LTK_FUNC, iPrintPos);
+          // unique name
+          int iSymbol = _stSymbols.Intern(str + iStart, ctName);
+          const string &strName = _stSymbols.Name(iSymbol);
 
           // custom constants
-          } else if (_mapLdsConstants.FindKeyIndex(strName) != -1) {
+          if (_mapLdsConstants.FindKeyIndex(strName) != -1) {
             AddParserToken(LTK_VAL, iPrintPos, _mapLdsConstants[strName]);
 
           // custom unary operators
           } else if (_mapLdsUnaryOps.FindKeyIndex(strName) != -1) {
             AddParserToken(LTK_UNARYOP, iPrintPos, strName);
 
+          // identifiers with their symbol IDs
           } else {
-            AddParserToken(LTK_ID, iPrintPos, strName);
+            AddParserToken(LTK_ID, iPrintPos, strName, iSymbol);
           }
         
         // unknown characters
@@ -610,6 +669,6 @@ void CLdsScriptEngine::AddParserToken(const ELdsToken &eType, const int &iPos) {
   _aetTokens.Add() = CLdsToken(eType, iPos, -1);
 };
 
-void CLdsScriptEngine::AddParserToken(const ELdsToken &eType, const int &iPos, const CLdsValue &valValue) {
-  _aetTokens.Add() = CLdsToken(eType, iPos, valValue, -1);
+void CLdsScriptEngine::AddParserToken(const ELdsToken &eType, const int &iPos, const CLdsValue &valValue, const int &iArg) {
+  _aetTokens.Add() = CLdsToken(eType, iPos, valValue, iArg);
 };
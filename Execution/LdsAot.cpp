@@ -0,0 +1,631 @@
+/* Copyright (c) 2021 Dreamy Cecil
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#include "StdH.h"
+#include "LdsAot.h"
+#include "LdsExecution.h"
+
+extern CLdsScriptEngine *_pldsCurrent;
+extern DSStack<CLdsValueRef> *_pavalStack;
+extern CLdsProgram *_ppgCurrent;
+extern CLdsThread *_psthCurrent;
+
+extern CCompAction &SetCurrentAction(CCompAction *pcaCurrent);
+
+// Transpiled scripts that have been linked into the program
+extern CLdsAotScript *LDS_pAotScripts = NULL;
+
+// Gather programs of the main body and each inline function in the same order for transpiling and loading
+static void GatherAotBodies(CLdsProgram &pg, DSList<CLdsProgram> &apgBodies, DSList<string> *pastrNames, const string &strName) {
+  apgBodies.Add() = pg;
+
+  if (pastrNames != NULL) {
+    pastrNames->Add() = strName;
+  }
+
+  CActionList &aca = pg.Actions();
+
+  for (int iAction = 0; iAction < aca.Count(); iAction++) {
+    CCompAction &ca = aca[iAction];
+
+    if (ca.lt_eType == LCA_FUNC) {
+      GatherAotBodies(ca.ca_inFunc.in_pgFunc, apgBodies, pastrNames, ca->GetString());
+    }
+  }
+};
+
+// Constructor
+CLdsAotScript::CLdsAotScript(const char *strName, const char *const *astrArgs, const int &ctArgs,
+                             const unsigned char *pImage, const int &iImageSize,
+                             const CLdsAotBody *apBodies, const int &ctBodies, LdsFuncPtr pFunc) :
+  as_strName(strName), as_astrArgs(astrArgs), as_ctArgs(ctArgs),
+  as_pImage(pImage), as_iImageSize(iImageSize),
+  as_apBodies(apBodies), as_ctBodies(ctBodies), as_pFunc(pFunc)
+{
+  // add to the list
+  as_pNext = LDS_pAotScripts;
+  LDS_pAotScripts = this;
+};
+
+// Load the program from the image
+void CLdsAotScript::Load(CLdsScriptEngine &lds) {
+  // already loaded
+  if (as_apgBodies.Count() > 0) {
+    return;
+  }
+
+  CLdsProgramImage piImage;
+  piImage.FromMemory(as_pImage, as_iImageSize);
+
+  lds.LdsLoadImage(piImage, as_pgProgram);
+
+  DSList<CLdsProgram> apgBodies;
+  GatherAotBodies(as_pgProgram, apgBodies, NULL, "");
+
+  // image has been changed after transpiling
+  if (apgBodies.Count() != as_ctBodies) {
+    as_pgProgram.Clear();
+    LdsThrow(LER_READ, "Transpiled script '%s' has %d functions instead of %d", as_strName, apgBodies.Count(), as_ctBodies);
+  }
+
+  as_apgBodies.CopyArray(apgBodies);
+};
+
+// Find body of some program
+int CLdsAotScript::FindBody(const CLdsProgram &pg) {
+  for (int iBody = 0; iBody < as_apgBodies.Count(); iBody++) {
+    if (as_apgBodies[iBody].SharesWith(pg)) {
+      return iBody;
+    }
+  }
+
+  return -1;
+};
+
+// Run the script for the current thread
+LdsReturn CLdsAotScript::Run(CLdsValue *avalArgs) {
+  // needs an engine to run in
+  if (_pldsCurrent == NULL) {
+    LdsThrow(LEX_THREAD, "Transpiled script '%s' can only be called from another script", as_strName);
+  }
+
+  Load(*_pldsCurrent);
+
+  CLdsAotRun arRun(*this, *_pldsCurrent, avalArgs);
+  arRun.RunBody(0);
+
+  return arRun.Result();
+};
+
+// Constructor
+CLdsAotRun::CLdsAotRun(CLdsAotScript &as, CLdsScriptEngine &lds, CLdsValue *avalArgs) :
+  ar_as(as), ar_sth(as.as_pgProgram, &lds)
+{
+  // arguments become locals like in a quick run
+  for (int iArg = 0; iArg < as.as_ctArgs; iArg++) {
+    ar_sth.sth_aLocals.Add() = SLdsVar(as.as_astrArgs[iArg], avalArgs[iArg]);
+  }
+
+  // can't be paused from the native code
+  ar_sth.SetFlag(CLdsThread::THF_QUICK, true);
+  ar_sth.sth_eStatus = ETS_RUNNING;
+
+  // remember previous state
+  ar_ppgPrev = _ppgCurrent;
+  ar_pldsPrev = _pldsCurrent;
+  ar_psthPrev = _psthCurrent;
+  ar_pavalPrev = _pavalStack;
+  ar_iActionPosPrev = LDS_iActionPos;
+
+  _ppgCurrent = &ar_sth.sth_pgProgram;
+  _pldsCurrent = &lds;
+  _psthCurrent = &ar_sth;
+  _pavalStack = &ar_sth.sth_avalStack;
+};
+
+// Destructor
+CLdsAotRun::~CLdsAotRun(void) {
+  // restore previous state
+  _ppgCurrent = ar_ppgPrev;
+  _pldsCurrent = ar_pldsPrev;
+  _psthCurrent = ar_psthPrev;
+  _pavalStack = ar_pavalPrev;
+  LDS_iActionPos = ar_iActionPosPrev;
+};
+
+// Set action that is being executed
+static inline void SetAotAction(CCompAction &ca) {
+  SetCurrentAction(&ca);
+  LDS_iActionPos = ca.lt_iPos;
+};
+
+// Run body and other bodies that replace it through tail calls
+void CLdsAotRun::RunBody(int iBody) {
+  while (iBody != -1) {
+    iBody = ar_as.as_apBodies[iBody](*this);
+  }
+};
+
+// Get the result after running the main body
+CLdsValue CLdsAotRun::Result(void) {
+  return ar_sth.GetResult().vr_val;
+};
+
+// Actions that work the same way as in CLdsThread::Resume()
+void CLdsAotRun::Val(CCompAction &ca) {
+  SetAotAction(ca);
+  Exec_Val();
+};
+
+void CLdsAotRun::Unary(CCompAction &ca) {
+  SetAotAction(ca);
+  Exec_Unary();
+};
+
+void CLdsAotRun::Binary(CCompAction &ca) {
+  SetAotAction(ca);
+  Exec_Binary();
+};
+
+void CLdsAotRun::BinaryNum(CCompAction &ca) {
+  SetAotAction(ca);
+  Exec_BinaryNum();
+};
+
+void CLdsAotRun::Get(CCompAction &ca) {
+  SetAotAction(ca);
+  Exec_Get();
+};
+
+void CLdsAotRun::GetLocal(CCompAction &ca) {
+  SetAotAction(ca);
+  Exec_GetLocal();
+};
+
+void CLdsAotRun::Set(CCompAction &ca) {
+  SetAotAction(ca);
+  Exec_Set();
+};
+
+void CLdsAotRun::SetLocal(CCompAction &ca) {
+  SetAotAction(ca);
+  Exec_SetLocal();
+};
+
+void CLdsAotRun::SetAccessor(CCompAction &ca) {
+  SetAotAction(ca);
+  Exec_SetAccessor();
+};
+
+void CLdsAotRun::Call(CCompAction &ca) {
+  SetAotAction(ca);
+  Exec_Call();
+
+  // thread got paused or destroyed
+  if (ar_sth.sth_eStatus != ETS_RUNNING) {
+    LdsThrow(LEX_THREAD, "The thread got destroyed at %s", ca.PrintPos().c_str());
+  }
+};
+
+// Find body of the inline function that has just been called
+static int InlineBody(CLdsAotRun &ar, CCompAction &ca) {
+  int iBody = ar.ar_as.FindBody(ar.ar_sth.sth_pgProgram);
+
+  // defined outside of the transpiled script
+  if (iBody == -1) {
+    LdsThrow(LEX_ACTION, "Inline function '%s' hasn't been transpiled at %s", ca->GetString().c_str(), ca.PrintPos().c_str());
+  }
+
+  return iBody;
+};
+
+void CLdsAotRun::Inline(CCompAction &ca) {
+  SetAotAction(ca);
+
+  // make a list of arguments
+  CLdsArray aArgs = MakeValueList(*_pavalStack, ca.lt_iArg);
+  ar_sth.CallInlineFunction(ca->GetString(), aArgs);
+
+  RunBody(InlineBody(*this, ca));
+
+  // return from the inline function
+  CLdsValueRef valRefResult = ar_sth.GetResult();
+  ar_sth.ReturnFromInline();
+
+  _pavalStack->Push() = valRefResult;
+};
+
+int CLdsAotRun::TailCall(CCompAction &ca) {
+  // nothing to replace
+  if (ar_sth.sth_aicCalls.Count() <= 0) {
+    Inline(ca);
+    return -1;
+  }
+
+  SetAotAction(ca);
+
+  // make a list of arguments
+  CLdsArray aArgs = MakeValueList(*_pavalStack, ca.lt_iArg);
+  ar_sth.TailCallInlineFunction(ca->GetString(), aArgs);
+
+  return InlineBody(*this, ca);
+};
+
+void CLdsAotRun::Func(CCompAction &ca) {
+  ar_sth.sth_mapInlineFunc.Add(ca->GetString()) = ca.ca_inFunc;
+};
+
+void CLdsAotRun::Var(CCompAction &ca) {
+  SetAotAction(ca);
+  ar_sth.DefineVar(ca->GetString(), (ca.lt_iArg >= 1));
+};
+
+void CLdsAotRun::Dir(CCompAction &ca) {
+  switch (ca.lt_iArg) {
+    // debug context level (only affects the interpreter)
+    case THD_DEBUGCONTEXT:
+      ar_sth.SetFlag(CLdsThread::THF_DEBUG, ca.lt_valValue->IsTrue());
+      break;
+  }
+};
+
+void CLdsAotRun::Discard(void) {
+  _pavalStack->Pop();
+};
+
+void CLdsAotRun::Dup(void) {
+  // get the reference first in case Push() is done before Top()
+  CLdsValueRef &valTop = _pavalStack->Top();
+  _pavalStack->Push() = valTop;
+};
+
+// Take value for a condition
+bool CLdsAotRun::Condition(CCompAction &) {
+  CLdsValue val = _pavalStack->Pop().vr_val;
+  return val->IsTrue();
+};
+
+// Logical operators
+bool CLdsAotRun::And(CCompAction &) {
+  CLdsValue val = _pavalStack->Top().vr_val;
+
+  if (val->IsTrue()) {
+    _pavalStack->Pop();
+    return false;
+  }
+
+  return true;
+};
+
+bool CLdsAotRun::Or(CCompAction &) {
+  CLdsValue val = _pavalStack->Top().vr_val;
+
+  if (val->IsTrue()) {
+    return true;
+  }
+
+  _pavalStack->Pop();
+  return false;
+};
+
+// Switch case
+bool CLdsAotRun::Switch(CCompAction &) {
+  CLdsValue valCase = _pavalStack->Pop().vr_val;
+  CLdsValue valDesired = _pavalStack->Top().vr_val;
+
+  if (valCase == valDesired) {
+    _pavalStack->Pop();
+    return true;
+  }
+
+  return false;
+};
+
+// Switch jump table
+int CLdsAotRun::SwitchTable(CActionList &aca, const int &iTable) {
+  SetAotAction(aca[iTable]);
+  return Exec_SwitchTable(aca, iTable);
+};
+
+// Add all transpiled scripts as custom functions of the engine
+void LdsAddAotFunctions(CLdsScriptEngine &lds) {
+  CLdsFuncMap mapFunc;
+
+  for (CLdsAotScript *pas = LDS_pAotScripts; pas != NULL; pas = pas->as_pNext) {
+    try {
+      pas->Load(lds);
+
+    } catch (SLdsError leError) {
+      lds.LdsErrorOut("%s (code: 0x%X)\n", leError.le_strMessage.c_str(), leError.le_eError);
+      continue;
+    }
+
+    mapFunc.Add(pas->as_strName) = SLdsFunc(pas->as_ctArgs, (void *)pas->as_pFunc);
+  }
+
+  lds.AddCustomFunctions(mapFunc);
+};
+
+// Check if the name can be used as a C++ identifier
+static bool AotIdentifier(const string &strName) {
+  if (strName.size() <= 0) {
+    return false;
+  }
+
+  for (size_t iChar = 0; iChar < strName.size(); iChar++) {
+    char ch = strName[iChar];
+
+    bool bLetter = ((ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z') || ch == '_');
+    bool bDigit = (ch >= '0' && ch <= '9');
+
+    if (!bLetter && !(bDigit && iChar > 0)) {
+      return false;
+    }
+  }
+
+  return true;
+};
+
+// Transpile one action into a C++ statement
+static string TranspileAction(CActionList &aca, const int &iAction, const string &strBody) {
+  CCompAction &ca = aca[iAction];
+  const int iArg = ca.lt_iArg;
+
+  switch (ca.lt_eType) {
+    case LCA_VAL: return LdsPrintF("run.Val(aca[%d]);", iAction);
+    case LCA_UN: return LdsPrintF("run.Unary(aca[%d]);", iAction);
+    case LCA_BIN: return LdsPrintF("run.Binary(aca[%d]);", iAction);
+    case LCA_BIN_NUM: return LdsPrintF("run.BinaryNum(aca[%d]);", iAction);
+
+    case LCA_GET: return LdsPrintF(iArg ? "run.GetLocal(aca[%d]);" : "run.Get(aca[%d]);", iAction);
+    case LCA_SET: return LdsPrintF(iArg ? "run.SetLocal(aca[%d]);" : "run.Set(aca[%d]);", iAction);
+    case LCA_SET_ACCESS: return LdsPrintF("run.SetAccessor(aca[%d]);", iAction);
+
+    case LCA_CALL: return LdsPrintF("run.Call(aca[%d]);", iAction);
+    case LCA_INLINE: return LdsPrintF("run.Inline(aca[%d]);", iAction);
+    case LCA_TAILCALL: return LdsPrintF("iTail = run.TailCall(aca[%d]); if (iTail != -1) return iTail;", iAction);
+    case LCA_FUNC: return LdsPrintF("run.Func(aca[%d]);", iAction);
+    case LCA_VAR: return LdsPrintF("run.Var(aca[%d]);", iAction);
+    case LCA_DIR: return LdsPrintF("run.Dir(aca[%d]);", iAction);
+
+    case LCA_JUMP: return LdsPrintF("goto lds_%d;", iArg);
+    case LCA_JUMPIF: return LdsPrintF("if (run.Condition(aca[%d])) goto lds_%d;", iAction, iArg);
+    case LCA_JUMPUNLESS: return LdsPrintF("if (!run.Condition(aca[%d])) goto lds_%d;", iAction, iArg);
+    case LCA_AND: return LdsPrintF("if (run.And(aca[%d])) goto lds_%d;", iAction, iArg);
+    case LCA_OR: return LdsPrintF("if (run.Or(aca[%d])) goto lds_%d;", iAction, iArg);
+    case LCA_SWITCH: return LdsPrintF("if (run.Switch(aca[%d])) goto lds_%d;", iAction, iArg);
+
+    // jump to any position the table can return
+    case LCA_SWITCH_TABLE: {
+      DSList<int> aiJumps;
+      aiJumps.Add() = iAction + 1 + iArg * 2;
+
+      for (int iCase = 0; iCase < iArg; iCase++) {
+        const int iJump = aca[iAction + 2 + iCase * 2].lt_iArg;
+
+        if (aiJumps.FindIndex(iJump) == -1) {
+          aiJumps.Add() = iJump;
+        }
+      }
+
+      string strSwitch = LdsPrintF("switch (run.SwitchTable(aca, %d)) {\n", iAction);
+
+      for (int iJump = 0; iJump < aiJumps.Count(); iJump++) {
+        // next action is reached without jumping
+        if (aiJumps[iJump] != iAction + 1) {
+          strSwitch += LdsPrintF("    case %d: goto lds_%d;\n", aiJumps[iJump], aiJumps[iJump]);
+        }
+      }
+
+      return strSwitch + "  }";
+    }
+
+    case LCA_RETURN: return "return -1;";
+    case LCA_DISCARD: return "run.Discard();";
+    case LCA_DUP: return "run.Dup();";
+  }
+
+  LdsThrow(LER_WRITE, "Cannot transpile action %s in '%s' at %s", _astrActionNames[ca.lt_eType], strBody.c_str(), ca.PrintPos().c_str());
+  return "";
+};
+
+// Transpile program of one body into a C++ function
+static string TranspileBody(CLdsProgram &pg, const string &strFunc, const int &iBody, const string &strBody) {
+  CActionList &aca = pg.Actions();
+  const int ctActions = aca.Count();
+
+  // find positions that are jumped to
+  DSArray<int> abJumpTo;
+  abJumpTo.New(ctActions + 1);
+
+  bool bTailCalls = false;
+  int iAction;
+
+  for (iAction = 0; iAction <= ctActions; iAction++) {
+    abJumpTo[iAction] = false;
+  }
+
+  for (iAction = 0; iAction < ctActions; iAction++) {
+    CCompAction &ca = aca[iAction];
+
+    switch (ca.lt_eType) {
+      case LCA_JUMP: case LCA_JUMPIF: case LCA_JUMPUNLESS:
+      case LCA_AND: case LCA_OR: case LCA_SWITCH:
+        abJumpTo[ca.lt_iArg] = true;
+        break;
+
+      // cases after the table mark their own positions
+      case LCA_SWITCH_TABLE:
+        abJumpTo[iAction + 1 + ca.lt_iArg * 2] = true;
+        break;
+
+      case LCA_TAILCALL:
+        bTailCalls = true;
+        break;
+    }
+  }
+
+  string strSource = LdsPrintF("// %s\n", strBody.c_str());
+  strSource += LdsPrintF("static int LdsAot_%s_%d(CLdsAotRun &run) {\n", strFunc.c_str(), iBody);
+
+  if (ctActions > 0) {
+    strSource += LdsPrintF("  CActionList &aca = run.Actions(%d);\n", iBody);
+  }
+
+  if (bTailCalls) {
+    strSource += "  int iTail;\n";
+  }
+
+  strSource += "\n";
+
+  for (iAction = 0; iAction < ctActions; iAction++) {
+    if (abJumpTo[iAction]) {
+      strSource += LdsPrintF("lds_%d:\n", iAction);
+    }
+
+    strSource += "  " + TranspileAction(aca, iAction, strBody) + "\n";
+  }
+
+  // end of the body
+  if (abJumpTo[ctActions]) {
+    strSource += LdsPrintF("lds_%d:\n", ctActions);
+
+  // last action leaves the body by itself
+  } else if (ctActions > 0 && (aca[ctActions - 1].lt_eType == LCA_RETURN || aca[ctActions - 1].lt_eType == LCA_JUMP)) {
+    return strSource + "};\n\n";
+  }
+
+  strSource += "  return -1;\n};\n\n";
+  return strSource;
+};
+
+// Transpile compiled program into C++ source of a script function
+void CLdsScriptEngine::LdsTranspileProgram(CLdsProgram &pgProgram, const string &strFunc, const CLdsInlineArgs &astrArgs, string &strSource) {
+  if (!AotIdentifier(strFunc)) {
+    LdsThrow(LER_WRITE, "Cannot transpile script into a function with invalid name '%s'", strFunc.c_str());
+  }
+
+  int iArg;
+
+  for (iArg = 0; iArg < astrArgs.Count(); iArg++) {
+    if (!AotIdentifier(astrArgs[iArg])) {
+      LdsThrow(LER_WRITE, "Cannot transpile script with invalid argument name '%s'", astrArgs[iArg].c_str());
+    }
+  }
+
+  // write the image into a buffer
+  CLdsBufferStream bsImage;
+  CLdsWriteFunc pWritePrev = _pLdsWrite;
+  _pLdsWrite = LdsBufferWrite;
+
+  try {
+    LdsWriteImage(&bsImage, pgProgram);
+
+  } catch (SLdsError) {
+    _pLdsWrite = pWritePrev;
+    throw;
+  }
+
+  _pLdsWrite = pWritePrev;
+
+  // transpile exactly the same actions that will be loaded from the image
+  CLdsProgramImage piImage;
+  piImage.FromMemory(bsImage.bs_pData, (int)bsImage.bs_ctSize);
+
+  CLdsProgram pgImage;
+  LdsLoadImage(piImage, pgImage);
+
+  DSList<CLdsProgram> apgBodies;
+  DSList<string> astrNames;
+  GatherAotBodies(pgImage, apgBodies, &astrNames, "");
+
+  const char *strName = strFunc.c_str();
+  const int ctBodies = apgBodies.Count();
+  int iBody;
+
+  strSource = LdsPrintF("// Script function '%s' transpiled from a compiled program (transpile the script again instead of editing)\n\n", strName);
+  strSource += "#include \"LilacDragonScript.h\"\n\n";
+
+  // image data
+  strSource += "// Program image with all the actions\n";
+  strSource += "static const unsigned char _aubImage[] = {";
+
+  for (LdsSize iByte = 0; iByte < bsImage.bs_ctSize; iByte++) {
+    strSource += (iByte % 16 == 0 ? "\n  " : " ");
+    strSource += LdsPrintF("0x%02X,", (unsigned char)bsImage.bs_pData[iByte]);
+  }
+
+  strSource += "\n};\n\n";
+
+  // argument names
+  strSource += "// Argument names\n";
+  strSource += "static const char *const _astrArgs[] = {";
+
+  for (iArg = 0; iArg < astrArgs.Count(); iArg++) {
+    strSource += LdsPrintF(" \"%s\",", astrArgs[iArg].c_str());
+  }
+
+  strSource += (astrArgs.Count() > 0 ? " };\n\n" : " NULL };\n\n");
+
+  // bodies
+  for (iBody = 0; iBody < ctBodies; iBody++) {
+    string strBody = (iBody == 0 ? "Main program" : "Inline function '" + astrNames[iBody] + "'");
+    strSource += TranspileBody(apgBodies[iBody], strFunc, iBody, strBody);
+  }
+
+  strSource += "// Bodies of the main program and each inline function\n";
+  strSource += "static const CLdsAotBody _apBodies[] = {\n";
+
+  for (iBody = 0; iBody < ctBodies; iBody++) {
+    strSource += LdsPrintF("  &LdsAot_%s_%d,\n", strName, iBody);
+  }
+
+  strSource += "};\n\n";
+
+  // script function
+  strSource += LdsPrintF("static LDS_FUNC(LdsAot_%s);\n\n", strName);
+
+  strSource += "// Transpiled script (added to the list on startup)\n";
+  strSource += LdsPrintF("static CLdsAotScript _asScript(\"%s\", _astrArgs, %d, _aubImage, sizeof(_aubImage), _apBodies, %d, &LdsAot_%s);\n\n",
+                         strName, astrArgs.Count(), ctBodies, strName);
+
+  strSource += "// Script function\n";
+  strSource += LdsPrintF("static LDS_FUNC(LdsAot_%s) {\n  return _asScript.Run(_LDS_FuncArgs);\n};\n", strName);
+};
+
+// Compile the script and transpile it into C++ source of a script function
+ELdsError CLdsScriptEngine::LdsTranspileScript(const string &strScript, const string &strFunc, const CLdsInlineArgs &astrArgs, string &strSource) {
+  CLdsProgram pgProgram;
+  ELdsError eResult = LdsCompileScript(strScript, pgProgram);
+
+  if (eResult != LER_OK) {
+    return eResult;
+  }
+
+  try {
+    LdsTranspileProgram(pgProgram, strFunc, astrArgs, strSource);
+
+  } catch (SLdsError leError) {
+    LdsErrorOut("%s (code: 0x%X)\n", leError.le_strMessage.c_str(), leError.le_eError);
+    return leError.le_eError;
+  }
+
+  return LER_OK;
+};
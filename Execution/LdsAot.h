@@ -0,0 +1,139 @@
+/* Copyright (c) 2021 Dreamy Cecil
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#pragma once
+
+#include "LdsThread.h"
+
+class CLdsAotRun;
+
+// Native body of a transpiled program (returns body that replaces it through a tail call or -1)
+typedef int (*CLdsAotBody)(CLdsAotRun &run);
+
+// Script transpiled into C++ that can be used as a script function
+class LDS_API CLdsAotScript {
+  public:
+    const char *as_strName; // function name
+    const char *const *as_astrArgs; // argument names
+    int as_ctArgs; // amount of arguments
+
+    const unsigned char *as_pImage; // program image with all the actions
+    int as_iImageSize; // image size in bytes
+
+    const CLdsAotBody *as_apBodies; // bodies of the main program and each inline function
+    int as_ctBodies; // amount of bodies
+
+    LdsFuncPtr as_pFunc; // script function that runs the script
+    CLdsAotScript *as_pNext; // next transpiled script in the list
+
+    CLdsProgram as_pgProgram; // program loaded from the image
+    DSList<CLdsProgram> as_apgBodies; // programs of each body
+
+  public:
+    // Constructor (adds the script to the list of transpiled scripts)
+    CLdsAotScript(const char *strName, const char *const *astrArgs, const int &ctArgs,
+                  const unsigned char *pImage, const int &iImageSize,
+                  const CLdsAotBody *apBodies, const int &ctBodies, LdsFuncPtr pFunc);
+
+    // Assignment (illegal)
+    CLdsAotScript &operator=(const CLdsAotScript &asOther);
+
+    // Load the program from the image (throws LER_READ if it doesn't match the bodies)
+    void Load(CLdsScriptEngine &lds);
+
+    // Find body of some program (-1 if none)
+    int FindBody(const CLdsProgram &pg);
+
+    // Run the script for the current thread
+    LdsReturn Run(CLdsValue *avalArgs);
+};
+
+// State of a running transpiled script
+class LDS_API CLdsAotRun {
+  public:
+    CLdsAotScript &ar_as; // script that's running
+    CLdsThread ar_sth; // thread with locals, inline calls and values
+
+  private:
+    // Previous execution state
+    CLdsProgram *ar_ppgPrev;
+    CLdsScriptEngine *ar_pldsPrev;
+    CLdsThread *ar_psthPrev;
+    DSStack<CLdsValueRef> *ar_pavalPrev;
+    int ar_iActionPosPrev;
+
+  public:
+    // Constructor
+    CLdsAotRun(CLdsAotScript &as, CLdsScriptEngine &lds, CLdsValue *avalArgs);
+
+    // Destructor
+    ~CLdsAotRun(void);
+
+    // Assignment (illegal)
+    CLdsAotRun &operator=(const CLdsAotRun &arOther);
+
+    // Actions of some body
+    inline CActionList &Actions(const int &iBody) {
+      return ar_as.as_apgBodies[iBody].Actions();
+    };
+
+    // Run body and other bodies that replace it through tail calls
+    void RunBody(int iBody);
+
+    // Get the result after running the main body
+    CLdsValue Result(void);
+
+    // Actions that work the same way as in CLdsThread::Resume()
+    void Val(CCompAction &ca);
+    void Unary(CCompAction &ca);
+    void Binary(CCompAction &ca);
+    void BinaryNum(CCompAction &ca);
+    void Get(CCompAction &ca);
+    void GetLocal(CCompAction &ca);
+    void Set(CCompAction &ca);
+    void SetLocal(CCompAction &ca);
+    void SetAccessor(CCompAction &ca);
+    void Call(CCompAction &ca);
+    void Inline(CCompAction &ca);
+    void Func(CCompAction &ca);
+    void Var(CCompAction &ca);
+    void Dir(CCompAction &ca);
+    void Discard(void);
+    void Dup(void);
+
+    // Inline call that replaces the current one (returns body to run in place of the current one or -1)
+    int TailCall(CCompAction &ca);
+
+    // Take value for a condition
+    bool Condition(CCompAction &ca);
+    // Logical operators (return true if the jump needs to be made)
+    bool And(CCompAction &ca);
+    bool Or(CCompAction &ca);
+    // Switch case (returns true if the case matches)
+    bool Switch(CCompAction &ca);
+    // Switch jump table (returns position of the next action)
+    int SwitchTable(CActionList &aca, const int &iTable);
+};
+
+// Transpiled scripts that have been linked into the program
+LDS_API extern CLdsAotScript *LDS_pAotScripts;
+
+// Add all transpiled scripts as custom functions of the engine
+LDS_API void LdsAddAotFunctions(CLdsScriptEngine &lds);
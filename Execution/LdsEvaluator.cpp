@@ -29,7 +29,7 @@ extern CCompAction &SetCurrentAction(CCompAction *pcaCurrent);
 
 // Execute the compiled expression
 CLdsValue CLdsScriptEngine::LdsExecute(CLdsProgram &pgProgram) {
-  CActionList &acaActions = pgProgram.acaProgram;
+  CActionList &acaActions = pgProgram.Actions();
 
   int iPos = 0;
   int ctActions = acaActions.Count();
@@ -59,6 +59,7 @@ CLdsValue CLdsScriptEngine::LdsExecute(CLdsProgram &pgProgram) {
       case LCA_VAL: Exec_Val(); break;
       case LCA_UN: Exec_Unary(); break;
       case LCA_BIN: Exec_Binary(); break;
+      case LCA_BIN_NUM: Exec_BinaryNum(); break;
       case LCA_GET: Exec_Get(); break;
       case LCA_CALL: Exec_Call(); break;
 
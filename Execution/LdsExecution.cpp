@@ -144,6 +144,145 @@ void Exec_Binary(void) {
   _pavalStack->Push() = valRef1.vr_val->BinaryOp(valRef1, valRef2, *_ca);
 };
 
+// Integer operation that gives the same result as CLdsIntType::BinaryOp (returns false if it can't be performed)
+static inline bool IntOperation(const int &iOperation, const int &iNum1, const int &iNum2, int &iResult) {
+  switch (iOperation) {
+    case LOP_ADD: iResult = (iNum1 + iNum2); return true;
+    case LOP_SUB: iResult = (iNum1 - iNum2); return true;
+    case LOP_MUL: iResult = (iNum1 * iNum2); return true;
+    case LOP_FMOD: iResult = (iNum2 != 0 ? iNum1 % iNum2 : 0); return true;
+    case LOP_IDIV: iResult = (iNum2 != 0 ? iNum1 / iNum2 : 0); return true;
+
+    // let the value handle division by zero
+    case LOP_DIV:
+      if (iNum2 == 0) {
+        return false;
+      }
+      iResult = (iNum1 / iNum2);
+      return true;
+
+    case LOP_SH_L:  iResult = (iNum1 << iNum2); return true;
+    case LOP_SH_R:  iResult = (iNum1 >> iNum2); return true;
+    case LOP_B_AND: iResult = (iNum1 &  iNum2); return true;
+    case LOP_B_XOR: iResult = (iNum1 ^  iNum2); return true;
+    case LOP_B_OR:  iResult = (iNum1 |  iNum2); return true;
+
+    case LOP_GT:  iResult = (iNum1 >  iNum2); return true;
+    case LOP_GOE: iResult = (iNum1 >= iNum2); return true;
+    case LOP_LT:  iResult = (iNum1 <  iNum2); return true;
+    case LOP_LOE: iResult = (iNum1 <= iNum2); return true;
+    case LOP_EQ:  iResult = (iNum1 == iNum2); return true;
+    case LOP_NEQ: iResult = (iNum1 != iNum2); return true;
+  }
+
+  return false;
+};
+
+// Float operation that gives the same result as CLdsFloatType::BinaryOp (returns false if it can't be performed)
+static inline bool FloatOperation(const int &iOperation, const double &dNum1, const double &dNum2, double &dResult, bool &bInteger) {
+  bInteger = false;
+
+  switch (iOperation) {
+    case LOP_ADD: dResult = (dNum1 + dNum2); return true;
+    case LOP_SUB: dResult = (dNum1 - dNum2); return true;
+    case LOP_MUL: dResult = (dNum1 * dNum2); return true;
+    case LOP_DIV: dResult = (dNum1 / dNum2); return true;
+    case LOP_FMOD: dResult = (dNum2 != 0.0 ? fmod(dNum1, dNum2) : 0.0); return true;
+  }
+
+  // integer results
+  int iNum1 = (int)dNum1;
+  int iNum2 = (int)dNum2;
+  int iResult = 0;
+
+  switch (iOperation) {
+    case LOP_IDIV: iResult = (iNum2 != 0 ? iNum1 / iNum2 : 0); break;
+
+    case LOP_SH_L:  iResult = (iNum1 << iNum2); break;
+    case LOP_SH_R:  iResult = (iNum1 >> iNum2); break;
+    case LOP_B_AND: iResult = (iNum1 &  iNum2); break;
+    case LOP_B_XOR: iResult = (iNum1 ^  iNum2); break;
+    case LOP_B_OR:  iResult = (iNum1 |  iNum2); break;
+
+    case LOP_GT:  iResult = (dNum1 >  dNum2); break;
+    case LOP_GOE: iResult = (dNum1 >= dNum2); break;
+    case LOP_LT:  iResult = (dNum1 <  dNum2); break;
+    case LOP_LOE: iResult = (dNum1 <= dNum2); break;
+    case LOP_EQ:  iResult = (dNum1 == dNum2); break;
+    case LOP_NEQ: iResult = (dNum1 != dNum2); break;
+
+    default: return false;
+  }
+
+  dResult = iResult;
+  bInteger = true;
+  return true;
+};
+
+// Binary operation on numbers of expected types
+void Exec_BinaryNum(void) {
+  CLdsValueRef valRef2 = _pavalStack->Pop();
+  CLdsValueRef &valRef1 = _pavalStack->Top();
+
+  ILdsValueBase *pval1 = valRef1.vr_val.val_pBase;
+  ILdsValueBase *pval2 = valRef2.vr_val.val_pBase;
+
+  const int iArg = _ca->lt_iArg;
+  const int iOperation = LDS_BIN_NUM_OP(iArg);
+
+  int iType1 = pval1->GetType();
+  int iType2 = pval2->GetType();
+
+  // types are different from the expected ones
+  if (iType1 != LDS_BIN_NUM_TYPE1(iArg) || iType2 != LDS_BIN_NUM_TYPE2(iArg)) {
+    valRef1 = pval1->BinaryOp(valRef1, valRef2, *_ca);
+    return;
+  }
+
+  // the result isn't a reference to any variable
+  valRef1.vr_pvar = NULL;
+  valRef1.vr_pvarAccess = NULL;
+  valRef1.vr_ubFlags = 0;
+  valRef1.vr_ariIndices.Clear();
+
+  // both integers
+  if (iType1 == EVT_INDEX && iType2 == EVT_INDEX) {
+    int iResult = 0;
+
+    if (!IntOperation(iOperation, ((CLdsIntType *)pval1)->iValue, ((CLdsIntType *)pval2)->iValue, iResult)) {
+      valRef1 = pval1->BinaryOp(valRef1, valRef2, *_ca);
+      return;
+    }
+
+    // reuse the first value
+    ((CLdsIntType *)pval1)->iValue = iResult;
+    return;
+  }
+
+  // any floats
+  double dNum1 = (iType1 == EVT_FLOAT ? ((CLdsFloatType *)pval1)->dValue : (double)((CLdsIntType *)pval1)->iValue);
+  double dNum2 = (iType2 == EVT_FLOAT ? ((CLdsFloatType *)pval2)->dValue : (double)((CLdsIntType *)pval2)->iValue);
+
+  double dResult = 0.0;
+  bool bInteger = false;
+
+  if (!FloatOperation(iOperation, dNum1, dNum2, dResult, bInteger)) {
+    valRef1 = pval1->BinaryOp(valRef1, valRef2, *_ca);
+    return;
+  }
+
+  if (bInteger) {
+    valRef1.vr_val.FromInt((int)dResult);
+
+  // reuse the first value if it's a float
+  } else if (iType1 == EVT_FLOAT) {
+    ((CLdsFloatType *)pval1)->dValue = dResult;
+
+  } else {
+    valRef1.vr_val.FromFloat(dResult);
+  }
+};
+
 // Get variable value
 void Exec_Get(void) {
   // try to get the variable
@@ -178,6 +317,8 @@ void Exec_Set(void) {
   // set value to the variable
   pvar->var_valValue = _pavalStack->Pop().vr_val;
   pvar->SetConst();
+
+  _pldsCurrent->MarkChanged(*pvar);
 };
 
 // Get local variable value
@@ -224,6 +365,11 @@ void Exec_SetAccessor(void) {
   
   // set value within the array
   valRef.vr_pvarAccess->var_valValue = _pavalStack->Pop().vr_val;
+
+  // changed some global variable
+  if (valRef.IsGlobal()) {
+    _pldsCurrent->MarkChanged(*valRef.vr_pvar);
+  }
 };
 
 // Function call
@@ -234,3 +380,136 @@ void Exec_Call(void) {
   // call the function and push the return value
   _pavalStack->Push() = _pldsCurrent->CallFunction(_ca, aArgs);
 };
+
+// Make the table from cases that follow the table action
+void SLdsJumpTable::Build(CActionList &aca, const int &iTable) {
+  const int ctCases = aca[iTable].lt_iArg;
+  jt_bValid = false;
+
+  // not enough actions for all cases
+  if (ctCases <= 0 || iTable + 1 + ctCases * 2 >= aca.Count()) {
+    return;
+  }
+
+  // find range of integer cases
+  int iMin = 0;
+  int iMax = -1;
+  int ctInts = 0;
+  int iCase;
+
+  for (iCase = 0; iCase < ctCases; iCase++) {
+    CCompAction &caValue = aca[iTable + 1 + iCase * 2];
+    CCompAction &caCase = aca[iTable + 2 + iCase * 2];
+
+    // only constant cases
+    if (caValue.lt_eType != LCA_VAL || caCase.lt_eType != LCA_SWITCH) {
+      return;
+    }
+
+    switch (caValue->GetType()) {
+      case EVT_INDEX: {
+        int iValue = caValue->GetIndex();
+
+        if (ctInts == 0 || iValue < iMin) iMin = iValue;
+        if (ctInts == 0 || iValue > iMax) iMax = iValue;
+
+        ctInts++;
+      } break;
+
+      case EVT_STRING: break;
+
+      default: return;
+    }
+  }
+
+  // too sparse for a table
+  if (ctInts > 0 && double(iMax) - double(iMin) > ctInts * 4.0 + 16.0) {
+    return;
+  }
+
+  jt_iMin = iMin;
+  jt_aiJumps.Clear();
+  jt_aiJumps.New(iMax - iMin + 1);
+
+  for (int iJump = 0; iJump < jt_aiJumps.Count(); iJump++) {
+    jt_aiJumps[iJump] = -1;
+  }
+
+  jt_stStrings.Clear();
+  jt_aiStringJumps.Clear();
+
+  // the first case with the same value wins
+  for (iCase = 0; iCase < ctCases; iCase++) {
+    CCompAction &caValue = aca[iTable + 1 + iCase * 2];
+    const int iJump = aca[iTable + 2 + iCase * 2].lt_iArg;
+
+    if (caValue->GetType() == EVT_INDEX) {
+      int &iSlot = jt_aiJumps[caValue->GetIndex() - iMin];
+
+      if (iSlot == -1) {
+        iSlot = iJump;
+      }
+
+    } else {
+      const int ctStrings = jt_stStrings.Count();
+
+      if (jt_stStrings.Intern(caValue->GetString()) == ctStrings) {
+        jt_aiStringJumps.Add() = iJump;
+      }
+    }
+  }
+
+  jt_bValid = true;
+};
+
+// Find position for some value (-1 if no case)
+int SLdsJumpTable::Find(CLdsValue &val) {
+  switch (val->GetType()) {
+    case EVT_INDEX: {
+      int iSlot = val->GetIndex() - jt_iMin;
+
+      if (iSlot >= 0 && iSlot < jt_aiJumps.Count()) {
+        return jt_aiJumps[iSlot];
+      }
+    } break;
+
+    case EVT_STRING: {
+      int iString = jt_stStrings.Find(val->GetString());
+
+      if (iString != -1) {
+        return jt_aiStringJumps[iString];
+      }
+    } break;
+
+    default: break;
+  }
+
+  return -1;
+};
+
+// Jump to the matching switch case (returns position of the next action)
+int Exec_SwitchTable(CActionList &aca, const int &iTable) {
+  CCompAction &caTable = aca[iTable];
+
+  // make the table on first use
+  if (caTable.ca_pjtTable == NULL) {
+    caTable.ca_pjtTable = new SLdsJumpTable;
+    caTable.ca_pjtTable->Build(aca, iTable);
+  }
+
+  // go through the cases one by one
+  if (!caTable.ca_pjtTable->jt_bValid) {
+    return iTable + 1;
+  }
+
+  CLdsValue valDesired = _pavalStack->Top().vr_val;
+  int iJump = caTable.ca_pjtTable->Find(valDesired);
+
+  // no matching case, skip to discarding the header value
+  if (iJump == -1) {
+    return iTable + 1 + caTable.lt_iArg * 2;
+  }
+
+  _pavalStack->Pop();
+  return iJump;
+};
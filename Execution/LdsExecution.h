@@ -24,6 +24,7 @@ SOFTWARE. */
 void Exec_Val(void);
 void Exec_Unary(void);
 void Exec_Binary(void);
+void Exec_BinaryNum(void);
 void Exec_Get(void);
 void Exec_Call(void);
 
@@ -32,3 +33,6 @@ void Exec_Set(void);
 void Exec_SetLocal(void);
 void Exec_GetLocal(void);
 void Exec_SetAccessor(void);
+
+// Flow control
+int Exec_SwitchTable(CActionList &aca, const int &iTable);
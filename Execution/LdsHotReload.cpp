@@ -0,0 +1,417 @@
+/* Copyright (c) 2021 Dreamy Cecil
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#include "StdH.h"
+#include "LdsThread.h"
+
+// Check if the action ends a statement
+static bool StatementBoundary(CCompAction &ca) {
+  switch (ca.lt_eType) {
+    case LCA_DISCARD: case LCA_SET: case LCA_SET_ACCESS: case LCA_VAR: case LCA_FUNC: case LCA_DIR: case LCA_RETURN:
+    case LCA_JUMP: case LCA_JUMPIF: case LCA_JUMPUNLESS:
+      return true;
+  }
+
+  return false;
+};
+
+// Compare two actions regardless of their positions in the script
+static bool SameAction(CCompAction &ca1, CCompAction &ca2) {
+  if (ca1.lt_eType != ca2.lt_eType) {
+    return false;
+  }
+
+  // arguments of these actions are positions in the program
+  switch (ca1.lt_eType) {
+    case LCA_AND: case LCA_OR: case LCA_SWITCH:
+      break;
+
+    default:
+      if (ca1.lt_iArg != ca2.lt_iArg) {
+        return false;
+      }
+  }
+
+  return (ca1->GetType() == ca2->GetType() && ca1->Print() == ca2->Print());
+};
+
+// Check if the statement up to a certain action is the same as the other one
+static bool SameStatement(CActionList &aca, const int &iEnd, CActionList &acaOther, const int &iOtherEnd, const int &ctActions) {
+  const int iStart = iEnd - ctActions + 1;
+
+  if (iStart < 0 || (iStart > 0 && !StatementBoundary(aca[iStart - 1]))) {
+    return false;
+  }
+
+  for (int iAction = 0; iAction < ctActions; iAction++) {
+    CCompAction &ca = aca[iStart + iAction];
+
+    // must be a whole statement
+    if (StatementBoundary(ca) || !SameAction(ca, acaOther[iOtherEnd - ctActions + 1 + iAction])) {
+      return false;
+    }
+  }
+
+  return true;
+};
+
+// Find the same pause position in the new program (-1 if it cannot be matched)
+static int MatchPausePosition(CActionList &acaOld, const int &iPos, CActionList &acaNew) {
+  // threads can only be paused right after function calls
+  if (iPos <= 0 || iPos > acaOld.Count()) {
+    return -1;
+  }
+
+  const int iCall = iPos - 1;
+  const int iType = acaOld[iCall].lt_eType;
+
+  if (iType != LCA_CALL && iType != LCA_INLINE && iType != LCA_TAILCALL) {
+    return -1;
+  }
+
+  // find the beginning of the statement with the call
+  int iStart = iCall;
+
+  while (iStart > 0 && !StatementBoundary(acaOld[iStart - 1])) {
+    iStart--;
+  }
+
+  const int ctActions = iCall - iStart + 1;
+
+  // count the same statements in the old program
+  int iSame = -1;
+  int ctOld = 0;
+  int iAction;
+
+  for (iAction = 0; iAction < acaOld.Count(); iAction++) {
+    if (SameStatement(acaOld, iAction, acaOld, iCall, ctActions)) {
+      if (iAction == iCall) {
+        iSame = ctOld;
+      }
+      ctOld++;
+    }
+  }
+
+  // find the same statement in the new program
+  int iMatch = -1;
+  int ctNew = 0;
+
+  for (iAction = 0; iAction < acaNew.Count(); iAction++) {
+    if (SameStatement(acaNew, iAction, acaOld, iCall, ctActions)) {
+      if (ctNew == iSame) {
+        iMatch = iAction;
+      }
+      ctNew++;
+    }
+  }
+
+  // statements have been added or removed and cannot be told apart
+  if (ctNew != ctOld) {
+    return -1;
+  }
+
+  return iMatch + 1;
+};
+
+// Find where the local variable is defined before a certain position (-1 if it isn't)
+static int FindLocalDefinition(CActionList &aca, const string &strName, const int &iEnd) {
+  for (int iAction = 0; iAction < iEnd && iAction < aca.Count(); iAction++) {
+    CCompAction &ca = aca[iAction];
+
+    if (ca.lt_eType == LCA_VAR && ca->GetString() == strName) {
+      return iAction;
+    }
+  }
+
+  return -1;
+};
+
+// Check if hidden variables of hoisted expressions are computed by the same actions
+static bool SameHiddenLocal(CActionList &aca1, const int &iVar1, CActionList &aca2, const int &iVar2) {
+  const string strName1 = aca1[iVar1]->GetString();
+  const string strName2 = aca2[iVar2]->GetString();
+
+  int iAction = 1;
+
+  for (;; iAction++) {
+    if (iVar1 + iAction >= aca1.Count() || iVar2 + iAction >= aca2.Count()) {
+      return false;
+    }
+
+    CCompAction &ca1 = aca1[iVar1 + iAction];
+    CCompAction &ca2 = aca2[iVar2 + iAction];
+
+    const bool bSet1 = (ca1.lt_eType == LCA_SET && ca1->GetString() == strName1);
+    const bool bSet2 = (ca2.lt_eType == LCA_SET && ca2->GetString() == strName2);
+
+    // both values are set at the same time
+    if (bSet1 || bSet2) {
+      return (bSet1 && bSet2);
+    }
+
+    if (!SameAction(ca1, ca2)) {
+      return false;
+    }
+  }
+};
+
+// Check if local variables that the new program defines before the position are the same in the frame
+static bool SameFrameLocals(CActionList &acaOld, const int &iOldPos, CActionList &acaNew, const int &iNewPos,
+  CLdsVars &aLocals, const string &strPrefix)
+{
+  for (int iAction = 0; iAction < iNewPos; iAction++) {
+    CCompAction &ca = acaNew[iAction];
+
+    if (ca.lt_eType != LCA_VAR) {
+      continue;
+    }
+
+    string strName = ca->GetString();
+    int iOld = FindLocalDefinition(acaOld, strName, iOldPos);
+
+    // new variable would never be defined
+    if (iOld == -1) {
+      return false;
+    }
+
+    // hidden variables of hoisted expressions are only set before their loops
+    if (strName[0] == '#') {
+      if (!SameHiddenLocal(acaOld, iOld, acaNew, iAction)) {
+        return false;
+      }
+
+      if (aLocals.Find(strPrefix + strName) == NULL) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+};
+
+// Gather inline functions from the program and their own programs
+static void GatherInlineFunctions(CLdsProgram &pg, CLdsInFuncMap &mapFunc) {
+  CActionList &aca = pg.Actions();
+
+  for (int iAction = 0; iAction < aca.Count(); iAction++) {
+    CCompAction &ca = aca[iAction];
+
+    if (ca.lt_eType != LCA_FUNC) {
+      continue;
+    }
+
+    string strFunc = ca->GetString();
+
+    if (mapFunc.FindKeyIndex(strFunc) == -1) {
+      mapFunc.Add(strFunc) = ca.ca_inFunc;
+    }
+
+    GatherInlineFunctions(ca.ca_inFunc.in_pgFunc, mapFunc);
+  }
+};
+
+// Move paused thread from the program to its recompiled version (returns false if incompatible)
+bool CLdsThread::Migrate(CLdsProgram &pgOld, CLdsProgram &pgNew) {
+  // only paused threads are between statements
+  if (sth_eStatus != ETS_PAUSE) {
+    return false;
+  }
+
+  const int ctCalls = sth_aicCalls.Count();
+
+  // not running this program
+  CLdsProgram &pgMain = (ctCalls > 0 ? sth_aicCalls[0].pgReturn : sth_pgProgram);
+
+  if (!pgMain.SharesWith(pgOld)) {
+    return false;
+  }
+
+  CLdsInFuncMap mapNew;
+  GatherInlineFunctions(pgNew, mapNew);
+
+  // match positions in the main program and every inline call before changing anything
+  DSList<CLdsProgram> apgFrames;
+  DSList<int> aiFramePos;
+
+  for (int iFrame = 0; iFrame <= ctCalls; iFrame++) {
+    CLdsProgram &pgFrame = (iFrame < ctCalls ? sth_aicCalls[iFrame].pgReturn : sth_pgProgram);
+    int iFramePos = (iFrame < ctCalls ? sth_aicCalls[iFrame].iPos : sth_iPos);
+
+    CLdsProgram pgNewFrame = pgNew;
+
+    // inline function that has been called
+    if (iFrame > 0) {
+      string strFunc = sth_aicCalls[iFrame - 1].strFunc;
+
+      int iNew = mapNew.FindKeyIndex(strFunc);
+      int iOld = sth_mapInlineFunc.FindKeyIndex(strFunc);
+
+      if (iNew == -1 || iOld == -1) {
+        return false;
+      }
+
+      SLdsInlineFunc &inNew = mapNew.GetValue(iNew);
+      CLdsInlineArgs &astrOld = sth_mapInlineFunc.GetValue(iOld).in_astrArgs;
+
+      // arguments have changed
+      if (inNew.in_astrArgs.Count() != astrOld.Count()) {
+        return false;
+      }
+
+      for (int iArg = 0; iArg < astrOld.Count(); iArg++) {
+        if (inNew.in_astrArgs[iArg] != astrOld[iArg]) {
+          return false;
+        }
+      }
+
+      pgNewFrame = inNew.in_pgFunc;
+    }
+
+    int iNewPos = MatchPausePosition(pgFrame.Actions(), iFramePos, pgNewFrame.Actions());
+
+    if (iNewPos == -1) {
+      return false;
+    }
+
+    // locals of the frame must be usable by the new program
+    string strPrefix = (iFrame > 0 ? sth_aicCalls[iFrame - 1].VarName("") : "");
+
+    if (!SameFrameLocals(pgFrame.Actions(), iFramePos, pgNewFrame.Actions(), iNewPos, sth_aLocals, strPrefix)) {
+      return false;
+    }
+
+    // values on the stack must be exactly what the new program expects
+    // (outer frames are waiting for the result of the inline call that hasn't been pushed yet)
+    DSStack<CLdsValueRef> &avalFrame = (iFrame > 0 ? sth_aicCalls[iFrame - 1].avalStack : sth_avalStack);
+    int ctExpected = pgNewFrame.StackDepth(iNewPos) - (iFrame < ctCalls ? 1 : 0);
+
+    if (ctExpected < 0 || avalFrame.Count() != ctExpected) {
+      return false;
+    }
+
+    apgFrames.Add() = pgNewFrame;
+    aiFramePos.Add() = iNewPos;
+  }
+
+  // switch to the new programs
+  for (int iCall = 0; iCall < ctCalls; iCall++) {
+    sth_aicCalls[iCall].pgReturn = apgFrames[iCall];
+    sth_aicCalls[iCall].iPos = aiFramePos[iCall];
+  }
+
+  sth_pgProgram = apgFrames[ctCalls];
+  sth_iPos = aiFramePos[ctCalls];
+
+  // replace existing inline functions with the new ones
+  for (int iFunc = 0; iFunc < sth_mapInlineFunc.Count(); iFunc++) {
+    int iNew = mapNew.FindKeyIndex(sth_mapInlineFunc.GetKey(iFunc));
+
+    if (iNew != -1) {
+      sth_mapInlineFunc.GetValue(iFunc) = mapNew.GetValue(iNew);
+    }
+  }
+
+  MarkChanged();
+  return true;
+};
+
+// Load and compile the script file and remember it for reloading
+ELdsError CLdsScriptEngine::LdsCompileFile(const char *strFile, CLdsProgram &pgProgram) {
+  string strScript = "";
+
+  if (!_pLdsLoadScript(strFile, strScript)) {
+    LdsErrorOut("Cannot load script file '%s' (code 0x%X)\n", strFile, LER_READ);
+    return LER_READ;
+  }
+
+  // compile through the script cache
+  ELdsError eResult = LdsCompileScript(strScript, pgProgram);
+
+  if (eResult != LER_OK) {
+    return eResult;
+  }
+
+  int iFile = _mapScriptFiles.FindKeyIndex(strFile);
+
+  if (iFile == -1) {
+    _mapScriptFiles.Add(strFile) = pgProgram;
+  } else {
+    _mapScriptFiles.GetValue(iFile) = pgProgram;
+  }
+
+  return LER_OK;
+};
+
+// Recompile the script file and move paused threads to the new program (returns amount of moved threads or -1 on error)
+int CLdsScriptEngine::LdsReloadFile(const char *strFile) {
+  // remember the old program
+  CLdsProgram pgOld;
+  int iFile = _mapScriptFiles.FindKeyIndex(strFile);
+
+  if (iFile != -1) {
+    pgOld = _mapScriptFiles.GetValue(iFile);
+  }
+
+  // keep running the old program if the new one cannot be compiled
+  CLdsProgram pgNew;
+
+  if (LdsCompileFile(strFile, pgNew) != LER_OK) {
+    return -1;
+  }
+
+  // nothing has changed
+  if (iFile == -1 || pgNew.SharesWith(pgOld)) {
+    return 0;
+  }
+
+  // move paused threads (incompatible ones finish running the old program)
+  int ctMigrated = 0;
+
+  for (int iHandler = 0; iHandler < _athhThreadHandlers.Count(); iHandler++) {
+    CLdsThread *psth = _athhThreadHandlers[iHandler].psthThread;
+
+    if (psth->Migrate(pgOld, pgNew)) {
+      ctMigrated++;
+    }
+  }
+
+  return ctMigrated;
+};
+
+// Reload all changed script files from the watcher (returns amount of reloaded files)
+int CLdsScriptEngine::LdsReloadChanged(CLdsFileWatcher &fwWatcher) {
+  DSList<string> astrChanged;
+  fwWatcher.Poll(astrChanged);
+
+  int ctReloaded = 0;
+
+  for (int iFile = 0; iFile < astrChanged.Count(); iFile++) {
+    // only recompile files that have been compiled before
+    if (_mapScriptFiles.FindKeyIndex(astrChanged[iFile]) == -1) {
+      continue;
+    }
+
+    if (LdsReloadFile(astrChanged[iFile].c_str()) != -1) {
+      ctReloaded++;
+    }
+  }
+
+  return ctReloaded;
+};
@@ -0,0 +1,742 @@
+/* Copyright (c) 2021 Dreamy Cecil
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#include "StdH.h"
+#include "LdsJit.h"
+
+#if LDS_JIT
+  #include <string.h>
+  #include <sys/mman.h>
+#endif
+
+extern DSStack<CLdsValueRef> *_pavalStack;
+
+#if LDS_JIT
+
+// Kinds of variables used by native code
+enum ELdsJitVar {
+  JVK_GET,    // local variable that gets read
+  JVK_SET,    // local variable that gets changed
+  JVK_DEFINE, // local variable that gets redefined
+  JVK_GLOBAL, // global variable that gets read
+};
+
+// Variable used by native code
+struct SLdsJitVar {
+  string jv_strName;
+  int jv_eKind;
+};
+
+// Position to return to the interpreter at
+struct SLdsJitExit {
+  int je_iPos; // action to continue from
+  int je_ctValues; // amount of values left on the stack
+};
+
+// Data passed to native code (layout is used by the generated code)
+struct SLdsJitFrame {
+  int *jf_aiStack; // stack of integer values
+  int **jf_apiVars; // integer values of variables
+  LONG64 jf_ctBudget; // return to the interpreter after executing this many actions
+  LONG64 jf_ctActions; // amount of executed actions
+};
+
+// Native code compiled from some position
+struct SLdsJitRegion {
+  void *jr_pCode; // executable memory
+  size_t jr_iSize; // size of the executable memory
+
+  DSList<SLdsJitVar> jr_aVars; // variables used by the code
+  DSList<SLdsJitExit> jr_aExits; // positions to return to the interpreter at
+
+  DSArray<int> jr_aiStack; // stack of values during execution
+  DSArray<int *> jr_apiVars; // variable values during execution
+
+  // Constructor
+  SLdsJitRegion(void) : jr_pCode(NULL), jr_iSize(0) {};
+
+  // Destructor
+  ~SLdsJitRegion(void) {
+    if (jr_pCode != NULL) {
+      munmap(jr_pCode, jr_iSize);
+    }
+  };
+
+  // Add a variable (returns its index)
+  int AddVar(const string &strName, const int &eKind) {
+    for (int iVar = 0; iVar < jr_aVars.Count(); iVar++) {
+      if (jr_aVars[iVar].jv_eKind == eKind && jr_aVars[iVar].jv_strName == strName) {
+        return iVar;
+      }
+    }
+
+    SLdsJitVar &jv = jr_aVars.Add();
+    jv.jv_strName = strName;
+    jv.jv_eKind = eKind;
+
+    return jr_aVars.Count() - 1;
+  };
+};
+
+// Find local variable the same way Exec_GetLocal does
+static SLdsVar *JitLocalVar(CLdsThread &sth, const string &strName) {
+  SLdsVar *pvar = NULL;
+
+  if (sth.sth_aicCalls.Count() > 0) {
+    pvar = sth.sth_aLocals.Find(sth.sth_aicCalls.Top().VarName(strName));
+  }
+
+  if (pvar == NULL) {
+    pvar = sth.sth_aLocals.Find(strName);
+  }
+
+  return pvar;
+};
+
+// Find local variable the same way LCA_VAR does
+static SLdsVar *JitDefinedVar(CLdsThread &sth, const string &strName) {
+  if (sth.sth_aicCalls.Count() > 0) {
+    return sth.sth_aLocals.Find(sth.sth_aicCalls.Top().VarName(strName));
+  }
+
+  return sth.sth_aLocals.Find(strName);
+};
+
+// Find variable of some kind that holds an integer (NULL if there's no such variable)
+static SLdsVar *JitIntVar(CLdsThread &sth, const string &strName, const int &eKind) {
+  SLdsVar *pvar = NULL;
+
+  switch (eKind) {
+    case JVK_GET: case JVK_SET: pvar = JitLocalVar(sth, strName); break;
+    case JVK_DEFINE: pvar = JitDefinedVar(sth, strName); break;
+    case JVK_GLOBAL: pvar = sth.sth_pldsEngine->_aLdsVariables.Find(strName); break;
+  }
+
+  if (pvar == NULL || pvar->var_valValue->GetType() != EVT_INDEX) {
+    return NULL;
+  }
+
+  // values of constants cannot be changed
+  if ((eKind == JVK_SET || eKind == JVK_DEFINE) && pvar->var_bConst != 0) {
+    return NULL;
+  }
+
+  return pvar;
+};
+
+// Check if the integer operation can be done in native code
+static bool JitIntOperation(const int &iOperation) {
+  switch (iOperation) {
+    case LOP_ADD: case LOP_SUB: case LOP_MUL:
+    case LOP_DIV: case LOP_IDIV: case LOP_FMOD:
+    case LOP_SH_L: case LOP_SH_R:
+    case LOP_B_AND: case LOP_B_XOR: case LOP_B_OR:
+    case LOP_GT: case LOP_GOE: case LOP_LT: case LOP_LOE: case LOP_EQ: case LOP_NEQ:
+      return true;
+  }
+
+  return false;
+};
+
+// Check if the action can be executed in native code with some amount of values on the stack
+static bool JitSupported(CLdsThread &sth, CCompAction &ca, const int &ctValues, const int &ctActions) {
+  switch (ca.lt_eType) {
+    case LCA_VAL:
+      return (ca.lt_iArg < 0 && ca.lt_valValue->GetType() == EVT_INDEX);
+
+    case LCA_GET:
+      return (JitIntVar(sth, ca.lt_valValue->GetString(), ca.lt_iArg ? JVK_GET : JVK_GLOBAL) != NULL);
+
+    case LCA_SET:
+      return (ctValues >= 1 && ca.lt_iArg && JitIntVar(sth, ca.lt_valValue->GetString(), JVK_SET) != NULL);
+
+    // only redefinitions of existing variables
+    case LCA_VAR:
+      return (ca.lt_iArg == 0 && JitIntVar(sth, ca.lt_valValue->GetString(), JVK_DEFINE) != NULL);
+
+    case LCA_BIN_NUM: {
+      const int iArg = ca.lt_iArg;
+
+      return (ctValues >= 2 && LDS_BIN_NUM_TYPE1(iArg) == EVT_INDEX && LDS_BIN_NUM_TYPE2(iArg) == EVT_INDEX
+           && JitIntOperation(LDS_BIN_NUM_OP(iArg)));
+    }
+
+    case LCA_JUMP:
+      return (ca.lt_iArg >= 0 && ca.lt_iArg <= ctActions);
+
+    case LCA_JUMPIF: case LCA_JUMPUNLESS:
+    case LCA_AND: case LCA_OR:
+      return (ctValues >= 1 && ca.lt_iArg >= 0 && ca.lt_iArg <= ctActions);
+
+    case LCA_DUP: case LCA_DISCARD:
+      return (ctValues >= 1);
+  }
+
+  return false;
+};
+
+// Native code writer
+class CLdsJitWriter {
+  public:
+    // Jump that needs its offset to be set
+    struct SFixup {
+      int iOffset; // where the offset is written
+      int iTarget; // action position or exit index
+      bool bExit; // jump to the exit
+    };
+
+    CLdsBufferStream jw_bsCode;
+    DSList<SFixup> jw_aFixups;
+
+    DSArray<int> jw_aiLabels; // code offset of each action (-1 if not compiled)
+    DSArray<int> jw_aiDepth; // amount of values before each action (-1 if not reached)
+    DSList<int> jw_aiExitLabels; // code offset of each exit
+    int jw_iEpilogue; // code offset of the epilogue
+
+  public:
+    // Write bytes
+    inline void Byte(const int &iByte) {
+      unsigned char ub = (unsigned char)iByte;
+      jw_bsCode.Write(&ub, 1);
+    };
+
+    inline void Bytes(const int &iByte1, const int &iByte2) {
+      Byte(iByte1);
+      Byte(iByte2);
+    };
+
+    inline void Bytes(const int &iByte1, const int &iByte2, const int &iByte3) {
+      Byte(iByte1);
+      Byte(iByte2);
+      Byte(iByte3);
+    };
+
+    inline void Int(const int &iValue) {
+      jw_bsCode.Write(&iValue, 4);
+    };
+
+    inline int Offset(void) const {
+      return (int)jw_bsCode.bs_ctSize;
+    };
+
+    // mov reg32, [r12 + slot * 4]
+    void LoadSlot(const int &iReg, const int &iSlot) {
+      Bytes(0x41, 0x8B, 0x84 | (iReg << 3));
+      Byte(0x24);
+      Int(iSlot * 4);
+    };
+
+    // mov [r12 + slot * 4], reg32
+    void StoreSlot(const int &iReg, const int &iSlot) {
+      Bytes(0x41, 0x89, 0x84 | (iReg << 3));
+      Byte(0x24);
+      Int(iSlot * 4);
+    };
+
+    // mov reg64, [r13 + var * 8]
+    void LoadVar(const int &iReg, const int &iVar) {
+      Bytes(0x49, 0x8B, 0x85 | (iReg << 3));
+      Int(iVar * 8);
+    };
+
+    // inc r14
+    void CountAction(void) {
+      Bytes(0x49, 0xFF, 0xC6);
+    };
+
+    // Jump with a 32-bit offset to an action or an exit
+    void Jump(const int &iOpcode1, const int &iOpcode2, const int &iTarget, const bool &bExit) {
+      if (iOpcode1 != -1) {
+        Byte(iOpcode1);
+      }
+      Byte(iOpcode2);
+
+      SFixup &fx = jw_aFixups.Add();
+      fx.iOffset = Offset();
+      fx.iTarget = iTarget;
+      fx.bExit = bExit;
+
+      Int(0);
+    };
+};
+
+// Get exit for some position (adds a new one if needed)
+static int JitExit(SLdsJitRegion &jr, const int &iPos, const int &ctValues) {
+  for (int iExit = 0; iExit < jr.jr_aExits.Count(); iExit++) {
+    if (jr.jr_aExits[iExit].je_iPos == iPos) {
+      return iExit;
+    }
+  }
+
+  SLdsJitExit &je = jr.jr_aExits.Add();
+  je.je_iPos = iPos;
+  je.je_ctValues = ctValues;
+
+  return jr.jr_aExits.Count() - 1;
+};
+
+// Jump to some position within the region or to the exit
+static void JitJumpTo(CLdsJitWriter &jw, SLdsJitRegion &jr, const int &iOpcode1, const int &iOpcode2, const int &iPos) {
+  if (jw.jw_aiLabels[iPos] != -1) {
+    jw.Jump(iOpcode1, iOpcode2, iPos, false);
+  } else {
+    jw.Jump(iOpcode1, iOpcode2, JitExit(jr, iPos, jw.jw_aiDepth[iPos]), true);
+  }
+};
+
+// Return to the interpreter before jumping back if the budget has been spent
+static void JitCheckBudget(CLdsJitWriter &jw, SLdsJitRegion &jr, const int &iPos) {
+  // cmp r14, r15 -> jae exit
+  jw.Bytes(0x4D, 0x39, 0xFE);
+  jw.Jump(0x0F, 0x83, JitExit(jr, iPos, jw.jw_aiDepth[iPos]), true);
+};
+
+// Mark amount of values at the next position
+static void JitReach(CLdsJitWriter &jw, DSStack<int> &aiPending, const int &iPos, const int &ctValues) {
+  if (jw.jw_aiDepth[iPos] == -1) {
+    jw.jw_aiDepth[iPos] = ctValues;
+    aiPending.Push(iPos);
+  }
+};
+
+// Write native code for the integer operation
+static void JitIntCode(CLdsJitWriter &jw, SLdsJitRegion &jr, const int &iOperation, const int &iPos, const int &ctValues) {
+  switch (iOperation) {
+    case LOP_ADD: jw.Bytes(0x01, 0xC8); break; // add eax, ecx
+    case LOP_SUB: jw.Bytes(0x29, 0xC8); break; // sub eax, ecx
+    case LOP_MUL: jw.Bytes(0x0F, 0xAF, 0xC1); break; // imul eax, ecx
+
+    // let the interpreter handle division by zero
+    case LOP_DIV:
+      jw.Bytes(0x85, 0xC9); // test ecx, ecx
+      jw.Jump(0x0F, 0x84, JitExit(jr, iPos, ctValues), true); // jz exit
+      jw.Byte(0x99); // cdq
+      jw.Bytes(0xF7, 0xF9); // idiv ecx
+      break;
+
+    // zero when dividing by zero
+    case LOP_IDIV:
+    case LOP_FMOD:
+      jw.Bytes(0x85, 0xC9); // test ecx, ecx
+      jw.Bytes(0x74, iOperation == LOP_FMOD ? 7 : 5); // jz zero
+      jw.Byte(0x99); // cdq
+      jw.Bytes(0xF7, 0xF9); // idiv ecx
+
+      if (iOperation == LOP_FMOD) {
+        jw.Bytes(0x89, 0xD0); // mov eax, edx
+      }
+
+      jw.Bytes(0xEB, 0x02); // jmp done
+      jw.Bytes(0x31, 0xC0); // zero: xor eax, eax
+      break;
+
+    case LOP_SH_L: jw.Bytes(0xD3, 0xE0); break; // shl eax, cl
+    case LOP_SH_R: jw.Bytes(0xD3, 0xF8); break; // sar eax, cl
+    case LOP_B_AND: jw.Bytes(0x21, 0xC8); break; // and eax, ecx
+    case LOP_B_XOR: jw.Bytes(0x31, 0xC8); break; // xor eax, ecx
+    case LOP_B_OR:  jw.Bytes(0x09, 0xC8); break; // or eax, ecx
+
+    // cmp eax, ecx -> setcc al -> movzx eax, al
+    default: {
+      int iSet = 0x94;
+
+      switch (iOperation) {
+        case LOP_GT:  iSet = 0x9F; break;
+        case LOP_GOE: iSet = 0x9D; break;
+        case LOP_LT:  iSet = 0x9C; break;
+        case LOP_LOE: iSet = 0x9E; break;
+        case LOP_EQ:  iSet = 0x94; break;
+        case LOP_NEQ: iSet = 0x95; break;
+      }
+
+      jw.Bytes(0x39, 0xC8);
+      jw.Bytes(0x0F, iSet, 0xC0);
+      jw.Bytes(0x0F, 0xB6, 0xC0);
+    } break;
+  }
+};
+
+// Write native code for the conditional jump
+static void JitBranch(CLdsJitWriter &jw, SLdsJitRegion &jr, const bool &bIfTrue, const int &iPos, const int &iTarget) {
+  jw.Bytes(0x85, 0xC0); // test eax, eax
+
+  // jump straight to the target
+  if (iTarget > iPos) {
+    JitJumpTo(jw, jr, 0x0F, bIfTrue ? 0x85 : 0x84, iTarget);
+    return;
+  }
+
+  // skip the jump back if the condition isn't met
+  jw.Bytes(0x0F, bIfTrue ? 0x84 : 0x85);
+  const int iSkip = jw.Offset();
+  jw.Int(0);
+
+  JitCheckBudget(jw, jr, iTarget);
+  JitJumpTo(jw, jr, -1, 0xE9, iTarget);
+
+  const int iSkipOffset = jw.Offset() - (iSkip + 4);
+  memcpy(jw.jw_bsCode.bs_pData + iSkip, &iSkipOffset, 4);
+};
+
+// Compile actions reachable from some position into native code (returns NULL if there's nothing to compile)
+static SLdsJitRegion *JitCompile(CLdsThread &sth, CActionList &aca, const int &iEntry) {
+  const int ctActions = aca.Count();
+
+  CLdsJitWriter jw;
+  jw.jw_aiLabels.New(ctActions + 1);
+  jw.jw_aiDepth.New(ctActions + 1);
+
+  int iAction;
+
+  for (iAction = 0; iAction <= ctActions; iAction++) {
+    jw.jw_aiLabels[iAction] = -1;
+    jw.jw_aiDepth[iAction] = -1;
+  }
+
+  // find supported actions and amount of values before each one (not counting values below the entry)
+  DSStack<int> aiPending;
+  JitReach(jw, aiPending, iEntry, 0);
+
+  int ctMaxValues = 1;
+  int ctCompiled = 0;
+
+  while (aiPending.Count() > 0) {
+    const int iPos = aiPending.Pop();
+
+    if (iPos >= ctActions) {
+      continue;
+    }
+
+    CCompAction &ca = aca[iPos];
+    const int ctValues = jw.jw_aiDepth[iPos];
+
+    if (!JitSupported(sth, ca, ctValues, ctActions)) {
+      continue;
+    }
+
+    // mark as compiled
+    jw.jw_aiLabels[iPos] = 0;
+    ctCompiled++;
+
+    int ctPop, ctPush;
+    LdsActionStack(ca, ctPop, ctPush);
+
+    const int ctNext = ctValues - ctPop + ctPush;
+
+    if (ctNext + 1 > ctMaxValues) {
+      ctMaxValues = ctNext + 1;
+    }
+
+    switch (ca.lt_eType) {
+      case LCA_JUMP:
+        JitReach(jw, aiPending, ca.lt_iArg, ctValues);
+        continue;
+
+      case LCA_JUMPIF: case LCA_JUMPUNLESS:
+        JitReach(jw, aiPending, ca.lt_iArg, ctValues - 1);
+        break;
+
+      case LCA_AND: case LCA_OR:
+        JitReach(jw, aiPending, ca.lt_iArg, ctValues);
+        break;
+    }
+
+    JitReach(jw, aiPending, iPos + 1, ctNext);
+  }
+
+  // nothing to run natively from here
+  if (jw.jw_aiLabels[iEntry] == -1) {
+    return NULL;
+  }
+
+  SLdsJitRegion *pjr = new SLdsJitRegion;
+  SLdsJitRegion &jr = *pjr;
+
+  jr.jr_aiStack.New(ctMaxValues);
+
+  // push rbx, r12, r13, r14, r15
+  jw.Byte(0x53);
+  jw.Bytes(0x41, 0x54);
+  jw.Bytes(0x41, 0x55);
+  jw.Bytes(0x41, 0x56);
+  jw.Bytes(0x41, 0x57);
+
+  jw.Bytes(0x48, 0x89, 0xFB); // mov rbx, rdi
+  jw.Bytes(0x4C, 0x8B, 0x23); // mov r12, [rbx + jf_aiStack]
+  jw.Bytes(0x4C, 0x8B, 0x6B); jw.Byte(0x08); // mov r13, [rbx + jf_apiVars]
+  jw.Bytes(0x4C, 0x8B, 0x7B); jw.Byte(0x10); // mov r15, [rbx + jf_ctBudget]
+  jw.Bytes(0x45, 0x31, 0xF6); // xor r14d, r14d
+
+  // start from the entry
+  jw.Jump(-1, 0xE9, iEntry, false);
+
+  for (iAction = 0; iAction < ctActions; iAction++) {
+    if (jw.jw_aiLabels[iAction] == -1) {
+      continue;
+    }
+
+    jw.jw_aiLabels[iAction] = jw.Offset();
+
+    CCompAction &ca = aca[iAction];
+    const int ctValues = jw.jw_aiDepth[iAction];
+    bool bNext = true;
+
+    switch (ca.lt_eType) {
+      case LCA_VAL:
+        // mov dword [r12 + slot * 4], value
+        jw.Bytes(0x41, 0xC7, 0x84);
+        jw.Byte(0x24);
+        jw.Int(ctValues * 4);
+        jw.Int(ca.lt_valValue->GetIndex());
+        jw.CountAction();
+        break;
+
+      case LCA_GET:
+        jw.LoadVar(0, jr.AddVar(ca.lt_valValue->GetString(), ca.lt_iArg ? JVK_GET : JVK_GLOBAL));
+        jw.Bytes(0x8B, 0x00); // mov eax, [rax]
+        jw.StoreSlot(0, ctValues);
+        jw.CountAction();
+        break;
+
+      case LCA_SET:
+        jw.LoadSlot(0, ctValues - 1);
+        jw.LoadVar(1, jr.AddVar(ca.lt_valValue->GetString(), JVK_SET));
+        jw.Bytes(0x89, 0x01); // mov [rcx], eax
+        jw.CountAction();
+        break;
+
+      case LCA_VAR:
+        jw.LoadVar(1, jr.AddVar(ca.lt_valValue->GetString(), JVK_DEFINE));
+        jw.Bytes(0xC7, 0x01); // mov dword [rcx], 0
+        jw.Int(0);
+        jw.CountAction();
+        break;
+
+      case LCA_BIN_NUM:
+        jw.LoadSlot(0, ctValues - 2);
+        jw.LoadSlot(1, ctValues - 1);
+        JitIntCode(jw, jr, LDS_BIN_NUM_OP(ca.lt_iArg), iAction, ctValues);
+        jw.StoreSlot(0, ctValues - 2);
+        jw.CountAction();
+        break;
+
+      case LCA_DUP:
+        jw.LoadSlot(0, ctValues - 1);
+        jw.StoreSlot(0, ctValues);
+        jw.CountAction();
+        break;
+
+      case LCA_DISCARD:
+        jw.CountAction();
+        break;
+
+      case LCA_JUMP:
+        jw.CountAction();
+
+        if (ca.lt_iArg <= iAction) {
+          JitCheckBudget(jw, jr, ca.lt_iArg);
+        }
+
+        JitJumpTo(jw, jr, -1, 0xE9, ca.lt_iArg);
+        bNext = false;
+        break;
+
+      case LCA_JUMPIF: case LCA_JUMPUNLESS:
+        jw.LoadSlot(0, ctValues - 1);
+        jw.CountAction();
+        JitBranch(jw, jr, ca.lt_eType == LCA_JUMPIF, iAction, ca.lt_iArg);
+        break;
+
+      // value stays on the stack when jumping
+      case LCA_AND: case LCA_OR:
+        jw.LoadSlot(0, ctValues - 1);
+        jw.CountAction();
+        JitBranch(jw, jr, ca.lt_eType == LCA_OR, iAction, ca.lt_iArg);
+        break;
+    }
+
+    // continue with the next action
+    if (bNext && (iAction + 1 >= ctActions || jw.jw_aiLabels[iAction + 1] == -1)) {
+      JitJumpTo(jw, jr, -1, 0xE9, iAction + 1);
+    }
+  }
+
+  // return exit index
+  for (int iExit = 0; iExit < jr.jr_aExits.Count(); iExit++) {
+    jw.jw_aiExitLabels.Add() = jw.Offset();
+
+    jw.Byte(0xB8); // mov eax, exit
+    jw.Int(iExit);
+    jw.Jump(-1, 0xE9, -1, false);
+  }
+
+  jw.jw_iEpilogue = jw.Offset();
+
+  jw.Bytes(0x4C, 0x89, 0x73); jw.Byte(0x18); // mov [rbx + jf_ctActions], r14
+
+  // pop r15, r14, r13, r12, rbx
+  jw.Bytes(0x41, 0x5F);
+  jw.Bytes(0x41, 0x5E);
+  jw.Bytes(0x41, 0x5D);
+  jw.Bytes(0x41, 0x5C);
+  jw.Byte(0x5B);
+  jw.Byte(0xC3); // ret
+
+  // set jump offsets
+  for (int iFixup = 0; iFixup < jw.jw_aFixups.Count(); iFixup++) {
+    const CLdsJitWriter::SFixup &fx = jw.jw_aFixups[iFixup];
+    int iTarget;
+
+    if (fx.bExit) {
+      iTarget = jw.jw_aiExitLabels[fx.iTarget];
+    } else if (fx.iTarget == -1) {
+      iTarget = jw.jw_iEpilogue;
+    } else {
+      iTarget = jw.jw_aiLabels[fx.iTarget];
+    }
+
+    const int iRelative = iTarget - (fx.iOffset + 4);
+    memcpy(jw.jw_bsCode.bs_pData + fx.iOffset, &iRelative, 4);
+  }
+
+  // copy into executable memory
+  jr.jr_iSize = jw.Offset();
+  void *pCode = mmap(NULL, jr.jr_iSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+  if (pCode == MAP_FAILED) {
+    delete pjr;
+    return NULL;
+  }
+
+  memcpy(pCode, jw.jw_bsCode.bs_pData, jr.jr_iSize);
+  jr.jr_pCode = pCode;
+
+  if (mprotect(pCode, jr.jr_iSize, PROT_READ | PROT_EXEC) != 0) {
+    delete pjr;
+    return NULL;
+  }
+
+  jr.jr_apiVars.New(jr.jr_aVars.Count() > 0 ? jr.jr_aVars.Count() : 1);
+  return pjr;
+};
+
+// Run native code (returns position to continue from or -1 if variables have unexpected types)
+static int JitRun(CLdsThread &sth, SLdsJitRegion &jr) {
+  // get integer values of variables
+  const int ctVars = jr.jr_aVars.Count();
+
+  for (int iVar = 0; iVar < ctVars; iVar++) {
+    const SLdsJitVar &jv = jr.jr_aVars[iVar];
+    SLdsVar *pvar = JitIntVar(sth, jv.jv_strName, jv.jv_eKind);
+
+    if (pvar == NULL) {
+      return -1;
+    }
+
+    jr.jr_apiVars[iVar] = &((CLdsIntType *)pvar->var_valValue.val_pBase)->iValue;
+  }
+
+  SLdsJitFrame jf;
+  jf.jf_aiStack = &jr.jr_aiStack[0];
+  jf.jf_apiVars = &jr.jr_apiVars[0];
+  jf.jf_ctBudget = LDS_JIT_BUDGET;
+  jf.jf_ctActions = 0;
+
+  // return in time for the next check of execution limits
+  if (sth.HasQuota()) {
+    const LONG64 ctLeft = sth.sth_ctQuotaCheck - sth.sth_ctActions;
+    jf.jf_ctBudget = (ctLeft > 0 ? (ctLeft < LDS_JIT_BUDGET ? ctLeft : LDS_JIT_BUDGET) : 0);
+  }
+
+  int iExit = ((int (*)(SLdsJitFrame *))jr.jr_pCode)(&jf);
+  const SLdsJitExit &je = jr.jr_aExits[iExit];
+
+  // put values back onto the stack
+  for (int iValue = 0; iValue < je.je_ctValues; iValue++) {
+    _pavalStack->Push() = CLdsValueRef(CLdsValue(jr.jr_aiStack[iValue]));
+  }
+
+  sth.sth_ctActions += jf.jf_ctActions;
+  return je.je_iPos;
+};
+
+#endif // LDS_JIT
+
+// Destructor
+SLdsJitData::~SLdsJitData(void) {
+#if LDS_JIT
+  for (int iSpot = 0; iSpot < jd_aSpots.Count(); iSpot++) {
+    if (jd_aSpots[iSpot].js_pRegion != NULL) {
+      delete jd_aSpots[iSpot].js_pRegion;
+    }
+  }
+#endif
+};
+
+// Count one execution of a hot spot and run native code from it
+int LdsJitHotSpot(CLdsThread &sth, CLdsProgram &pg, const int &iPos) {
+#if LDS_JIT
+  const int ctHits = sth.sth_pldsEngine->_ctJitHits;
+
+  // only verified programs can run natively (and profiled, sampled or traced actions must go through the interpreter)
+  if (ctHits <= 0 || sth.IsDebug() || sth.sth_pldsEngine->_bProfileActions
+   || sth.sth_pldsEngine->_smpStacks.IsActive() || sth.sth_pldsEngine->_trcActions.IsActive() || !pg.IsVerified()) {
+    return iPos;
+  }
+
+  SLdsJitData *&pjd = pg.Jit();
+
+  if (pjd == NULL) {
+    pjd = new SLdsJitData;
+    pjd->jd_aSpots.New(pg.Count() + 1);
+  }
+
+  SLdsJitSpot &js = pjd->jd_aSpots[iPos];
+
+  if (js.js_pRegion == NULL) {
+    // not hot enough or cannot be compiled
+    if (++js.js_ctHits < ctHits || js.js_ctCompiled >= LDS_JIT_RECOMPILES) {
+      return iPos;
+    }
+
+    js.js_ctCompiled++;
+    js.js_pRegion = JitCompile(sth, pg.Actions(), iPos);
+
+    if (js.js_pRegion == NULL) {
+      js.js_ctCompiled = LDS_JIT_RECOMPILES;
+      return iPos;
+    }
+  }
+
+  int iNext = JitRun(sth, *js.js_pRegion);
+
+  // compile again later for the new variable types
+  if (iNext == -1) {
+    delete js.js_pRegion;
+    js.js_pRegion = NULL;
+    js.js_ctHits = 0;
+    return iPos;
+  }
+
+  return iNext;
+#else
+  return iPos;
+#endif
+};
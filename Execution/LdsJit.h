@@ -0,0 +1,64 @@
+/* Copyright (c) 2021 Dreamy Cecil
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#pragma once
+
+#include "../Base/LdsBase.h"
+
+// Native code can only be generated for 64-bit x86 under Linux
+#if defined(PLATFORM_UNIX) && defined(__x86_64__)
+  #define LDS_JIT 1
+#else
+  #define LDS_JIT 0
+#endif
+
+// Default amount of loop iterations and inline function calls before compiling them into native code (0 to disable)
+#define LDS_JIT_HITS 0
+
+// Amount of actions native code may execute before returning to the interpreter
+#define LDS_JIT_BUDGET 0x100000
+
+// Amount of times a hot spot may be recompiled for different variable types before giving up
+#define LDS_JIT_RECOMPILES 4
+
+class CLdsThread;
+class CLdsProgram;
+struct SLdsJitRegion;
+
+// Position within a program that may run native code
+struct SLdsJitSpot {
+  int js_ctHits; // how many times it has been reached
+  int js_ctCompiled; // how many times it has been compiled
+  SLdsJitRegion *js_pRegion; // native code from this position (NULL if not compiled)
+
+  // Constructor
+  SLdsJitSpot(void) : js_ctHits(0), js_ctCompiled(0), js_pRegion(NULL) {};
+};
+
+// Native code of one program
+struct SLdsJitData {
+  DSArray<SLdsJitSpot> jd_aSpots; // hot spots for each action and the end of the program
+
+  // Destructor
+  ~SLdsJitData(void);
+};
+
+// Count one execution of a hot spot and run native code from it (returns position to continue from)
+int LdsJitHotSpot(CLdsThread &sth, CLdsProgram &pg, const int &iPos);
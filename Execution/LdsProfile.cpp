@@ -0,0 +1,534 @@
+/* Copyright (c) 2021 Dreamy Cecil
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#include "StdH.h"
+#include "LdsProfile.h"
+
+#include <stdlib.h>
+#include <limits.h>
+
+// Set by the sampling timer when it's time for the next sample
+extern volatile sig_atomic_t LDS_bSampleSignal = 0;
+
+// Reset all statistics
+void CLdsProfile::Clear(void) {
+  pf_apeActions.New(LCA_SIZEOF);
+
+  for (int iType = 0; iType < LCA_SIZEOF; iType++) {
+    pf_apeActions[iType].pe_iKey = iType;
+  }
+
+  pf_apePositions.New(64);
+  pf_ctPositions = 0;
+
+  pf_llStartTicks = LdsGetTicks();
+  pf_dStartTime = LdsGetTime();
+};
+
+// Find entry of some position
+SLdsProfileEntry &CLdsProfile::PositionEntry(const int &iPos) {
+  // grow the table when it's half full
+  if ((pf_ctPositions + 1) * 2 > pf_apePositions.Count()) {
+    DSArray<SLdsProfileEntry> apeOld;
+    apeOld.CopyArray(pf_apePositions);
+
+    pf_apePositions.New(apeOld.Count() * 2);
+    pf_ctPositions = 0;
+
+    for (int iOld = 0; iOld < apeOld.Count(); iOld++) {
+      if (apeOld[iOld].pe_iKey != -1) {
+        PositionEntry(apeOld[iOld].pe_iKey) = apeOld[iOld];
+      }
+    }
+  }
+
+  const int iMask = pf_apePositions.Count() - 1;
+  int iSlot = (unsigned int)(iPos * 0x9E3779B1) & iMask;
+
+  // find the position or a free slot after it
+  while (true) {
+    SLdsProfileEntry &pe = pf_apePositions[iSlot];
+
+    if (pe.pe_iKey == iPos) {
+      return pe;
+    }
+
+    if (pe.pe_iKey == -1) {
+      pe.pe_iKey = iPos;
+      pf_ctPositions++;
+      return pe;
+    }
+
+    iSlot = (iSlot + 1) & iMask;
+  }
+};
+
+// Count one executed action
+void CLdsProfile::Record(const int &iType, const int &iPos, const LONG64 &llTicks) {
+  SLdsProfileEntry &peAction = pf_apeActions[iType];
+  peAction.pe_ctHits++;
+  peAction.pe_llTicks += llTicks;
+
+  SLdsProfileEntry &pePos = PositionEntry(iPos);
+  pePos.pe_ctHits++;
+  pePos.pe_llTicks += llTicks;
+};
+
+// Seconds in one tick since some start
+static double TicksSince(const LONG64 &llStartTicks, const double &dStartTime) {
+  LONG64 llTicks = LdsGetTicks() - llStartTicks;
+
+  if (llTicks <= 0) {
+    return 0.0;
+  }
+
+  return (LdsGetTime() - dStartTime) / double(llTicks);
+};
+
+// Seconds in one tick
+double CLdsProfile::TickTime(void) {
+  return TicksSince(pf_llStartTicks, pf_dStartTime);
+};
+
+// Sort entries by self time from highest to lowest
+static int CompareProfileEntries(const void *pEntry1, const void *pEntry2) {
+  const SLdsProfileEntry *pe1 = *(const SLdsProfileEntry **)pEntry1;
+  const SLdsProfileEntry *pe2 = *(const SLdsProfileEntry **)pEntry2;
+
+  if (pe1->pe_llTicks != pe2->pe_llTicks) {
+    return (pe1->pe_llTicks > pe2->pe_llTicks ? -1 : 1);
+  }
+
+  return (pe1->pe_iKey < pe2->pe_iKey ? -1 : 1);
+};
+
+// Gather used entries sorted by self time
+static void SortProfileEntries(DSArray<SLdsProfileEntry> &ape, DSList<SLdsProfileEntry *> &appe, LONG64 &llTotal) {
+  for (int iEntry = 0; iEntry < ape.Count(); iEntry++) {
+    SLdsProfileEntry &pe = ape[iEntry];
+
+    if (pe.pe_iKey != -1 && pe.pe_ctHits > 0) {
+      appe.Add() = &pe;
+      llTotal += pe.pe_llTicks;
+    }
+  }
+
+  if (appe.Count() > 1) {
+    qsort(&appe[0], appe.Count(), sizeof(SLdsProfileEntry *), CompareProfileEntries);
+  }
+};
+
+// Make a report of up to some amount of entries sorted by self time
+string CLdsProfile::Report(const int &ctEntries) {
+  const double dTickTime = TickTime();
+
+  DSList<SLdsProfileEntry *> appeActions;
+  DSList<SLdsProfileEntry *> appePositions;
+  LONG64 llTotal = 0;
+  LONG64 llPositions = 0;
+
+  SortProfileEntries(pf_apeActions, appeActions, llTotal);
+  SortProfileEntries(pf_apePositions, appePositions, llPositions);
+
+  LONG64 ctTotalHits = 0;
+  int iEntry;
+
+  for (iEntry = 0; iEntry < appeActions.Count(); iEntry++) {
+    ctTotalHits += appeActions[iEntry]->pe_ctHits;
+  }
+
+  const double dTotal = (llTotal > 0 ? double(llTotal) : 1.0);
+
+  string strReport = LdsPrintF("Executed %lld actions in %.3f ms\n", ctTotalHits, double(llTotal) * dTickTime * 1000.0);
+
+  // action types
+  strReport += "\nSelf time by action type:\n";
+
+  for (iEntry = 0; iEntry < appeActions.Count(); iEntry++) {
+    if (ctEntries > 0 && iEntry >= ctEntries) {
+      break;
+    }
+
+    SLdsProfileEntry &pe = *appeActions[iEntry];
+
+    strReport += LdsPrintF("  %-12s %12lld hits %10.3f ms %6.2f%%\n", _astrActionNames[pe.pe_iKey], pe.pe_ctHits,
+                           double(pe.pe_llTicks) * dTickTime * 1000.0, double(pe.pe_llTicks) / dTotal * 100.0);
+  }
+
+  // script positions
+  strReport += "\nSelf time by script position:\n";
+
+  for (iEntry = 0; iEntry < appePositions.Count(); iEntry++) {
+    if (ctEntries > 0 && iEntry >= ctEntries) {
+      break;
+    }
+
+    SLdsProfileEntry &pe = *appePositions[iEntry];
+
+    strReport += LdsPrintF("  %-22s %12lld hits %10.3f ms %6.2f%%\n", LdsPrintPos(pe.pe_iKey).c_str(), pe.pe_ctHits,
+                           double(pe.pe_llTicks) * dTickTime * 1000.0, double(pe.pe_llTicks) / dTotal * 100.0);
+  }
+
+  return strReport;
+};
+
+// Make a report of the action profile sorted by self time
+string CLdsScriptEngine::LdsProfileReport(const int &ctEntries) {
+  return _pfActions.Report(ctEntries);
+};
+
+#ifdef PLATFORM_UNIX
+// Request a sample from the timer signal
+static void SampleSignal(int) {
+  LDS_bSampleSignal = 1;
+};
+#endif
+
+// Start sampling every some amount of actions
+void CLdsSampler::Start(const int &ctActions) {
+  sm_ctRate = ctActions;
+  sm_ctLeft = (ctActions > 0 ? ctActions : INT_MAX);
+};
+
+// Start sampling some amount of times per second of processor time
+bool CLdsSampler::StartTimer(const int &iFrequency) {
+#ifdef PLATFORM_UNIX
+  if (iFrequency <= 0) {
+    return false;
+  }
+
+  struct itimerval tv;
+  tv.it_interval.tv_sec = 0;
+  tv.it_interval.tv_usec = (iFrequency > 1 ? 1000000 / iFrequency : 999999);
+  tv.it_value = tv.it_interval;
+
+  // only change the frequency if already sampling
+  if (sm_bTimer) {
+    return (setitimer(ITIMER_PROF, &tv, NULL) == 0);
+  }
+
+  struct sigaction sa;
+  memset(&sa, 0, sizeof(sa));
+  sa.sa_handler = SampleSignal;
+  sa.sa_flags = SA_RESTART;
+  sigemptyset(&sa.sa_mask);
+
+  // remember what the host has been using to give it back afterwards
+  if (sigaction(SIGPROF, &sa, &sm_saPrev) != 0) {
+    return false;
+  }
+
+  if (setitimer(ITIMER_PROF, &tv, &sm_tvPrev) != 0) {
+    sigaction(SIGPROF, &sm_saPrev, NULL);
+    return false;
+  }
+
+  // only sample by the timer unless asked for both
+  if (sm_ctRate <= 0) {
+    sm_ctLeft = INT_MAX;
+  }
+
+  sm_bTimer = true;
+  return true;
+
+#else
+  return false;
+#endif
+};
+
+// Stop sampling
+void CLdsSampler::Stop(void) {
+#ifdef PLATFORM_UNIX
+  if (sm_bTimer) {
+    // hold the timer signal until the host handler is back
+    sigset_t setProf, setPrev;
+    sigemptyset(&setProf);
+    sigaddset(&setProf, SIGPROF);
+    sigprocmask(SIG_BLOCK, &setProf, &setPrev);
+
+    struct itimerval tv;
+    memset(&tv, 0, sizeof(tv));
+    setitimer(ITIMER_PROF, &tv, NULL);
+
+    // drop the last sampling signal so it doesn't reach the host handler
+    sigset_t setPending;
+    sigpending(&setPending);
+
+    if (sigismember(&setPending, SIGPROF) == 1) {
+      int iSignal;
+      sigwait(&setProf, &iSignal);
+    }
+
+    sigaction(SIGPROF, &sm_saPrev, NULL);
+    setitimer(ITIMER_PROF, &sm_tvPrev, NULL);
+
+    sigprocmask(SIG_SETMASK, &setPrev, NULL);
+  }
+#endif
+
+  sm_bTimer = false;
+  sm_ctRate = 0;
+  sm_ctLeft = 0;
+  LDS_bSampleSignal = 0;
+};
+
+// Remove all samples
+void CLdsSampler::Clear(void) {
+  sm_stStacks.Clear();
+  sm_actSamples.Clear();
+};
+
+// Take a sample of the call stack of a thread at some action position
+void CLdsSampler::Sample(CLdsThread &sth, const int &iPos) {
+  // wait for the next sample
+  sm_ctLeft = (sm_ctRate > 0 ? sm_ctRate : INT_MAX);
+  LDS_bSampleSignal = 0;
+
+  DSStack<SLdsInlineCall> &aicCalls = sth.sth_aicCalls;
+  string strStack = "main";
+
+  // go from the outermost call
+  for (int iCall = 0; iCall < aicCalls.Count(); iCall++) {
+    SLdsInlineCall &ic = aicCalls[iCall];
+
+    // position of the call in the previous frame (threads remember the action after it)
+    CActionList &acaReturn = ic.pgReturn.Actions();
+
+    if (ic.iPos > 0 && ic.iPos <= acaReturn.Count()) {
+      strStack += " (" + LdsPrintPos(acaReturn[ic.iPos - 1].lt_iPos) + ")";
+    }
+
+    strStack += ";" + ic.strFunc;
+  }
+
+  strStack += " (" + LdsPrintPos(iPos) + ")";
+
+  // count the same stack
+  const int iStack = sm_stStacks.Intern(strStack);
+
+  if (iStack >= sm_actSamples.Count()) {
+    sm_actSamples.Add() = 0;
+  }
+
+  sm_actSamples[iStack]++;
+};
+
+// Make a list of samples in the folded format for flame graphs
+string CLdsSampler::Folded(void) {
+  string strFolded = "";
+
+  for (int iStack = 0; iStack < sm_actSamples.Count(); iStack++) {
+    strFolded += LdsPrintF("%s %lld\n", sm_stStacks.Name(iStack).c_str(), sm_actSamples[iStack]);
+  }
+
+  return strFolded;
+};
+
+// Histogram bucket of some latency
+static int HistogramBucket(LONG64 llTicks) {
+  if (llTicks < (1 << LDS_HISTOGRAM_BITS)) {
+    return (llTicks > 0 ? (int)llTicks : 0);
+  }
+
+  // find the highest bit
+  int iBit = LDS_HISTOGRAM_BITS;
+
+  while (iBit < 63 && (llTicks >> (iBit + 1)) != 0) {
+    iBit++;
+  }
+
+  // power of two with the next few bits after it
+  const int iShift = iBit - LDS_HISTOGRAM_BITS;
+  return ((iShift + 1) << LDS_HISTOGRAM_BITS) + int((llTicks >> iShift) & ((1 << LDS_HISTOGRAM_BITS) - 1));
+};
+
+// Lowest latency of some histogram bucket
+static LONG64 HistogramTicks(const int &iBucket) {
+  if (iBucket < (1 << LDS_HISTOGRAM_BITS)) {
+    return iBucket;
+  }
+
+  const int iShift = (iBucket >> LDS_HISTOGRAM_BITS) - 1;
+  return LONG64((iBucket & ((1 << LDS_HISTOGRAM_BITS) - 1)) | (1 << LDS_HISTOGRAM_BITS)) << iShift;
+};
+
+// Reset all statistics
+void SLdsCallStats::Clear(void) {
+  cs_ctCalls = 0;
+  cs_llTotal = 0;
+  cs_llMax = 0;
+
+  memset(cs_actHistogram, 0, sizeof(cs_actHistogram));
+};
+
+// Count one call
+void SLdsCallStats::Record(const LONG64 &llTicks) {
+  cs_ctCalls++;
+  cs_llTotal += llTicks;
+
+  if (llTicks > cs_llMax) {
+    cs_llMax = llTicks;
+  }
+
+  cs_actHistogram[HistogramBucket(llTicks)]++;
+};
+
+// Latency that some percentage of calls doesn't exceed
+LONG64 SLdsCallStats::Percentile(const double &dPercent) const {
+  const LONG64 ctTarget = LONG64(ceil(double(cs_ctCalls) * dPercent / 100.0));
+  LONG64 ctCalls = 0;
+
+  for (int iBucket = 0; iBucket < LDS_HISTOGRAM_SIZE; iBucket++) {
+    ctCalls += cs_actHistogram[iBucket];
+
+    if (ctCalls > 0 && ctCalls >= ctTarget) {
+      return HistogramTicks(iBucket);
+    }
+  }
+
+  return cs_llMax;
+};
+
+// Reset all statistics
+void CLdsCallProfile::Clear(void) {
+  cp_stFuncs.Clear();
+  cp_acsFuncs.Clear();
+
+  cp_llStartTicks = LdsGetTicks();
+  cp_dStartTime = LdsGetTime();
+};
+
+// Statistics of some function
+SLdsCallStats &CLdsCallProfile::Stats(const string &strFunc) {
+  const int iFunc = cp_stFuncs.Intern(strFunc);
+
+  if (iFunc >= cp_acsFuncs.Count()) {
+    cp_acsFuncs.Add();
+  }
+
+  return cp_acsFuncs[iFunc];
+};
+
+// Seconds in one tick
+double CLdsCallProfile::TickTime(void) {
+  return TicksSince(cp_llStartTicks, cp_dStartTime);
+};
+
+// Sort functions by total time from highest to lowest
+static int CompareCallStats(const void *pStats1, const void *pStats2) {
+  const SLdsCallStats *pcs1 = *(const SLdsCallStats **)pStats1;
+  const SLdsCallStats *pcs2 = *(const SLdsCallStats **)pStats2;
+
+  if (pcs1->cs_llTotal != pcs2->cs_llTotal) {
+    return (pcs1->cs_llTotal > pcs2->cs_llTotal ? -1 : 1);
+  }
+
+  return (pcs1 < pcs2 ? -1 : 1);
+};
+
+// Gather called functions sorted by total time
+static void SortCallStats(DSList<SLdsCallStats> &acs, DSList<SLdsCallStats *> &apcs) {
+  for (int iFunc = 0; iFunc < acs.Count(); iFunc++) {
+    if (acs[iFunc].cs_ctCalls > 0) {
+      apcs.Add() = &acs[iFunc];
+    }
+  }
+
+  if (apcs.Count() > 1) {
+    qsort(&apcs[0], apcs.Count(), sizeof(SLdsCallStats *), CompareCallStats);
+  }
+};
+
+// Name of the function with some statistics
+const string &CLdsCallProfile::FuncName(const SLdsCallStats &cs) {
+  int iFunc = 0;
+
+  while (&cp_acsFuncs[iFunc] != &cs) {
+    iFunc++;
+  }
+
+  return cp_stFuncs.Name(iFunc);
+};
+
+// Make a text report sorted by total time
+string CLdsCallProfile::Report(void) {
+  const double dMicro = TickTime() * 1000000.0;
+
+  DSList<SLdsCallStats *> apcs;
+  SortCallStats(cp_acsFuncs, apcs);
+
+  string strReport = LdsPrintF("%-20s %10s %12s %10s %10s %10s %10s %10s\n", "Function", "calls",
+                               "total ms", "avg us", "p50 us", "p90 us", "p99 us", "max us");
+
+  for (int iEntry = 0; iEntry < apcs.Count(); iEntry++) {
+    SLdsCallStats &cs = *apcs[iEntry];
+    const string &strFunc = FuncName(cs);
+
+    strReport += LdsPrintF("%-20s %10lld %12.3f %10.3f %10.3f %10.3f %10.3f %10.3f\n", strFunc.c_str(), cs.cs_ctCalls,
+                           double(cs.cs_llTotal) * dMicro / 1000.0, double(cs.cs_llTotal) * dMicro / double(cs.cs_ctCalls),
+                           double(cs.Percentile(50.0)) * dMicro, double(cs.Percentile(90.0)) * dMicro,
+                           double(cs.Percentile(99.0)) * dMicro, double(cs.cs_llMax) * dMicro);
+  }
+
+  return strReport;
+};
+
+// Make a JSON report sorted by total time
+string CLdsCallProfile::Json(void) {
+  const double dMicro = TickTime() * 1000000.0;
+
+  DSList<SLdsCallStats *> apcs;
+  SortCallStats(cp_acsFuncs, apcs);
+
+  string strJson = "[";
+
+  for (int iEntry = 0; iEntry < apcs.Count(); iEntry++) {
+    SLdsCallStats &cs = *apcs[iEntry];
+    const string &strFunc = FuncName(cs);
+
+    strJson += (iEntry > 0 ? ",\n  " : "\n  ");
+    strJson += LdsPrintF("{\"function\": \"%s\", \"calls\": %lld, \"total_us\": %.3f, \"max_us\": %.3f, "
+                         "\"p50_us\": %.3f, \"p90_us\": %.3f, \"p99_us\": %.3f, \"histogram\": [",
+                         strFunc.c_str(), cs.cs_ctCalls, double(cs.cs_llTotal) * dMicro, double(cs.cs_llMax) * dMicro,
+                         double(cs.Percentile(50.0)) * dMicro, double(cs.Percentile(90.0)) * dMicro, double(cs.Percentile(99.0)) * dMicro);
+
+    // only used buckets as pairs of the lowest latency and amount of calls
+    bool bFirst = true;
+
+    for (int iBucket = 0; iBucket < LDS_HISTOGRAM_SIZE; iBucket++) {
+      if (cs.cs_actHistogram[iBucket] == 0) {
+        continue;
+      }
+
+      strJson += LdsPrintF("%s[%.3f, %lld]", (bFirst ? "" : ", "), double(HistogramTicks(iBucket)) * dMicro, cs.cs_actHistogram[iBucket]);
+      bFirst = false;
+    }
+
+    strJson += "]}";
+  }
+
+  strJson += (apcs.Count() > 0 ? "\n]\n" : "]\n");
+  return strJson;
+};
+
+// Make a report of native function calls
+string CLdsScriptEngine::LdsCallReport(const bool &bJson) {
+  return (bJson ? _cpCalls.Json() : _cpCalls.Report());
+};
@@ -0,0 +1,217 @@
+/* Copyright (c) 2021 Dreamy Cecil
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#pragma once
+
+#include "../Base/LdsBase.h"
+
+#include <signal.h>
+
+#ifdef PLATFORM_UNIX
+  #include <sys/time.h>
+#endif
+
+// Recommended amount of actions between call stack samples
+#define LDS_SAMPLE_ACTIONS 10000
+
+// Set by the sampling timer when it's time for the next sample
+LDS_API extern volatile sig_atomic_t LDS_bSampleSignal;
+
+// Execution statistics of an action type or a script position
+struct SLdsProfileEntry {
+  int pe_iKey; // action type or script position (-1 if unused)
+  LONG64 pe_ctHits; // how many times actions have been executed
+  LONG64 pe_llTicks; // time spent in actions without the ones after them
+
+  // Constructor
+  SLdsProfileEntry(void) : pe_iKey(-1), pe_ctHits(0), pe_llTicks(0) {};
+};
+
+// Action that's being profiled
+struct SLdsProfileMark {
+  int pm_iType; // action type (-1 if none)
+  int pm_iPos; // position in the script
+  LONG64 pm_llStart; // when the action has started
+
+  // Constructor
+  SLdsProfileMark(void) : pm_iType(-1), pm_iPos(0), pm_llStart(0) {};
+};
+
+class CLdsThread;
+
+// Time spent in each action type and script position
+class LDS_API CLdsProfile {
+  public:
+    DSArray<SLdsProfileEntry> pf_apeActions; // entries by action type
+    DSArray<SLdsProfileEntry> pf_apePositions; // hash table of entries by script position
+    int pf_ctPositions; // amount of used position entries
+
+    LONG64 pf_llStartTicks; // ticks when the profiling started
+    double pf_dStartTime; // time when the profiling started
+
+  public:
+    // Constructor
+    CLdsProfile(void) {
+      Clear();
+    };
+
+    // Reset all statistics
+    void Clear(void);
+
+    // Finish the previous action and start the next one (-1 type to only finish)
+    inline void Mark(SLdsProfileMark &pm, const int &iType, const int &iPos) {
+      LONG64 llNow = LdsGetTicks();
+
+      if (pm.pm_iType != -1) {
+        Record(pm.pm_iType, pm.pm_iPos, llNow - pm.pm_llStart);
+      }
+
+      pm.pm_iType = iType;
+      pm.pm_iPos = iPos;
+      pm.pm_llStart = llNow;
+    };
+
+    // Count one executed action
+    void Record(const int &iType, const int &iPos, const LONG64 &llTicks);
+
+    // Seconds in one tick
+    double TickTime(void);
+
+    // Make a report of up to some amount of entries sorted by self time (0 for all of them)
+    string Report(const int &ctEntries);
+
+  private:
+    // Find entry of some position
+    SLdsProfileEntry &PositionEntry(const int &iPos);
+};
+
+// Sampled call stacks of running threads
+class LDS_API CLdsSampler {
+  public:
+    CLdsSymbolTable sm_stStacks; // unique call stacks in the folded format
+    DSList<LONG64> sm_actSamples; // amount of samples of each call stack
+
+    int sm_ctRate; // amount of actions between samples (0 if not sampling by actions)
+    int sm_ctLeft; // actions left until the next sample
+    bool sm_bTimer; // sampling by the timer
+
+  #ifdef PLATFORM_UNIX
+  private:
+    struct sigaction sm_saPrev; // signal handler of the host before sampling by the timer
+    struct itimerval sm_tvPrev; // profiling timer of the host before sampling by the timer
+  #endif
+
+  public:
+    // Constructor
+    CLdsSampler(void) : sm_ctRate(0), sm_ctLeft(0), sm_bTimer(false) {};
+
+    // Destructor
+    ~CLdsSampler(void) {
+      Stop();
+    };
+
+    // Start sampling every some amount of actions
+    void Start(const int &ctActions = LDS_SAMPLE_ACTIONS);
+    // Start sampling some amount of times per second of processor time (returns false if unsupported)
+    bool StartTimer(const int &iFrequency);
+    // Stop sampling
+    void Stop(void);
+
+    // Remove all samples
+    void Clear(void);
+
+    // Check if any sampling is going on
+    inline bool IsActive(void) const {
+      return (sm_ctRate > 0 || sm_bTimer);
+    };
+
+    // Count one action and check if it's time for a sample
+    inline bool Tick(void) {
+      return (--sm_ctLeft <= 0 || LDS_bSampleSignal);
+    };
+
+    // Take a sample of the call stack of a thread at some action position
+    void Sample(CLdsThread &sth, const int &iPos);
+
+    // Make a list of samples in the folded format for flame graphs ("frame;frame;frame count" on each line)
+    string Folded(void);
+};
+
+// Precision of call latency histograms (2^bits buckets for each power of two)
+#define LDS_HISTOGRAM_BITS 3
+
+// Amount of buckets in call latency histograms
+#define LDS_HISTOGRAM_SIZE ((64 - LDS_HISTOGRAM_BITS + 1) << LDS_HISTOGRAM_BITS)
+
+// Statistics of calls of one native function
+struct LDS_API SLdsCallStats {
+  LONG64 cs_ctCalls; // amount of calls
+  LONG64 cs_llTotal; // time spent in all calls
+  LONG64 cs_llMax; // longest call
+  LONG64 cs_actHistogram[LDS_HISTOGRAM_SIZE]; // amount of calls by their log-linear latency bucket
+
+  // Constructor
+  SLdsCallStats(void) {
+    Clear();
+  };
+
+  // Reset all statistics
+  void Clear(void);
+
+  // Count one call
+  void Record(const LONG64 &llTicks);
+
+  // Latency that some percentage of calls doesn't exceed (lowest tick of the bucket)
+  LONG64 Percentile(const double &dPercent) const;
+};
+
+// Time spent in native functions called by scripts
+class LDS_API CLdsCallProfile {
+  public:
+    CLdsSymbolTable cp_stFuncs; // names of called functions
+    DSList<SLdsCallStats> cp_acsFuncs; // statistics by function IDs
+
+    LONG64 cp_llStartTicks; // ticks when the profiling started
+    double cp_dStartTime; // time when the profiling started
+
+  public:
+    // Constructor
+    CLdsCallProfile(void) {
+      Clear();
+    };
+
+    // Reset all statistics
+    void Clear(void);
+
+    // Statistics of some function
+    SLdsCallStats &Stats(const string &strFunc);
+
+    // Seconds in one tick
+    double TickTime(void);
+
+    // Make a text report sorted by total time
+    string Report(void);
+    // Make a JSON report sorted by total time
+    string Json(void);
+
+  private:
+    // Name of the function with some statistics
+    const string &FuncName(const SLdsCallStats &cs);
+};
@@ -21,13 +21,416 @@ SOFTWARE. */
 #include "StdH.h"
 #include "LdsProgram.h"
 
+// Destructor
+SLdsProgramData::~SLdsProgramData(void) {
+  ClearJit();
+
+  LDS_alAllocs.al_acPrograms.Free();
+};
+
+// Delete native code
+void SLdsProgramData::ClearJit(void) {
+  if (pd_pJit != NULL) {
+    delete pd_pJit;
+    pd_pJit = NULL;
+  }
+};
+
+// Actions constructor
+CLdsProgram::CLdsProgram(const CActionList &aca) : pg_pData(NULL) {
+  Modify().CopyArray(aca);
+};
+
+// Copy constructor
+CLdsProgram::CLdsProgram(const CLdsProgram &pgOther) : pg_pData(pgOther.pg_pData) {
+  if (pg_pData != NULL) {
+    pg_pData->pd_ctRefs++;
+  }
+};
+
+// Destructor
+CLdsProgram::~CLdsProgram(void) {
+  Clear();
+};
+
 // Clear the program
 void CLdsProgram::Clear(void) {
-  acaProgram.Clear();
+  if (pg_pData == NULL) {
+    return;
+  }
+
+  // delete actions if nothing else uses them
+  if (--pg_pData->pd_ctRefs <= 0) {
+    delete pg_pData;
+  }
+
+  pg_pData = NULL;
 };
 
 // Assignment
 CLdsProgram &CLdsProgram::operator=(const CLdsProgram &pgOther) {
-  acaProgram.CopyArray(pgOther.acaProgram);
+  // same actions
+  if (pg_pData == pgOther.pg_pData) {
+    return *this;
+  }
+
+  Clear();
+
+  pg_pData = pgOther.pg_pData;
+
+  if (pg_pData != NULL) {
+    pg_pData->pd_ctRefs++;
+  }
+
   return *this;
 };
+
+// Actions that may be shared with other programs
+CActionList &CLdsProgram::Actions(void) {
+  if (pg_pData == NULL) {
+    pg_pData = new SLdsProgramData;
+  }
+
+  return pg_pData->pd_acaActions;
+};
+
+// Native code made from the actions
+SLdsJitData *&CLdsProgram::Jit(void) {
+  if (pg_pData == NULL) {
+    pg_pData = new SLdsProgramData;
+  }
+
+  return pg_pData->pd_pJit;
+};
+
+// Approximate memory used by the actions
+LdsSize CLdsProgram::MemoryUsage(void) const {
+  if (pg_pData == NULL) {
+    return 0;
+  }
+
+  // counted once for shared actions
+  if (pg_pData->pd_iMemory > 0) {
+    return pg_pData->pd_iMemory;
+  }
+
+  CActionList &aca = pg_pData->pd_acaActions;
+  LdsSize iSize = sizeof(SLdsProgramData);
+
+  for (int iAction = 0; iAction < aca.Count(); iAction++) {
+    // value shell is a part of the action
+    iSize += sizeof(CCompAction) + aca[iAction].lt_valValue->MemoryUsage();
+  }
+
+  pg_pData->pd_iMemory = iSize;
+  return iSize;
+};
+
+// Actions that can be changed without affecting other programs
+CActionList &CLdsProgram::Modify(void) {
+  if (pg_pData == NULL) {
+    pg_pData = new SLdsProgramData;
+
+  // make a unique copy (jump tables are rebuilt on first use)
+  } else if (pg_pData->pd_ctRefs > 1) {
+    SLdsProgramData *pData = new SLdsProgramData;
+    pData->pd_acaActions.CopyArray(pg_pData->pd_acaActions);
+
+    pg_pData->pd_ctRefs--;
+    pg_pData = pData;
+  }
+
+  // actions may change
+  pg_pData->pd_ctMaxStack = -1;
+  pg_pData->pd_iMemory = 0;
+  pg_pData->pd_bVerified = false;
+  pg_pData->ClearJit();
+
+  return pg_pData->pd_acaActions;
+};
+
+// Values taken from the stack and put onto it by an action
+bool LdsActionStack(const CCompAction &ca, int &ctPop, int &ctPush) {
+  ctPop = 0;
+  ctPush = 0;
+
+  switch (ca.lt_eType) {
+    case LCA_VAL:
+      ctPush = 1;
+
+      // single value
+      if (ca.lt_iArg < 0) {
+        return true;
+      }
+
+      // array entries or object properties (value, constant and name)
+      if (ca.lt_valValue->GetType() != EVT_INDEX) {
+        return false;
+      }
+
+      ctPop = (ca.lt_valValue->GetIndex() == 0 ? ca.lt_iArg : ca.lt_iArg * 3);
+      return true;
+
+    case LCA_UN: ctPop = 1; ctPush = 1; return true;
+
+    case LCA_BIN:
+    case LCA_BIN_NUM: ctPop = 2; ctPush = 1; return true;
+
+    case LCA_CALL:
+    case LCA_INLINE:
+    case LCA_TAILCALL:
+      ctPop = ca.lt_iArg;
+      ctPush = 1;
+      return (ctPop >= 0);
+
+    case LCA_FUNC: case LCA_VAR: case LCA_DIR:
+    case LCA_JUMP: case LCA_RETURN: return true;
+
+    case LCA_SET: case LCA_DISCARD: ctPop = 1; return true;
+    case LCA_GET: ctPush = 1; return true;
+    case LCA_SET_ACCESS: ctPop = 2; return true;
+    case LCA_DUP: ctPop = 1; ctPush = 2; return true;
+
+    case LCA_JUMPIF: case LCA_JUMPUNLESS: ctPop = 1; return true;
+
+    // value gets discarded unless jumping
+    case LCA_AND: case LCA_OR: ctPop = 1; return true;
+
+    // case value gets discarded and the desired value stays unless jumping
+    case LCA_SWITCH: ctPop = 2; ctPush = 1; return true;
+
+    // desired value stays unless jumping
+    case LCA_SWITCH_TABLE: ctPop = 1; ctPush = 1; return true;
+  }
+
+  return false;
+};
+
+// Check stack depth at the next position
+static void MergeStackDepth(DSArray<int> &aiDepth, DSStack<int> &aiPending, const int &iPos, const int &iDepth, const int &iFrom) {
+  // jumping outside the program
+  if (iPos < 0 || iPos > aiDepth.Count() - 1) {
+    LdsThrow(LEX_ACTION, "Action at %d jumps out of bounds to %d", iFrom, iPos);
+  }
+
+  // first time at this position
+  if (aiDepth[iPos] == -1) {
+    aiDepth[iPos] = iDepth;
+    aiPending.Push(iPos);
+    return;
+  }
+
+  // different paths should leave the same amount of values
+  if (aiDepth[iPos] != iDepth) {
+    LdsThrow(LEX_ACTION, "Inconsistent stack depth at %d (%d or %d values)", iPos, aiDepth[iPos], iDepth);
+  }
+};
+
+// Count maximum amount of values on the stack and the stack depth before each action and at the very end (-1 if not reached)
+static int CountMaxStack(CActionList &aca, DSArray<int> &aiDepth) {
+  const int ctActions = aca.Count();
+  aiDepth.New(ctActions + 1);
+
+  for (int iInit = 0; iInit <= ctActions; iInit++) {
+    aiDepth[iInit] = -1;
+  }
+
+  DSStack<int> aiPending;
+  int ctMax = 0;
+
+  MergeStackDepth(aiDepth, aiPending, 0, 0, 0);
+
+  while (aiPending.Count() > 0) {
+    const int iPos = aiPending.Pop();
+
+    // reached the end
+    if (iPos >= ctActions) {
+      continue;
+    }
+
+    CCompAction &ca = aca[iPos];
+    const int iDepth = aiDepth[iPos];
+
+    int ctPop, ctPush;
+
+    if (!LdsActionStack(ca, ctPop, ctPush)) {
+      LdsThrow(LEX_ACTION, "Invalid action %d at %d", ca.lt_eType, iPos);
+    }
+
+    // not enough values
+    if (iDepth < ctPop) {
+      LdsThrow(LEX_ACTION, "Stack underflow of %s at %d (%d out of %d values)", _astrActionNames[ca.lt_eType], iPos, iDepth, ctPop);
+    }
+
+    const int iNextDepth = iDepth - ctPop + ctPush;
+
+    if (iNextDepth > ctMax) {
+      ctMax = iNextDepth;
+    }
+
+    switch (ca.lt_eType) {
+      case LCA_JUMP:
+        MergeStackDepth(aiDepth, aiPending, ca.lt_iArg, iDepth, iPos);
+        continue;
+
+      case LCA_RETURN:
+        continue;
+
+      case LCA_JUMPIF: case LCA_JUMPUNLESS:
+        MergeStackDepth(aiDepth, aiPending, ca.lt_iArg, iDepth - 1, iPos);
+        break;
+
+      // value stays when jumping
+      case LCA_AND: case LCA_OR:
+        MergeStackDepth(aiDepth, aiPending, ca.lt_iArg, iDepth, iPos);
+        break;
+
+      // both values are discarded when jumping
+      case LCA_SWITCH:
+        MergeStackDepth(aiDepth, aiPending, ca.lt_iArg, iDepth - 2, iPos);
+        break;
+
+      // skips to discarding the desired value if there's no match
+      case LCA_SWITCH_TABLE:
+        MergeStackDepth(aiDepth, aiPending, iPos + 1 + ca.lt_iArg * 2, iDepth, iPos);
+        break;
+    }
+
+    MergeStackDepth(aiDepth, aiPending, iPos + 1, iNextDepth, iPos);
+  }
+
+  return ctMax;
+};
+
+// Maximum amount of values on the stack during execution
+int CLdsProgram::MaxStack(void) {
+  if (pg_pData == NULL) {
+    return 0;
+  }
+
+  if (pg_pData->pd_ctMaxStack == -1) {
+    DSArray<int> aiDepth;
+    pg_pData->pd_ctMaxStack = CountMaxStack(pg_pData->pd_acaActions, aiDepth);
+  }
+
+  return pg_pData->pd_ctMaxStack;
+};
+
+// Amount of values on the stack before some action
+int CLdsProgram::StackDepth(const int &iPos) {
+  if (pg_pData == NULL) {
+    return (iPos == 0 ? 0 : -1);
+  }
+
+  DSArray<int> aiDepth;
+  CountMaxStack(pg_pData->pd_acaActions, aiDepth);
+
+  if (iPos < 0 || iPos >= aiDepth.Count()) {
+    return -1;
+  }
+
+  return aiDepth[iPos];
+};
+
+// Gather inline functions defined by the actions and their inline functions
+static void GatherInlineDefs(CActionList &aca, DSMap<string, int> &mapDefs) {
+  for (int iAction = 0; iAction < aca.Count(); iAction++) {
+    CCompAction &ca = aca[iAction];
+
+    if (ca.lt_eType != LCA_FUNC || ca.lt_valValue->GetType() != EVT_STRING) {
+      continue;
+    }
+
+    SLdsInlineFunc &in = ca.ca_inFunc;
+    string strFunc = ca.lt_valValue->GetString();
+
+    if (mapDefs.FindKeyIndex(strFunc) == -1) {
+      mapDefs.Add(strFunc) = in.in_astrArgs.Count();
+    }
+
+    GatherInlineDefs(in.in_pgFunc.Actions(), mapDefs);
+  }
+};
+
+// Verify actions of one program
+static void VerifyActions(CLdsProgram &pg, DSMap<string, int> &mapDefs) {
+  CActionList &aca = pg.Actions();
+  const int ctActions = aca.Count();
+
+  for (int iAction = 0; iAction < ctActions; iAction++) {
+    CCompAction &ca = aca[iAction];
+    const int iType = ca.lt_eType;
+
+    if (iType <= LCA_UNKNOWN || iType >= LCA_SIZEOF) {
+      LdsThrow(LEX_ACTION, "Invalid action type %d at %d", iType, iAction);
+    }
+
+    switch (iType) {
+      // named actions
+      case LCA_CALL: case LCA_INLINE: case LCA_TAILCALL: case LCA_FUNC:
+      case LCA_VAR: case LCA_SET: case LCA_GET:
+        if (ca.lt_valValue->GetType() != EVT_STRING) {
+          LdsThrow(LEX_ACTION, "Action %s at %d has no name", _astrActionNames[iType], iAction);
+        }
+        break;
+
+      // operation for the fallback and numbers of known types
+      case LCA_BIN_NUM:
+        if (ca.lt_iArg < 0 || LDS_BIN_NUM_OP(ca.lt_iArg) >= LOP_COUNT) {
+          LdsThrow(LEX_ACTION, "Action %s at %d has invalid operation", _astrActionNames[iType], iAction);
+        }
+        break;
+
+      // jumps within the same program
+      case LCA_JUMP: case LCA_JUMPIF: case LCA_JUMPUNLESS:
+      case LCA_AND: case LCA_OR: case LCA_SWITCH:
+        if (ca.lt_iArg < 0 || ca.lt_iArg > ctActions) {
+          LdsThrow(LEX_ACTION, "Action %s at %d jumps out of bounds", _astrActionNames[iType], iAction);
+        }
+        break;
+
+      // cases after the table
+      case LCA_SWITCH_TABLE:
+        if (ca.lt_iArg <= 0 || ca.lt_iArg > (ctActions - iAction - 2) / 2) {
+          LdsThrow(LEX_ACTION, "Action %s at %d has invalid amount of cases", _astrActionNames[iType], iAction);
+        }
+        break;
+    }
+
+    // calls of inline functions defined within the program
+    if (iType == LCA_INLINE || iType == LCA_TAILCALL) {
+      int iDef = mapDefs.FindKeyIndex(ca.lt_valValue->GetString());
+
+      if (iDef != -1 && mapDefs.GetValue(iDef) != ca.lt_iArg) {
+        LdsThrow(LEX_ACTION, "Action %s at %d passes %d arguments instead of %d", _astrActionNames[iType], iAction, ca.lt_iArg, mapDefs.GetValue(iDef));
+      }
+
+    // function bodies (checked again in case they call functions from this program)
+    } else if (iType == LCA_FUNC) {
+      CLdsProgram &pgFunc = ca.ca_inFunc.in_pgFunc;
+
+      try {
+        VerifyActions(pgFunc, mapDefs);
+
+      } catch (SLdsError leError) {
+        LdsThrow(LEX_ACTION, "Inline function '%s' at %d: %s", ca.lt_valValue->GetString().c_str(), iAction, leError.le_strMessage.c_str());
+      }
+    }
+  }
+
+  // check every path through the actions
+  pg.MaxStack();
+  pg.SetVerified();
+};
+
+// Verify actions of the program and its inline functions
+void CLdsProgram::Verify(void) {
+  if (IsVerified()) {
+    return;
+  }
+
+  DSMap<string, int> mapDefs;
+  GatherInlineDefs(Actions(), mapDefs);
+
+  VerifyActions(*this, mapDefs);
+};
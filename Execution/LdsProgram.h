@@ -21,24 +21,101 @@ SOFTWARE. */
 #pragma once
 
 #include "../Base/LdsTypes.h"
+#include "LdsJit.h"
+
+// Compiled actions shared between program copies
+struct SLdsProgramData {
+  CActionList pd_acaActions; // compiled actions
+  int pd_ctRefs; // amount of programs using these actions
+  int pd_ctMaxStack; // maximum amount of values on the stack (counted during verification, -1 if not counted yet)
+  LdsSize pd_iMemory; // approximate memory used by the actions (0 if not counted yet)
+  bool pd_bVerified; // actions are safe to run without extra checks
+  SLdsJitData *pd_pJit; // native code made from the actions (NULL if none)
+
+  // Constructor
+  SLdsProgramData(void) : pd_ctRefs(1), pd_ctMaxStack(-1), pd_iMemory(0), pd_bVerified(false), pd_pJit(NULL) {
+    LDS_alAllocs.al_acPrograms.Alloc();
+  };
+
+  // Destructor
+  ~SLdsProgramData(void);
+
+  // Delete native code
+  void ClearJit(void);
+};
 
 // Compiled script program
 class LDS_API CLdsProgram {
-  public:
-    CActionList acaProgram; // compiled actions
+  private:
+    SLdsProgramData *pg_pData; // shared actions (NULL if empty)
 
   public:
     // Default constructor
-    inline CLdsProgram(void) {};
+    inline CLdsProgram(void) : pg_pData(NULL) {};
 
     // Actions constructor
-    inline CLdsProgram(const CActionList &aca) {
-      acaProgram.CopyArray(aca);
-    };
+    CLdsProgram(const CActionList &aca);
+
+    // Copy constructor (shares the actions)
+    CLdsProgram(const CLdsProgram &pgOther);
+
+    // Destructor
+    ~CLdsProgram(void);
 
     // Clear the program
     void Clear(void);
 
-    // Assignment
+    // Assignment (shares the actions)
     CLdsProgram &operator=(const CLdsProgram &pgOther);
+
+    // Actions that may be shared with other programs (shouldn't be changed)
+    CActionList &Actions(void);
+
+    // Actions that can be changed without affecting other programs
+    CActionList &Modify(void);
+
+    // Amount of actions
+    inline int Count(void) const {
+      return (pg_pData != NULL ? pg_pData->pd_acaActions.Count() : 0);
+    };
+
+    // Maximum amount of values on the stack during execution (throws LEX_ACTION if the program is malformed)
+    int MaxStack(void);
+
+    // Amount of values on the stack before some action (-1 if it's never reached, throws LEX_ACTION if the program is malformed)
+    int StackDepth(const int &iPos);
+
+    // Verify actions of the program and its inline functions (throws LEX_ACTION if the program is malformed)
+    void Verify(void);
+
+    // Check if the program has been verified since the last change
+    inline bool IsVerified(void) const {
+      return (pg_pData != NULL && pg_pData->pd_bVerified);
+    };
+
+    // Native code made from the actions (NULL if none)
+    SLdsJitData *&Jit(void);
+
+    // Approximate memory used by the actions in bytes
+    LdsSize MemoryUsage(void) const;
+
+    // Mark actions as verified
+    inline void SetVerified(void) {
+      if (pg_pData != NULL) {
+        pg_pData->pd_bVerified = true;
+      }
+    };
+
+    // Check if both programs use the same actions
+    inline bool SharesWith(const CLdsProgram &pgOther) const {
+      return (pg_pData != NULL && pg_pData == pgOther.pg_pData);
+    };
+
+    // Shared actions that identify the program (NULL if empty)
+    inline const SLdsProgramData *SharedData(void) const {
+      return pg_pData;
+    };
 };
+
+// Values taken from the stack and put onto it by an action (returns false if the action is invalid)
+LDS_API bool LdsActionStack(const CCompAction &ca, int &ctPop, int &ctPush);
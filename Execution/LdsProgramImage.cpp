@@ -0,0 +1,689 @@
+/* Copyright (c) 2021 Dreamy Cecil
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#include "StdH.h"
+#include "LdsProgramImage.h"
+
+#include <string.h>
+
+#ifdef PLATFORM_UNIX
+  #include <fcntl.h>
+  #include <unistd.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+#else
+  #include <windows.h>
+#endif
+
+// Release the image data
+void CLdsProgramImage::Clear(void) {
+  // unmap the file
+  if (pi_pMapped != NULL) {
+  #ifdef PLATFORM_UNIX
+    munmap(pi_pMapped, pi_iSize);
+  #else
+    UnmapViewOfFile(pi_pMapped);
+    CloseHandle((HANDLE)pi_pMapHandle);
+  #endif
+  }
+
+  // delete owned copy
+  if (pi_pOwned != NULL) {
+    delete[] pi_pOwned;
+  }
+
+  pi_pData = NULL;
+  pi_iSize = 0;
+  pi_bValid = false;
+
+  pi_pOwned = NULL;
+  pi_pMapped = NULL;
+  pi_pMapHandle = NULL;
+};
+
+// Use image from memory
+void CLdsProgramImage::FromMemory(const void *pData, const int &iSize, bool bCopy) {
+  Clear();
+
+  // use the data directly
+  if (!bCopy) {
+    pi_pData = (const char *)pData;
+    pi_iSize = iSize;
+    return;
+  }
+
+  char *pCopy = new char[iSize];
+  memcpy(pCopy, pData, iSize);
+
+  TakeBuffer(pCopy, iSize);
+};
+
+// Take ownership of a buffer
+void CLdsProgramImage::TakeBuffer(char *pBuffer, const int &iSize) {
+  Clear();
+
+  pi_pOwned = pBuffer;
+  pi_pData = pBuffer;
+  pi_iSize = iSize;
+};
+
+// Map image file into memory
+bool CLdsProgramImage::MapFile(const char *strFile) {
+  Clear();
+
+#ifdef PLATFORM_UNIX
+  int iFile = open(strFile, O_RDONLY);
+
+  if (iFile == -1) {
+    return false;
+  }
+
+  struct stat stFile;
+
+  if (fstat(iFile, &stFile) != 0 || stFile.st_size <= 0) {
+    close(iFile);
+    return false;
+  }
+
+  void *pView = mmap(NULL, stFile.st_size, PROT_READ, MAP_PRIVATE, iFile, 0);
+
+  // the mapping stays valid after closing the descriptor
+  close(iFile);
+
+  if (pView == MAP_FAILED) {
+    return false;
+  }
+
+  pi_iSize = (int)stFile.st_size;
+
+#else
+  HANDLE hFile = CreateFileA(strFile, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+
+  if (hFile == INVALID_HANDLE_VALUE) {
+    return false;
+  }
+
+  DWORD ulSize = GetFileSize(hFile, NULL);
+  HANDLE hMapping = NULL;
+
+  if (ulSize != INVALID_FILE_SIZE && ulSize > 0) {
+    hMapping = CreateFileMappingA(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+  }
+
+  // the mapping stays valid after closing the file
+  CloseHandle(hFile);
+
+  if (hMapping == NULL) {
+    return false;
+  }
+
+  void *pView = MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+
+  if (pView == NULL) {
+    CloseHandle(hMapping);
+    return false;
+  }
+
+  pi_pMapHandle = hMapping;
+  pi_iSize = (int)ulSize;
+#endif
+
+  pi_pMapped = pView;
+  pi_pData = (const char *)pView;
+
+  return true;
+};
+
+// Check if some range fits within the limit
+static inline bool ImageRange(const int &iStart, const int &ctCount, const LONG64 &llLimit) {
+  return (iStart >= 0 && ctCount >= 0 && (LONG64)iStart + (LONG64)ctCount <= llLimit);
+};
+
+// Check if some table fits within the image
+static inline bool ImageTable(const SLdsImageTable &tbl, const int &iRecordSize, const int &iAlign, const int &iImageSize) {
+  if (tbl.it_iOffset < (int)sizeof(SLdsImageHeader) || tbl.it_ctCount < 0 || tbl.it_iOffset % iAlign != 0) {
+    return false;
+  }
+
+  return ((LONG64)tbl.it_iOffset + (LONG64)tbl.it_ctCount * iRecordSize <= iImageSize);
+};
+
+// Check image integrity
+void CLdsProgramImage::Validate(void) {
+  pi_bValid = false;
+
+  if (pi_pData == NULL || pi_iSize < (int)sizeof(SLdsImageHeader)) {
+    LdsThrow(LER_READ, "Program image is too small (%d bytes)", pi_iSize);
+  }
+
+  const SLdsImageHeader &ih = Header();
+
+  if (memcmp(ih.ih_aMagic, LDS_IMAGE_MAGIC, 4) != 0) {
+    LdsThrow(LER_READ, "Invalid program image signature");
+  }
+
+  if (ih.ih_iVersion != LDS_IMAGE_VERSION) {
+    LdsThrow(LER_READ, "Unsupported program image version %d (expected %d)", ih.ih_iVersion, LDS_IMAGE_VERSION);
+  }
+
+  if (ih.ih_iSize != pi_iSize) {
+    LdsThrow(LER_READ, "Program image size mismatch (%d instead of %d)", pi_iSize, ih.ih_iSize);
+  }
+
+  // check tables
+  if (!ImageTable(ih.ih_tblActions, sizeof(SLdsImageAction), 4, pi_iSize)
+   || !ImageTable(ih.ih_tblConsts, sizeof(SLdsImageConst), 8, pi_iSize)
+   || !ImageTable(ih.ih_tblFuncs, sizeof(SLdsImageFunc), 4, pi_iSize)
+   || !ImageTable(ih.ih_tblArgs, sizeof(SLdsImageString), 4, pi_iSize)
+   || !ImageTable(ih.ih_tblStrings, sizeof(char), 1, pi_iSize)) {
+    LdsThrow(LER_READ, "Program image table is out of bounds");
+  }
+
+  const int ctStrings = ih.ih_tblStrings.it_ctCount;
+
+  // check constants
+  const SLdsImageConst *aic = Consts();
+
+  for (int iConst = 0; iConst < ih.ih_tblConsts.it_ctCount; iConst++) {
+    const SLdsImageConst &ic = aic[iConst];
+
+    switch (ic.ic_iType) {
+      case EVT_INDEX: case EVT_FLOAT: break;
+
+      case EVT_STRING:
+        if (!ImageRange(ic.ic_iString, ic.ic_ctChars, ctStrings)) {
+          LdsThrow(LER_READ, "Program image constant %d is out of bounds", iConst);
+        }
+        break;
+
+      default: LdsThrow(LER_READ, "Invalid type %d of program image constant %d", ic.ic_iType, iConst);
+    }
+  }
+
+  // check arguments
+  const SLdsImageString *ais = Args();
+
+  for (int iArg = 0; iArg < ih.ih_tblArgs.it_ctCount; iArg++) {
+    if (!ImageRange(ais[iArg].is_iOffset, ais[iArg].is_ctChars, ctStrings)) {
+      LdsThrow(LER_READ, "Program image argument %d is out of bounds", iArg);
+    }
+  }
+
+  // check functions
+  const int ctFuncs = ih.ih_tblFuncs.it_ctCount;
+  const SLdsImageFunc *aif = Funcs();
+
+  // how many times each function is referenced
+  DSArray<int> aiRefs;
+  aiRefs.New(ctFuncs);
+
+  for (int iRef = 0; iRef < ctFuncs; iRef++) {
+    aiRefs[iRef] = 0;
+  }
+
+  for (int iFunc = 0; iFunc < ctFuncs; iFunc++) {
+    const SLdsImageFunc &inf = aif[iFunc];
+
+    if (!ImageRange(inf.if_strName.is_iOffset, inf.if_strName.is_ctChars, ctStrings)
+     || !ImageRange(inf.if_iArgs, inf.if_ctArgs, ih.ih_tblArgs.it_ctCount)
+     || !ImageRange(inf.if_iActions, inf.if_ctActions, ih.ih_tblActions.it_ctCount)) {
+      LdsThrow(LER_READ, "Program image function %d is out of bounds", iFunc);
+    }
+
+    // children can only come after the parent
+    if (inf.if_ctChildren > 0) {
+      if (inf.if_iChildren <= iFunc || !ImageRange(inf.if_iChildren, inf.if_ctChildren, ctFuncs)) {
+        LdsThrow(LER_READ, "Program image function %d has invalid children", iFunc);
+      }
+
+      for (int iChild = 0; iChild < inf.if_ctChildren; iChild++) {
+        aiRefs[inf.if_iChildren + iChild]++;
+      }
+    }
+  }
+
+  // check programs
+  if (!ImageRange(0, ih.ih_ctMain, ih.ih_tblActions.it_ctCount)) {
+    LdsThrow(LER_READ, "Program image main program is out of bounds");
+  }
+
+  ValidateProgram(0, ih.ih_ctMain, -1, aiRefs);
+
+  for (int iFunc = 0; iFunc < ctFuncs; iFunc++) {
+    ValidateProgram(aif[iFunc].if_iActions, aif[iFunc].if_ctActions, iFunc, aiRefs);
+  }
+
+  // each function should be expanded exactly once
+  for (int iFunc = 0; iFunc < ctFuncs; iFunc++) {
+    if (aiRefs[iFunc] != 1) {
+      LdsThrow(LER_READ, "Program image function %d is referenced %d times", iFunc, aiRefs[iFunc]);
+    }
+  }
+
+  pi_bValid = true;
+};
+
+// Check one program within the image
+void CLdsProgramImage::ValidateProgram(const int &iFirst, const int &ctActions, const int &iOwner, DSArray<int> &aiRefs) {
+  const SLdsImageHeader &ih = Header();
+  const SLdsImageAction *aia = Actions() + iFirst;
+  const SLdsImageConst *aic = Consts();
+
+  const int ctConsts = ih.ih_tblConsts.it_ctCount;
+  const int ctFuncs = ih.ih_tblFuncs.it_ctCount;
+
+  for (int iAction = 0; iAction < ctActions; iAction++) {
+    const SLdsImageAction &ia = aia[iAction];
+    const int iType = ia.ia_iType;
+
+    if (iType <= LCA_UNKNOWN || iType >= LCA_SIZEOF) {
+      LdsThrow(LER_READ, "Invalid program image action type %d at %d", iType, iFirst + iAction);
+    }
+
+    if (ia.ia_iConst < -1 || ia.ia_iConst >= ctConsts) {
+      LdsThrow(LER_READ, "Invalid constant of program image action %s at %d", _astrActionNames[iType], iFirst + iAction);
+    }
+
+    switch (iType) {
+      // named actions
+      case LCA_CALL: case LCA_INLINE: case LCA_TAILCALL: case LCA_FUNC:
+      case LCA_VAR: case LCA_SET: case LCA_GET:
+        if (ia.ia_iConst == -1 || aic[ia.ia_iConst].ic_iType != EVT_STRING) {
+          LdsThrow(LER_READ, "Program image action %s at %d has no name", _astrActionNames[iType], iFirst + iAction);
+        }
+        break;
+
+      // valued actions
+      case LCA_VAL: case LCA_UN: case LCA_BIN: case LCA_DIR:
+        if (ia.ia_iConst == -1) {
+          LdsThrow(LER_READ, "Program image action %s at %d has no value", _astrActionNames[iType], iFirst + iAction);
+        }
+        break;
+
+      // operation for the fallback and numbers of known types
+      case LCA_BIN_NUM:
+        if (ia.ia_iConst == -1 || ia.ia_iArg < 0 || LDS_BIN_NUM_OP(ia.ia_iArg) >= LOP_COUNT) {
+          LdsThrow(LER_READ, "Program image action %s at %d has invalid operation", _astrActionNames[iType], iFirst + iAction);
+        }
+        break;
+
+      // jumps within the same program
+      case LCA_JUMP: case LCA_JUMPIF: case LCA_JUMPUNLESS:
+      case LCA_AND: case LCA_OR: case LCA_SWITCH:
+        if (ia.ia_iArg < 0 || ia.ia_iArg > ctActions) {
+          LdsThrow(LER_READ, "Program image action %s at %d jumps out of bounds", _astrActionNames[iType], iFirst + iAction);
+        }
+        break;
+
+      // cases after the table
+      case LCA_SWITCH_TABLE:
+        if (ia.ia_iArg <= 0 || ia.ia_iArg > (ctActions - iAction - 2) / 2) {
+          LdsThrow(LER_READ, "Program image action %s at %d has invalid amount of cases", _astrActionNames[iType], iFirst + iAction);
+        }
+        break;
+    }
+
+    // inline function definitions
+    if (iType == LCA_FUNC) {
+      // functions can only be defined after their owner
+      if (ia.ia_iFunc <= iOwner || ia.ia_iFunc >= ctFuncs) {
+        LdsThrow(LER_READ, "Program image action %s at %d has invalid function %d", _astrActionNames[iType], iFirst + iAction, ia.ia_iFunc);
+      }
+
+      aiRefs[ia.ia_iFunc]++;
+
+    } else if (ia.ia_iFunc != -1) {
+      LdsThrow(LER_READ, "Program image action %s at %d cannot define a function", _astrActionNames[iType], iFirst + iAction);
+    }
+  }
+};
+
+// Program image writer
+class CLdsImageWriter {
+  public:
+    DSList<SLdsImageAction> iw_aActions;
+    DSList<SLdsImageConst> iw_aConsts;
+    DSList<SLdsImageFunc> iw_aFuncs;
+    DSList<SLdsImageString> iw_aArgs;
+    string iw_strStrings;
+
+    DSMap<string, int> iw_mapConsts; // constant indices by their key
+    DSMap<string, int> iw_mapStrings; // string offsets by their contents
+    DSList<SLdsInlineFunc *> iw_apinFuncs; // functions of each record
+
+  public:
+    // Add string to the string table
+    SLdsImageString AddString(const string &str) {
+      SLdsImageString is;
+      is.is_ctChars = str.size();
+
+      int iString = iw_mapStrings.FindKeyIndex(str);
+
+      if (iString != -1) {
+        is.is_iOffset = iw_mapStrings.GetValue(iString);
+        return is;
+      }
+
+      is.is_iOffset = iw_strStrings.size();
+      iw_mapStrings.Add(str, is.is_iOffset);
+
+      // null-terminated for convenience
+      iw_strStrings += str;
+      iw_strStrings += '\0';
+
+      return is;
+    };
+
+    // Add value to the constant pool
+    int AddConst(CLdsValue &val, const int &iPos) {
+      SLdsImageConst ic;
+      memset(&ic, 0, sizeof(ic));
+      ic.ic_iType = val->GetType();
+
+      string strKey = "";
+
+      switch (ic.ic_iType) {
+        case EVT_INDEX:
+          ic.ic_iValue = val->GetIndex();
+          strKey = "i" + string((const char *)&ic.ic_iValue, sizeof(int));
+          break;
+
+        case EVT_FLOAT:
+          ic.ic_dValue = val->GetNumber();
+          strKey = "f" + string((const char *)&ic.ic_dValue, sizeof(double));
+          break;
+
+        case EVT_STRING:
+          strKey = "s" + val->GetString();
+          break;
+
+        default: LdsThrow(LER_WRITE, "Cannot write %s constant into a program image at %s", val->TypeName().c_str(), LdsPrintPos(iPos).c_str());
+      }
+
+      int iConst = iw_mapConsts.FindKeyIndex(strKey);
+
+      if (iConst != -1) {
+        return iw_mapConsts.GetValue(iConst);
+      }
+
+      if (ic.ic_iType == EVT_STRING) {
+        SLdsImageString is = AddString(val->GetString());
+        ic.ic_iString = is.is_iOffset;
+        ic.ic_ctChars = is.is_ctChars;
+      }
+
+      iConst = iw_aConsts.Count();
+      iw_aConsts.Add() = ic;
+      iw_mapConsts.Add(strKey, iConst);
+
+      return iConst;
+    };
+
+    // Add function record (filled in later)
+    int AddFunc(SLdsInlineFunc &in, const string &strName) {
+      SLdsImageFunc inf;
+      memset(&inf, 0, sizeof(inf));
+      inf.if_strName = AddString(strName);
+
+      int iFunc = iw_aFuncs.Count();
+      iw_aFuncs.Add() = inf;
+      iw_apinFuncs.Add() = &in;
+
+      return iFunc;
+    };
+
+    // Add program actions
+    void AddProgram(CLdsProgram &pg) {
+      CActionList &aca = pg.Actions();
+      const int ctActions = aca.Count();
+
+      for (int iAction = 0; iAction < ctActions; iAction++) {
+        CCompAction &ca = aca[iAction];
+
+        SLdsImageAction ia;
+        ia.ia_iType = ca.lt_eType;
+        ia.ia_iPos = ca.lt_iPos;
+        ia.ia_iArg = ca.lt_iArg;
+        ia.ia_iConst = AddConst(ca.lt_valValue, ca.lt_iPos);
+        ia.ia_iFunc = -1;
+
+        if (ca.lt_eType == LCA_FUNC) {
+          ia.ia_iFunc = AddFunc(ca.ca_inFunc, ca->GetString());
+        }
+
+        iw_aActions.Add() = ia;
+      }
+    };
+
+    // Build the whole image
+    void Build(CLdsProgram &pg) {
+      AddProgram(pg);
+
+      // records are added while going through them
+      for (int iFunc = 0; iFunc < iw_aFuncs.Count(); iFunc++) {
+        SLdsInlineFunc &in = *iw_apinFuncs[iFunc];
+
+        // arguments
+        const int iArgs = iw_aArgs.Count();
+        const int ctArgs = in.in_astrArgs.Count();
+
+        for (int iArg = 0; iArg < ctArgs; iArg++) {
+          iw_aArgs.Add() = AddString(in.in_astrArgs[iArg]);
+        }
+
+        // actions
+        const int iActions = iw_aActions.Count();
+        AddProgram(in.in_pgFunc);
+
+        // children right after the last added record
+        const int iChildren = iw_aFuncs.Count();
+        const int ctChildren = in.in_mapInlineFunc.Count();
+
+        for (int iChild = 0; iChild < ctChildren; iChild++) {
+          AddFunc(in.in_mapInlineFunc.GetValue(iChild), in.in_mapInlineFunc.GetKey(iChild));
+        }
+
+        SLdsImageFunc &inf = iw_aFuncs[iFunc];
+        inf.if_iArgs = iArgs;
+        inf.if_ctArgs = ctArgs;
+        inf.if_iActions = iActions;
+        inf.if_ctActions = iw_aActions.Count() - iActions;
+        inf.if_iChildren = iChildren;
+        inf.if_ctChildren = ctChildren;
+      }
+    };
+};
+
+// Set table location and advance the offset
+static void SetImageTable(SLdsImageTable &tbl, int &iOffset, const int &ctCount, const int &iRecordSize) {
+  tbl.it_iOffset = iOffset;
+  tbl.it_ctCount = ctCount;
+
+  iOffset += ctCount * iRecordSize;
+};
+
+// Write list contents in one go
+template<class Type> static void WriteImageList(CLdsWriteFunc pWrite, void *pStream, DSList<Type> &aList) {
+  const int ct = aList.Count();
+
+  if (ct <= 0) {
+    return;
+  }
+
+  // copy into contiguous memory first
+  Type *aBuffer = new Type[ct];
+
+  for (int i = 0; i < ct; i++) {
+    aBuffer[i] = aList[i];
+  }
+
+  pWrite(pStream, aBuffer, sizeof(Type) * ct);
+  delete[] aBuffer;
+};
+
+// Write flat program image
+void CLdsScriptEngine::LdsWriteImage(void *pStream, CLdsProgram &pgProgram) {
+  CLdsImageWriter iw;
+  iw.Build(pgProgram);
+
+  // header
+  SLdsImageHeader ih;
+  memset(&ih, 0, sizeof(ih));
+  memcpy(ih.ih_aMagic, LDS_IMAGE_MAGIC, 4);
+
+  ih.ih_iVersion = LDS_IMAGE_VERSION;
+  ih.ih_ctMain = pgProgram.Count();
+
+  // constants go first to keep floats aligned
+  int iOffset = sizeof(SLdsImageHeader);
+  SetImageTable(ih.ih_tblConsts, iOffset, iw.iw_aConsts.Count(), sizeof(SLdsImageConst));
+  SetImageTable(ih.ih_tblActions, iOffset, iw.iw_aActions.Count(), sizeof(SLdsImageAction));
+  SetImageTable(ih.ih_tblFuncs, iOffset, iw.iw_aFuncs.Count(), sizeof(SLdsImageFunc));
+  SetImageTable(ih.ih_tblArgs, iOffset, iw.iw_aArgs.Count(), sizeof(SLdsImageString));
+  SetImageTable(ih.ih_tblStrings, iOffset, iw.iw_strStrings.size(), sizeof(char));
+
+  ih.ih_iSize = iOffset;
+
+  // write each table as a whole
+  _pLdsWrite(pStream, &ih, sizeof(ih));
+  WriteImageList(_pLdsWrite, pStream, iw.iw_aConsts);
+  WriteImageList(_pLdsWrite, pStream, iw.iw_aActions);
+  WriteImageList(_pLdsWrite, pStream, iw.iw_aFuncs);
+  WriteImageList(_pLdsWrite, pStream, iw.iw_aArgs);
+
+  if (iw.iw_strStrings.size() > 0) {
+    _pLdsWrite(pStream, iw.iw_strStrings.c_str(), iw.iw_strStrings.size());
+  }
+};
+
+// Read flat program image
+void CLdsScriptEngine::LdsReadImage(void *pStream, CLdsProgramImage &piImage) {
+  SLdsImageHeader ih;
+  memset(&ih, 0, sizeof(ih));
+  _pLdsRead(pStream, &ih, sizeof(ih));
+
+  if (memcmp(ih.ih_aMagic, LDS_IMAGE_MAGIC, 4) != 0 || ih.ih_iVersion != LDS_IMAGE_VERSION) {
+    LdsThrow(LER_READ, "Invalid program image at %d", _pLdsStreamTell(pStream));
+  }
+
+  // don't allocate anything for sizes that are out of range or don't fit the tables
+  if (ih.ih_iSize < (int)sizeof(ih) || ih.ih_iSize > LDS_IMAGE_MAX_SIZE
+   || !ImageTable(ih.ih_tblActions, sizeof(SLdsImageAction), 4, ih.ih_iSize)
+   || !ImageTable(ih.ih_tblConsts, sizeof(SLdsImageConst), 8, ih.ih_iSize)
+   || !ImageTable(ih.ih_tblFuncs, sizeof(SLdsImageFunc), 4, ih.ih_iSize)
+   || !ImageTable(ih.ih_tblArgs, sizeof(SLdsImageString), 4, ih.ih_iSize)
+   || !ImageTable(ih.ih_tblStrings, sizeof(char), 1, ih.ih_iSize)) {
+    LdsThrow(LER_READ, "Invalid program image size %d at %d", ih.ih_iSize, _pLdsStreamTell(pStream));
+  }
+
+  // read the rest of the image at once (owned by the image in case reading fails)
+  char *pBuffer = new char[ih.ih_iSize];
+  memcpy(pBuffer, &ih, sizeof(ih));
+
+  piImage.TakeBuffer(pBuffer, ih.ih_iSize);
+
+  _pLdsRead(pStream, pBuffer + sizeof(ih), ih.ih_iSize - sizeof(ih));
+};
+
+// Expand image function into an inline function
+static void ExpandImageFunc(CLdsProgramImage &pi, CLdsArray &aConsts, const int &iFunc, SLdsInlineFunc &in);
+
+// Expand image actions into a program
+static void ExpandImageProgram(CLdsProgramImage &pi, CLdsArray &aConsts, const int &iFirst, const int &ctActions, CLdsProgram &pg) {
+  const SLdsImageAction *aia = pi.Actions() + iFirst;
+
+  pg.Clear();
+  CActionList &aca = pg.Modify();
+
+  for (int iAction = 0; iAction < ctActions; iAction++) {
+    const SLdsImageAction &ia = aia[iAction];
+    CCompAction &ca = aca.Add();
+
+    ca.lt_eType = ia.ia_iType;
+    ca.lt_iPos = ia.ia_iPos;
+    ca.lt_iArg = ia.ia_iArg;
+
+    if (ia.ia_iConst != -1) {
+      ca.lt_valValue = aConsts[ia.ia_iConst];
+    }
+
+    if (ia.ia_iFunc != -1) {
+      ExpandImageFunc(pi, aConsts, ia.ia_iFunc, ca.ca_inFunc);
+    }
+  }
+};
+
+// Expand image function into an inline function
+static void ExpandImageFunc(CLdsProgramImage &pi, CLdsArray &aConsts, const int &iFunc, SLdsInlineFunc &in) {
+  const SLdsImageFunc &inf = pi.Funcs()[iFunc];
+  const SLdsImageString *ais = pi.Args() + inf.if_iArgs;
+
+  in.in_astrArgs.Clear();
+
+  for (int iArg = 0; iArg < inf.if_ctArgs; iArg++) {
+    in.in_astrArgs.Add() = pi.GetString(ais[iArg].is_iOffset, ais[iArg].is_ctChars);
+  }
+
+  ExpandImageProgram(pi, aConsts, inf.if_iActions, inf.if_ctActions, in.in_pgFunc);
+
+  in.in_mapInlineFunc.Clear();
+
+  for (int iChild = 0; iChild < inf.if_ctChildren; iChild++) {
+    const int iChildFunc = inf.if_iChildren + iChild;
+    const SLdsImageString &isName = pi.Funcs()[iChildFunc].if_strName;
+
+    SLdsInlineFunc &inChild = in.in_mapInlineFunc.Add(pi.GetString(isName.is_iOffset, isName.is_ctChars));
+    ExpandImageFunc(pi, aConsts, iChildFunc, inChild);
+  }
+};
+
+// Load program from the image
+void CLdsScriptEngine::LdsLoadImage(CLdsProgramImage &piImage, CLdsProgram &pgProgram) {
+  if (!piImage.pi_bValid) {
+    piImage.Validate();
+  }
+
+  // create constants once
+  const int ctConsts = piImage.Header().ih_tblConsts.it_ctCount;
+  const SLdsImageConst *aic = piImage.Consts();
+
+  CLdsArray aConsts;
+  aConsts.New(ctConsts);
+
+  for (int iConst = 0; iConst < ctConsts; iConst++) {
+    const SLdsImageConst &ic = aic[iConst];
+
+    switch (ic.ic_iType) {
+      case EVT_INDEX: aConsts[iConst] = CLdsValue(ic.ic_iValue); break;
+      case EVT_FLOAT: aConsts[iConst] = CLdsValue(ic.ic_dValue); break;
+      case EVT_STRING: aConsts[iConst] = CLdsValue(piImage.GetString(ic.ic_iString, ic.ic_ctChars)); break;
+    }
+  }
+
+  ExpandImageProgram(piImage, aConsts, 0, piImage.Header().ih_ctMain, pgProgram);
+
+  // reject malformed programs before they can be executed
+  try {
+    pgProgram.Verify();
+
+  } catch (SLdsError leError) {
+    LdsThrow(LER_READ, "Cannot load malformed program image: %s", leError.le_strMessage.c_str());
+  }
+};
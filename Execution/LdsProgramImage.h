@@ -0,0 +1,168 @@
+/* Copyright (c) 2021 Dreamy Cecil
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#pragma once
+
+#include "../Base/LdsBase.h"
+
+// Program image signature and format version
+#define LDS_IMAGE_MAGIC "LDSI"
+#define LDS_IMAGE_VERSION 1
+
+// Largest program image that can be read from a stream in bytes
+#define LDS_IMAGE_MAX_SIZE (256 * 1024 * 1024)
+
+// Table location within the image
+struct SLdsImageTable {
+  int it_iOffset; // offset from the beginning of the image in bytes
+  int it_ctCount; // amount of entries (bytes for the string table)
+};
+
+// Image header (always at offset 0)
+struct SLdsImageHeader {
+  char ih_aMagic[4]; // LDS_IMAGE_MAGIC
+  int ih_iVersion;   // LDS_IMAGE_VERSION
+  int ih_iSize;      // whole image size in bytes
+  int ih_ctMain;     // amount of actions in the main program (always first)
+
+  SLdsImageTable ih_tblActions; // SLdsImageAction records
+  SLdsImageTable ih_tblConsts;  // SLdsImageConst records
+  SLdsImageTable ih_tblFuncs;   // SLdsImageFunc records
+  SLdsImageTable ih_tblArgs;    // SLdsImageString records
+  SLdsImageTable ih_tblStrings; // raw string bytes
+};
+
+// Fixed-size action record
+struct SLdsImageAction {
+  int ia_iType;  // action type
+  int ia_iPos;   // position in the script
+  int ia_iArg;   // action argument
+  int ia_iConst; // constant pool index (-1 if none)
+  int ia_iFunc;  // inline function index for LCA_FUNC (-1 if none)
+};
+
+// Constant pool entry
+struct SLdsImageConst {
+  int ic_iType;   // value type (only EVT_INDEX, EVT_FLOAT and EVT_STRING)
+  int ic_ctChars; // string length
+
+  union {
+    double ic_dValue; // float value
+    int ic_iValue;    // integer value
+    int ic_iString;   // string offset within the string table
+  };
+};
+
+// Reference to a string in the string table
+struct SLdsImageString {
+  int is_iOffset; // offset within the string table
+  int is_ctChars; // string length
+};
+
+// Inline function record
+struct SLdsImageFunc {
+  SLdsImageString if_strName; // function name (used by child functions)
+
+  int if_iArgs; // first argument in the argument table
+  int if_ctArgs;
+  int if_iActions; // first action in the action table
+  int if_ctActions;
+  int if_iChildren; // first child function (always after this one)
+  int if_ctChildren;
+};
+
+// Flat compiled program image that can be mapped into memory
+class LDS_API CLdsProgramImage {
+  public:
+    const char *pi_pData; // image data
+    int pi_iSize; // image size in bytes
+    bool pi_bValid; // passed the validation
+
+  private:
+    char *pi_pOwned; // owned copy of the data
+    void *pi_pMapped; // mapped view of the file
+    void *pi_pMapHandle; // file mapping handle (only used on Windows)
+
+  public:
+    // Constructor
+    CLdsProgramImage(void) :
+      pi_pData(NULL), pi_iSize(0), pi_bValid(false),
+      pi_pOwned(NULL), pi_pMapped(NULL), pi_pMapHandle(NULL) {};
+
+    // Destructor
+    ~CLdsProgramImage(void) {
+      Clear();
+    };
+
+    // Copy constructor (illegal)
+    CLdsProgramImage(const CLdsProgramImage &piOther);
+
+    // Assignment (illegal)
+    CLdsProgramImage &operator=(const CLdsProgramImage &piOther);
+
+    // Release the image data
+    void Clear(void);
+
+    // Use image from memory (copies the data unless told otherwise)
+    void FromMemory(const void *pData, const int &iSize, bool bCopy = true);
+    // Take ownership of a buffer allocated with new[]
+    void TakeBuffer(char *pBuffer, const int &iSize);
+
+    // Map image file into memory
+    bool MapFile(const char *strFile);
+
+    // Check image integrity (throws LER_READ on failure)
+    void Validate(void);
+
+  public:
+    // Image parts
+    inline const SLdsImageHeader &Header(void) const {
+      return *(const SLdsImageHeader *)pi_pData;
+    };
+
+    inline const SLdsImageAction *Actions(void) const {
+      return (const SLdsImageAction *)(pi_pData + Header().ih_tblActions.it_iOffset);
+    };
+
+    inline const SLdsImageConst *Consts(void) const {
+      return (const SLdsImageConst *)(pi_pData + Header().ih_tblConsts.it_iOffset);
+    };
+
+    inline const SLdsImageFunc *Funcs(void) const {
+      return (const SLdsImageFunc *)(pi_pData + Header().ih_tblFuncs.it_iOffset);
+    };
+
+    inline const SLdsImageString *Args(void) const {
+      return (const SLdsImageString *)(pi_pData + Header().ih_tblArgs.it_iOffset);
+    };
+
+    inline const char *Strings(void) const {
+      return pi_pData + Header().ih_tblStrings.it_iOffset;
+    };
+
+    // Get string from the string table
+    inline string GetString(const int &iOffset, const int &ctChars) const {
+      return string(Strings() + iOffset, ctChars);
+    };
+
+  private:
+    // Check one program within the image
+    void ValidateProgram(const int &iFirst, const int &ctActions, const int &iOwner, DSArray<int> &aiRefs);
+};
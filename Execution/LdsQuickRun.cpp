@@ -21,9 +21,27 @@ SOFTWARE. */
 #include "StdH.h"
 #include "LdsQuickRun.h"
 
-// Constructor
+// Constructors
+CLdsQuickRun::CLdsQuickRun(CLdsScriptEngine &ldsEngine, const CLdsProgram &pgProgram) {
+  CLdsVars aArgs;
+  CLdsInFuncMap mapInline;
+  Start(ldsEngine, pgProgram, aArgs, mapInline);
+};
+
+CLdsQuickRun::CLdsQuickRun(CLdsScriptEngine &ldsEngine, const CLdsProgram &pgProgram, CLdsVars &aArgs) {
+  CLdsInFuncMap mapInline;
+  Start(ldsEngine, pgProgram, aArgs, mapInline);
+};
+
 CLdsQuickRun::CLdsQuickRun(CLdsScriptEngine &ldsEngine, const CLdsProgram &pgProgram,
                            CLdsVars &aArgs, CLdsInFuncMap &mapInline)
+{
+  Start(ldsEngine, pgProgram, aArgs, mapInline);
+};
+
+// Start running the script
+void CLdsQuickRun::Start(CLdsScriptEngine &ldsEngine, const CLdsProgram &pgProgram,
+                         CLdsVars &aArgs, CLdsInFuncMap &mapInline)
 {
   // create and execute the compiled script
   qr_psthThread = ldsEngine.ThreadCreate(pgProgram, aArgs);
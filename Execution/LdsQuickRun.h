@@ -29,9 +29,10 @@ class LDS_API CLdsQuickRun {
     EThreadStatus qr_eStatus; // thread execution status
 
   public:
-    // Constructor
-    CLdsQuickRun(CLdsScriptEngine &ldsEngine, const CLdsProgram &pgProgram,
-                 CLdsVars &aArgs = CLdsVars(), CLdsInFuncMap &mapInline = CLdsInFuncMap());
+    // Constructors
+    CLdsQuickRun(CLdsScriptEngine &ldsEngine, const CLdsProgram &pgProgram);
+    CLdsQuickRun(CLdsScriptEngine &ldsEngine, const CLdsProgram &pgProgram, CLdsVars &aArgs);
+    CLdsQuickRun(CLdsScriptEngine &ldsEngine, const CLdsProgram &pgProgram, CLdsVars &aArgs, CLdsInFuncMap &mapInline);
 
     // Destructor
     ~CLdsQuickRun(void);
@@ -39,6 +40,9 @@ class LDS_API CLdsQuickRun {
     // Assignment (illegal)
     CLdsQuickRun &operator=(const CLdsQuickRun &qrOther);
 
+    // Start running the script
+    void Start(CLdsScriptEngine &ldsEngine, const CLdsProgram &pgProgram, CLdsVars &aArgs, CLdsInFuncMap &mapInline);
+
     // Get thread status
     inline EThreadStatus &GetStatus(void) {
       return qr_eStatus;
@@ -34,17 +34,58 @@ extern CLdsThread *_psthCurrent = NULL;
 // Current action position
 extern int LDS_iActionPos = 0;
 
+// Make sure that an action of an unverified program can be executed
+static void CheckAction(CCompAction &ca, const int &iAction, const int &iLen) {
+  int ctPop, ctPush;
+
+  if (!LdsActionStack(ca, ctPop, ctPush)) {
+    LdsThrow(LEX_ACTION, "Can't run action %d at %s", ca.lt_eType, ca.PrintPos().c_str());
+  }
+
+  const char *strAction = _astrActionNames[ca.lt_eType];
+
+  if (_pavalStack->Count() < ctPop) {
+    LdsThrow(LEX_ACTION, "Not enough values for action %s at %s", strAction, ca.PrintPos().c_str());
+  }
+
+  switch (ca.lt_eType) {
+    case LCA_JUMP: case LCA_JUMPIF: case LCA_JUMPUNLESS:
+    case LCA_AND: case LCA_OR: case LCA_SWITCH:
+      if (ca.lt_iArg < 0 || ca.lt_iArg > iLen) {
+        LdsThrow(LEX_ACTION, "Action %s jumps out of bounds at %s", strAction, ca.PrintPos().c_str());
+      }
+      break;
+
+    case LCA_SWITCH_TABLE:
+      if (ca.lt_iArg <= 0 || iAction + 1 + ca.lt_iArg * 2 > iLen) {
+        LdsThrow(LEX_ACTION, "Action %s has invalid amount of cases at %s", strAction, ca.PrintPos().c_str());
+      }
+      break;
+  }
+};
+
 // Constructor
 CLdsThread::CLdsThread(const CLdsProgram &pg, CLdsScriptEngine *plds) :
   sth_pldsEngine(plds), sth_ubFlags(0),
+  sth_iID(plds != NULL ? plds->_iNextThreadID++ : -1), sth_iVersion(0),
   sth_pgProgram(pg), sth_iPos(0), sth_ctActions(0),
   sth_eStatus(ETS_FINISHED), sth_eError(LER_OK),
-  sth_pReference(NULL), sth_pPreRun(NULL), sth_pResult(NULL)
+  sth_pReference(NULL), sth_pPreRun(NULL), sth_pResult(NULL),
+  sth_iMemory(0), sth_ctQuotaActions(0), sth_ctQuotaCheck(0)
 {
+  // limits of the engine
+  if (plds != NULL) {
+    sth_qtLimits = plds->_qtThreads;
+  }
 };
 
 // Destructor
 CLdsThread::~CLdsThread(void) {
+  // memory isn't used by this thread anymore
+  if (sth_pldsEngine != NULL) {
+    sth_pldsEngine->_iQuotaMemory -= sth_iMemory;
+  }
+
   Clear();
 };
 
@@ -58,6 +99,13 @@ void CLdsThread::Clear(void) {
   sth_eStatus = ETS_FINISHED;
 };
 
+// Mark the thread as changed since the last snapshot
+void CLdsThread::MarkChanged(void) {
+  if (sth_pldsEngine != NULL) {
+    sth_iVersion = sth_pldsEngine->_iStateVersion + 1;
+  }
+};
+
 // Run the thread
 bool CLdsThread::Run(CLdsThread **ppsth) {
   // resume the thread
@@ -94,15 +142,19 @@ bool CLdsThread::Run(CLdsThread **ppsth) {
 
 // Resume the thread
 EThreadStatus CLdsThread::Resume(void) {
-  CActionList &aca = sth_pgProgram.acaProgram;
+  // current actions (change with inline calls)
+  CActionList *paca = &sth_pgProgram.Actions();
 
   // nothing to execute
-  if (aca.Count() <= 0) {
+  if (paca->Count() <= 0) {
     sth_valResult = 0;
     sth_eStatus = ETS_FINISHED;
     return ETS_FINISHED;
   }
 
+  // thread state is about to change
+  MarkChanged();
+
   // call the pre-run function
   if (sth_pPreRun != NULL) {
     sth_pPreRun(this);
@@ -119,6 +171,11 @@ EThreadStatus CLdsThread::Resume(void) {
   _psthCurrent = this;
   _pavalStack = &sth_avalStack;
 
+  // continue with the inline stack if paused inside an inline function
+  if (sth_aicCalls.Count() > 0) {
+    _pavalStack = &sth_aicCalls.Top().avalStack;
+  }
+
   switch (sth_eStatus) {
     case ETS_ERROR:
     case ETS_FINISHED:
@@ -127,32 +184,69 @@ EThreadStatus CLdsThread::Resume(void) {
 
   sth_valResult = 0;
   sth_eStatus = ETS_RUNNING;
-  
+
   int iPos = sth_iPos;
-  int iLen = aca.Count();
+  int iLen = paca->Count();
+
+  // verified programs don't need any checks before each action
+  bool bVerified = sth_pgProgram.IsVerified();
   
   int iPausePos = 0;
 
+  // record time of each action
+  CLdsProfile *ppf = (sth_pldsEngine != NULL && sth_pldsEngine->_bProfileActions ? &sth_pldsEngine->_pfActions : NULL);
+  SLdsProfileMark pmAction;
+
+  // sample call stacks
+  CLdsSampler *psmp = (sth_pldsEngine != NULL && sth_pldsEngine->_smpStacks.IsActive() ? &sth_pldsEngine->_smpStacks : NULL);
+
+  // check execution limits every once in a while
+  const bool bQuota = HasQuota();
+
+  // trace actions into a ring buffer instead of printing them
+  CLdsTraceBuffer *ptb = (sth_pldsEngine != NULL && sth_pldsEngine->_trcActions.IsActive() ? sth_pldsEngine->_trcActions.Buffer(sth_iID) : NULL);
+
   try {
     while (iPos < iLen) {
-      CCompAction &ca = SetCurrentAction(&aca[iPos++]);
+      CCompAction &ca = SetCurrentAction(&(*paca)[iPos++]);
 
       // set current position within the script
       LDS_iActionPos = ca.lt_iPos;
+
+      if (bQuota && sth_ctActions >= sth_ctQuotaCheck) {
+        CheckQuota();
+      }
       
       // current action
       int iType = ca.lt_eType;
+
+      if (ppf != NULL) {
+        ppf->Mark(pmAction, iType, ca.lt_iPos);
+      }
+
+      if (psmp != NULL && psmp->Tick()) {
+        psmp->Sample(*this, ca.lt_iPos);
+      }
+
       const char *strAction = _astrActionNames[iType];
       
-      // print the current action
-      if (IsDebug() && iType != LCA_DIR) {
+      // record or print the current action
+      if (ptb != NULL) {
+        ptb->Write(iType, ca.lt_iPos, _pavalStack->Count(), sth_aicCalls.Count());
+
+      } else if (IsDebug() && iType != LCA_DIR) {
         sth_pldsEngine->LdsOut("[LDS DEBUG]: (%d/%d - %s) - '%s', %d, %s\n", iPos, iLen, strAction, ca->Print().c_str(), ca.lt_iArg, ca.PrintPos().c_str());
       }
   
+      if (!bVerified) {
+        CheckAction(ca, iPos - 1, iLen);
+      }
+
       switch (iType) {
         case LCA_VAL: Exec_Val(); break;
         case LCA_UN: Exec_Unary(); break;
         case LCA_BIN: Exec_Binary(); break;
+        case LCA_BIN_NUM: Exec_BinaryNum(); break;
         
         case LCA_SET:
           if (ca.lt_iArg) {
@@ -173,19 +267,30 @@ EThreadStatus CLdsThread::Resume(void) {
         case LCA_SET_ACCESS: Exec_SetAccessor(); break;
       
         case LCA_CALL:
-        case LCA_INLINE: {
+        case LCA_INLINE:
+        case LCA_TAILCALL: {
           sth_iPos = iPos;
           
           // Inline function (local to the thread)
-          if (iType == LCA_INLINE) {
+          if (iType != LCA_CALL) {
             // make a list of arguments
             CLdsArray aArgs = MakeValueList(*_pavalStack, ca.lt_iArg);
             
-            _psthCurrent->CallInlineFunction(ca->GetString(), aArgs);
+            // reuse the current inline call
+            if (iType == LCA_TAILCALL && sth_aicCalls.Count() > 0) {
+              _psthCurrent->TailCallInlineFunction(ca->GetString(), aArgs);
+            } else {
+              _psthCurrent->CallInlineFunction(ca->GetString(), aArgs);
+            }
             
             // reset position to go through the inline function
+            paca = &sth_pgProgram.Actions();
             iPos = 0;
-            iLen = aca.Count();
+            iLen = paca->Count();
+            bVerified = sth_pgProgram.IsVerified();
+
+            // run hot functions natively
+            iPos = LdsJitHotSpot(*this, sth_pgProgram, 0);
             break;
           }
           
@@ -208,28 +313,7 @@ EThreadStatus CLdsThread::Resume(void) {
         } break;
         
         // Define a local variable
-        case LCA_VAR: {
-          string strName = ca->GetString();
-          bool bConst = (ca.lt_iArg >= 1);
-          
-          // add to the list of inline locals
-          if (sth_aicCalls.Count() > 0) {
-            SLdsInlineCall &icCurrent = sth_aicCalls.Top();
-            
-            // format variable name
-            strName = icCurrent.VarName(strName);
-            
-            // check if it already exists
-            int iGlobal = sth_aLocals.FindIndex(strName);
-            int iInline = icCurrent.astrLocals.FindIndex(strName);
-            
-            if (iGlobal == -1 && iInline == -1) {
-              icCurrent.astrLocals.Add() = strName;
-            }
-          }
-          
-          sth_aLocals.Add() = SLdsVar(strName, 0, bConst);
-        } break;
+        case LCA_VAR: DefineVar(ca->GetString(), (ca.lt_iArg >= 1)); break;
         
         // Apply a thread directive
         case LCA_DIR: {
@@ -246,7 +330,12 @@ EThreadStatus CLdsThread::Resume(void) {
     
         // Jumping between actions
         case LCA_JUMP: {
-          iPos = ca.lt_iArg;
+          // run hot loops natively
+          if (ca.lt_iArg < iPos) {
+            iPos = LdsJitHotSpot(*this, sth_pgProgram, ca.lt_iArg);
+          } else {
+            iPos = ca.lt_iArg;
+          }
         } break;
       
         case LCA_JUMPIF: {
@@ -296,6 +385,11 @@ EThreadStatus CLdsThread::Resume(void) {
           }
         } break;
       
+        // Switch jump table
+        case LCA_SWITCH_TABLE: {
+          iPos = Exec_SwitchTable(*paca, iPos - 1);
+        } break;
+
         // Finish execution
         case LCA_RETURN: iPos = iLen; break;
 
@@ -319,7 +413,9 @@ EThreadStatus CLdsThread::Resume(void) {
         
         // restore position
         iPos = ReturnFromInline();
-        iLen = aca.Count();
+        paca = &sth_pgProgram.Actions();
+        iLen = paca->Count();
+        bVerified = sth_pgProgram.IsVerified();
         
         // add result to the previous stack
         _pavalStack->Push() = valRefResult;
@@ -353,6 +449,11 @@ EThreadStatus CLdsThread::Resume(void) {
     }
   }
 
+  // finish the last action
+  if (ppf != NULL) {
+    ppf->Mark(pmAction, -1, 0);
+  }
+
   sth_iPos = iPos;
   
   // restore previous thread
@@ -361,6 +462,7 @@ EThreadStatus CLdsThread::Resume(void) {
   _psthCurrent = psthPrev;
   _pavalStack = pavalPrev;
 
+
   return sth_eStatus;
 };
 
@@ -396,10 +498,34 @@ CLdsValueRef CLdsThread::GetResult(void) {
   return paval->Pop();
 };
 
+// Find inline function that can be called with some arguments
+int CLdsThread::FindInlineFunction(const string &strFunc, CLdsArray &aArgs) {
+  int iInline = sth_mapInlineFunc.FindKeyIndex(strFunc);
+
+  // functions may be defined by other programs that haven't been verified together with this one
+  if (iInline == -1) {
+    LdsThrow(LEX_ACTION, "Inline function '%s' is not defined at %s", strFunc.c_str(), LdsPrintPos(LDS_iActionPos).c_str());
+  }
+
+  const int ctArgs = sth_mapInlineFunc.GetValue(iInline).in_astrArgs.Count();
+
+  if (aArgs.Count() != ctArgs) {
+    LdsThrow(LEX_ACTION, "Inline function '%s' expects %d arguments instead of %d at %s", strFunc.c_str(), ctArgs, aArgs.Count(), LdsPrintPos(LDS_iActionPos).c_str());
+  }
+
+  return iInline;
+};
+
 // Call the inline function
 void CLdsThread::CallInlineFunction(string strFunc, CLdsArray &aArgs) {
+  // too deep
+  if (sth_qtLimits.qt_ctCalls > 0 && sth_aicCalls.Count() >= sth_qtLimits.qt_ctCalls) {
+    LdsThrow(LEX_QUOTACALLS, "Inline function '%s' exceeds the limit of %d inline calls at %s",
+             strFunc.c_str(), sth_qtLimits.qt_ctCalls, LdsPrintPos(LDS_iActionPos).c_str());
+  }
+
   // get the inline function
-  int iInline = sth_mapInlineFunc.FindKeyIndex(strFunc);
+  int iInline = FindInlineFunction(strFunc, aArgs);
   SLdsInlineFunc inFunc = sth_mapInlineFunc.GetValue(iInline);
   
   CLdsProgram &pgFunc = inFunc.in_pgFunc;
@@ -441,6 +567,52 @@ void CLdsThread::CallInlineFunction(string strFunc, CLdsArray &aArgs) {
   _pavalStack = &sth_aicCalls[iCall].avalStack;
 };
 
+// Call the inline function in place of the current one
+void CLdsThread::TailCallInlineFunction(string strFunc, CLdsArray &aArgs) {
+  // get the inline function
+  int iInline = FindInlineFunction(strFunc, aArgs);
+  SLdsInlineFunc &inFunc = sth_mapInlineFunc.GetValue(iInline);
+
+  CLdsInlineArgs &astrArgs = inFunc.in_astrArgs;
+  SLdsInlineCall &icCall = sth_aicCalls.Top();
+
+  // remove locals of the current function
+  int iLocal;
+
+  for (iLocal = 0; iLocal < icCall.astrLocals.Count(); iLocal++) {
+    sth_aLocals.Delete(icCall.astrLocals[iLocal]);
+  }
+
+  icCall.astrLocals.Clear();
+  icCall.avalStack.Clear();
+
+  // keep returning to the same place
+  icCall.strFunc = strFunc;
+
+  // create argument variables
+  CLdsVars aInlineArgs;
+
+  for (int iArg = 0; iArg < astrArgs.Count(); iArg++) {
+    string strInline = icCall.VarName(astrArgs[iArg]);
+
+    aInlineArgs.Add() = SLdsVar(strInline, aArgs[iArg]);
+
+    if (icCall.astrLocals.FindIndex(strInline) == -1) {
+      icCall.astrLocals.Add() = strInline;
+    }
+  }
+
+  // replace arguments of the same function in outer calls like a normal call does
+  sth_aLocals.AddFrom(aInlineArgs, true);
+
+  // same program when calling itself
+  if (!sth_pgProgram.SharesWith(inFunc.in_pgFunc)) {
+    sth_pgProgram = inFunc.in_pgFunc;
+  }
+
+  sth_iPos = 0;
+};
+
 // Return from the inline function
 int CLdsThread::ReturnFromInline(void) {
   // get the inline call
@@ -468,6 +640,206 @@ int CLdsThread::ReturnFromInline(void) {
   return sth_iPos;
 };
 
+// Define a local variable
+void CLdsThread::DefineVar(string strName, const bool &bConst) {
+  // locals made by the compiler ("func:var" of expanded functions and "#N" of hoisted values)
+  const bool bCompilerLocal = (strName.find(':') != string::npos || (strName.length() > 0 && strName[0] == '#'));
+
+  // add to the list of inline locals
+  if (sth_aicCalls.Count() > 0) {
+    SLdsInlineCall &icCurrent = sth_aicCalls.Top();
+    
+    // format variable name
+    strName = icCurrent.VarName(strName);
+    
+    // check if it already exists
+    int iGlobal = sth_aLocals.FindIndex(strName);
+    int iInline = icCurrent.astrLocals.FindIndex(strName);
+    
+    if (iGlobal == -1 && iInline == -1) {
+      icCurrent.astrLocals.Add() = strName;
+    }
+  }
+
+  // redefine locals made by the compiler instead of adding another variable with the same name on each pass
+  if (bCompilerLocal) {
+    SLdsVar *pvarLocal = sth_aLocals.Find(strName);
+
+    if (pvarLocal != NULL) {
+      *pvarLocal = SLdsVar(strName, 0, bConst);
+      return;
+    }
+  }
+  
+  sth_aLocals.Add() = SLdsVar(strName, 0, bConst);
+};
+
+// Approximate memory used by values on a stack
+static LdsSize StackMemory(DSStack<CLdsValueRef> &avalStack) {
+  LdsSize iSize = 0;
+
+  for (int iVal = 0; iVal < avalStack.Count(); iVal++) {
+    CLdsValueRef &vr = avalStack[iVal];
+
+    // value shell is a part of the reference
+    iSize += sizeof(CLdsValueRef) + vr.vr_val->MemoryUsage() + vr.vr_ariIndices.Count() * sizeof(SLdsRefIndex);
+  }
+
+  return iSize;
+};
+
+// Approximate memory used by inline functions and the ones within them
+static LdsSize InlineFuncMemory(CLdsInFuncMap &mapFunc) {
+  LdsSize iSize = 0;
+
+  for (int iFunc = 0; iFunc < mapFunc.Count(); iFunc++) {
+    SLdsInlineFunc &inFunc = mapFunc.GetValue(iFunc);
+    iSize += inFunc.in_pgFunc.MemoryUsage() + InlineFuncMemory(inFunc.in_mapInlineFunc);
+  }
+
+  return iSize;
+};
+
+// Add approximate memory used by the thread (shared programs are counted for each thread)
+void CLdsThread::MemoryUsage(SLdsMemoryUsage &mu) {
+  mu.mu_iPrograms += sth_pgProgram.MemoryUsage() + InlineFuncMemory(sth_mapInlineFunc);
+  mu.mu_iStacks += StackMemory(sth_avalStack) + sth_aiJumpStack.Count() * sizeof(int);
+  mu.mu_iLocals += sth_aLocals.MemoryUsage();
+
+  for (int iCall = 0; iCall < sth_aicCalls.Count(); iCall++) {
+    SLdsInlineCall &ic = sth_aicCalls[iCall];
+
+    mu.mu_iCalls += sizeof(SLdsInlineCall) + ic.strFunc.capacity() + ic.astrLocals.Count() * sizeof(string);
+    mu.mu_iStacks += StackMemory(ic.avalStack);
+  }
+
+  mu.mu_ctThreads++;
+};
+
+// Measure memory used by the thread and update memory of the engine threads
+LdsSize CLdsThread::MeasureMemory(void) {
+  SLdsMemoryUsage mu;
+  MemoryUsage(mu);
+
+  const LdsSize iMemory = mu.Total();
+
+  if (sth_pldsEngine != NULL) {
+    CLdsScriptEngine &lds = *sth_pldsEngine;
+    lds._iQuotaMemory = lds._iQuotaMemory - sth_iMemory + iMemory;
+
+    if (lds._iQuotaMemory > lds._iPeakMemory) {
+      lds._iPeakMemory = lds._iQuotaMemory;
+    }
+  }
+
+  sth_iMemory = iMemory;
+  return iMemory;
+};
+
+// Check if the thread or its engine has any execution limits (or measures memory during limit checks)
+bool CLdsThread::HasQuota(void) {
+  return (sth_qtLimits.IsSet() || (sth_pldsEngine != NULL && (sth_pldsEngine->_qtEngine.IsSet() || sth_pldsEngine->_bMeasureMemory)));
+};
+
+// Make sure that the thread is within execution limits
+void CLdsThread::CheckQuota(void) {
+  const SLdsQuota &qtThread = sth_qtLimits;
+  const SLdsQuota *pqtEngine = (sth_pldsEngine != NULL ? &sth_pldsEngine->_qtEngine : NULL);
+  const string strPos = LdsPrintPos(LDS_iActionPos);
+
+  // count new actions
+  const LONG64 ctNewActions = sth_ctActions - sth_ctQuotaActions;
+  sth_ctQuotaActions = sth_ctActions;
+
+  if (pqtEngine != NULL) {
+    sth_pldsEngine->_ctQuotaActions += ctNewActions;
+  }
+
+  if (qtThread.qt_ctActions > 0 && sth_ctActions >= qtThread.qt_ctActions) {
+    LdsThrow(LEX_QUOTAACTIONS, "Thread has exceeded the limit of %lld actions at %s", qtThread.qt_ctActions, strPos.c_str());
+  }
+
+  if (pqtEngine != NULL && pqtEngine->qt_ctActions > 0 && sth_pldsEngine->_ctQuotaActions >= pqtEngine->qt_ctActions) {
+    LdsThrow(LEX_QUOTAACTIONS, "Engine threads have exceeded the limit of %lld actions at %s", pqtEngine->qt_ctActions, strPos.c_str());
+  }
+
+  // values on all stacks
+  if (qtThread.qt_ctStack > 0) {
+    int ctValues = sth_avalStack.Count();
+
+    for (int iCall = 0; iCall < sth_aicCalls.Count(); iCall++) {
+      ctValues += sth_aicCalls[iCall].avalStack.Count();
+    }
+
+    if (ctValues > qtThread.qt_ctStack) {
+      LdsThrow(LEX_QUOTASTACK, "Thread has exceeded the limit of %d values on the stack at %s", qtThread.qt_ctStack, strPos.c_str());
+    }
+  }
+
+  LONG64 ctNextCheck = LDS_QUOTA_CHECK;
+
+  // used memory
+  if (qtThread.qt_iBytes > 0 || (pqtEngine != NULL && (pqtEngine->qt_iBytes > 0 || sth_pldsEngine->_bMeasureMemory))) {
+    const LdsSize iMemory = MeasureMemory();
+
+    if (qtThread.qt_iBytes > 0 && iMemory > qtThread.qt_iBytes) {
+      LdsThrow(LEX_QUOTABYTES, "Thread has exceeded the limit of %lu bytes at %s", qtThread.qt_iBytes, strPos.c_str());
+    }
+
+    if (pqtEngine != NULL && pqtEngine->qt_iBytes > 0 && sth_pldsEngine->_iQuotaMemory > pqtEngine->qt_iBytes) {
+      LdsThrow(LEX_QUOTABYTES, "Engine threads have exceeded the limit of %lu bytes at %s", pqtEngine->qt_iBytes, strPos.c_str());
+    }
+
+    // measure threads that use a lot of memory less often
+    LdsSize iDelay = iMemory / 64;
+
+    if (iDelay > LDS_QUOTA_CHECK * 63) {
+      iDelay = LDS_QUOTA_CHECK * 63;
+    }
+
+    ctNextCheck += (LONG64)iDelay;
+  }
+
+  // don't skip over action limits
+  if (qtThread.qt_ctActions > 0 && qtThread.qt_ctActions - sth_ctActions < ctNextCheck) {
+    ctNextCheck = qtThread.qt_ctActions - sth_ctActions;
+  }
+
+  if (pqtEngine != NULL && pqtEngine->qt_ctActions > 0) {
+    const LONG64 ctLeft = pqtEngine->qt_ctActions - sth_pldsEngine->_ctQuotaActions;
+
+    if (ctLeft < ctNextCheck) {
+      ctNextCheck = ctLeft;
+    }
+  }
+
+  sth_ctQuotaCheck = sth_ctActions + ctNextCheck;
+};
+
+// Make sure that the current thread can create a value of some size
+void LdsQuotaValue(const double &dBytes) {
+  CLdsThread *psth = _psthCurrent;
+
+  if (psth == NULL) {
+    return;
+  }
+
+  // value would take more memory than what's left
+  const LdsSize iLimit = psth->sth_qtLimits.qt_iBytes;
+
+  if (iLimit > 0 && double(psth->sth_iMemory) + dBytes > double(iLimit)) {
+    LdsThrow(LEX_QUOTABYTES, "Value of %.0f bytes exceeds the thread limit of %lu bytes at %s",
+             dBytes, iLimit, LdsPrintPos(LDS_iActionPos).c_str());
+  }
+
+  CLdsScriptEngine *plds = psth->sth_pldsEngine;
+
+  if (plds != NULL && plds->_qtEngine.qt_iBytes > 0 && double(plds->_iQuotaMemory) + dBytes > double(plds->_qtEngine.qt_iBytes)) {
+    LdsThrow(LEX_QUOTABYTES, "Value of %.0f bytes exceeds the engine limit of %lu bytes at %s",
+             dBytes, plds->_qtEngine.qt_iBytes, LdsPrintPos(LDS_iActionPos).c_str());
+  }
+};
+
 // Fill a value array with values from the stack
 CLdsArray MakeValueList(DSStack<CLdsValueRef> &avalStack, int ctValues) {
   // make a list of values
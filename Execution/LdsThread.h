@@ -26,6 +26,28 @@ SOFTWARE. */
 // Current action position
 LDS_API extern int LDS_iActionPos;
 
+// Amount of actions between checks of execution limits
+#define LDS_QUOTA_CHECK 1024
+
+// Execution limits of script threads (0 for no limit)
+struct LDS_API SLdsQuota {
+  LdsSize qt_iBytes; // approximate memory used by threads and values they create
+  int qt_ctStack; // values on the stacks of all inline calls
+  int qt_ctCalls; // inline calls within each other
+  LONG64 qt_ctActions; // executed actions
+
+  // Constructor
+  SLdsQuota(void) : qt_iBytes(0), qt_ctStack(0), qt_ctCalls(0), qt_ctActions(0) {};
+
+  // Check if there are any limits
+  inline bool IsSet(void) const {
+    return (qt_iBytes > 0 || qt_ctStack > 0 || qt_ctCalls > 0 || qt_ctActions > 0);
+  };
+};
+
+// Make sure that the current thread can create a value of some size (throws LEX_QUOTABYTES otherwise)
+LDS_API void LdsQuotaValue(const double &dBytes);
+
 // Thread status type
 enum EThreadStatus {
   ETS_RUNNING,  // executing now
@@ -46,10 +68,12 @@ class LDS_API CLdsThread {
     };
 
     LdsFlags sth_ubFlags;
+    int sth_iID; // unique thread ID within the engine (used in I/O)
+    int sth_iVersion; // snapshot version of the last change (see CLdsScriptEngine::_iStateVersion)
     
     CLdsProgram sth_pgProgram; // compiled program
     int sth_iPos; // current position in the thread
-    int sth_ctActions; // how many actions the thread has executed so far
+    LONG64 sth_ctActions; // how many actions the thread has executed so far
     
     DSStack<SLdsInlineCall> sth_aicCalls; // inline function calls
   
@@ -66,6 +90,11 @@ class LDS_API CLdsThread {
     void (*sth_pPreRun)(CLdsThread *psth); // function call before running the thread
     void (*sth_pResult)(CLdsThread *psth); // function call in the end of the run
 
+    SLdsQuota sth_qtLimits; // execution limits of this thread
+    LdsSize sth_iMemory; // approximate memory used by the thread during the last measurement
+    LONG64 sth_ctQuotaActions; // executed actions during the last limit check
+    LONG64 sth_ctQuotaCheck; // amount of executed actions for the next limit check
+
     // Constructor
     CLdsThread(const CLdsProgram &pg, CLdsScriptEngine *plds);
 
@@ -77,6 +106,9 @@ class LDS_API CLdsThread {
 
     // Clear the thread
     void Clear(void);
+
+    // Mark the thread as changed since the last snapshot
+    void MarkChanged(void);
     
     // Run the thread
     bool Run(CLdsThread **ppsth = NULL);
@@ -89,12 +121,32 @@ class LDS_API CLdsThread {
     // Get thread result
     CLdsValueRef GetResult(void);
     
+    // Find inline function that can be called with some arguments
+    int FindInlineFunction(const string &strFunc, CLdsArray &aArgs);
     // Call the inline function
     void CallInlineFunction(string strFunc, CLdsArray &aArgs);
+    // Call the inline function in place of the current one
+    void TailCallInlineFunction(string strFunc, CLdsArray &aArgs);
     
     // Return from the inline function
     int ReturnFromInline(void);
 
+    // Define a local variable
+    void DefineVar(string strName, const bool &bConst);
+
+    // Add approximate memory used by the thread
+    void MemoryUsage(SLdsMemoryUsage &mu);
+    // Measure memory used by the thread and update memory of the engine threads (returns used bytes)
+    LdsSize MeasureMemory(void);
+
+    // Check if the thread or its engine has any execution limits (or measures memory during limit checks)
+    bool HasQuota(void);
+    // Make sure that the thread is within execution limits (throws LEX_QUOTA* errors otherwise)
+    void CheckQuota(void);
+
+    // Move paused thread from the program to its recompiled version (returns false if incompatible)
+    bool Migrate(CLdsProgram &pgOld, CLdsProgram &pgNew);
+
     // Set the flag
     inline void SetFlag(const LdsFlags ubFlag, const bool &bSet) {
       if (bSet) {
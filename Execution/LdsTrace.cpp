@@ -0,0 +1,190 @@
+/* Copyright (c) 2021 Dreamy Cecil
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#include "StdH.h"
+#include "LdsTrace.h"
+
+// Constructor
+CLdsTraceBuffer::CLdsTraceBuffer(const int &iThread, const int &ctRecords) :
+  tb_iThread(iThread), tb_ctWritten(0)
+{
+  tb_atrRecords.New(ctRecords);
+};
+
+// Start tracing actions of all threads
+void CLdsTrace::Start(const int &ctRecords) {
+  // ring buffers need a power of two
+  tc_ctRecords = 1;
+
+  while (tc_ctRecords < ctRecords) {
+    tc_ctRecords <<= 1;
+  }
+
+  if (tc_aptbBuffers.Count() == 0) {
+    tc_llStartTicks = LdsGetTicks();
+    tc_dStartTime = LdsGetTime();
+  }
+};
+
+// Stop tracing and keep the records
+void CLdsTrace::Stop(void) {
+  tc_ctRecords = 0;
+};
+
+// Delete all records
+void CLdsTrace::Clear(void) {
+  for (int iBuffer = 0; iBuffer < tc_aptbBuffers.Count(); iBuffer++) {
+    delete tc_aptbBuffers[iBuffer];
+  }
+
+  tc_aptbBuffers.Clear();
+
+  tc_llStartTicks = LdsGetTicks();
+  tc_dStartTime = LdsGetTime();
+};
+
+// Ring buffer of some thread
+CLdsTraceBuffer *CLdsTrace::Buffer(const int &iThread) {
+  for (int iBuffer = 0; iBuffer < tc_aptbBuffers.Count(); iBuffer++) {
+    if (tc_aptbBuffers[iBuffer]->tb_iThread == iThread) {
+      return tc_aptbBuffers[iBuffer];
+    }
+  }
+
+  CLdsTraceBuffer *ptb = new CLdsTraceBuffer(iThread, tc_ctRecords);
+  tc_aptbBuffers.Add() = ptb;
+
+  return ptb;
+};
+
+// Write all records into a data stream
+void CLdsTrace::Write(CLdsWriteFunc pWrite, void *pStream) {
+  SLdsTraceHeader th;
+  memset(&th, 0, sizeof(th));
+  memcpy(th.th_aMagic, LDS_TRACE_MAGIC, 4);
+
+  th.th_iVersion = LDS_TRACE_VERSION;
+  th.th_iRecordSize = sizeof(SLdsTraceRecord);
+  th.th_ctBuffers = tc_aptbBuffers.Count();
+  th.th_llStartTicks = tc_llStartTicks;
+
+  // measure ticks over the whole tracing time
+  const LONG64 llTicks = LdsGetTicks() - tc_llStartTicks;
+  th.th_dTickTime = (llTicks > 0 ? (LdsGetTime() - tc_dStartTime) / double(llTicks) : 0.0);
+
+  pWrite(pStream, &th, sizeof(th));
+
+  for (int iBuffer = 0; iBuffer < tc_aptbBuffers.Count(); iBuffer++) {
+    const CLdsTraceBuffer &tb = *tc_aptbBuffers[iBuffer];
+
+    SLdsTraceBufferHeader tbh;
+    tbh.tbh_iThread = tb.tb_iThread;
+    tbh.tbh_ctRecords = tb.Count();
+
+    pWrite(pStream, &tbh, sizeof(tbh));
+
+    for (int iRecord = 0; iRecord < tbh.tbh_ctRecords; iRecord++) {
+      pWrite(pStream, &tb.Record(iRecord), sizeof(SLdsTraceRecord));
+    }
+  }
+};
+
+// Write traced actions of all threads into a data stream
+void CLdsScriptEngine::LdsWriteTrace(void *pStream) {
+  _trcActions.Write(_pLdsWrite, pStream);
+};
+
+// Decode written trace into readable text or Chrome trace event JSON
+bool LdsDecodeTrace(const void *pData, const LdsSize &iSize, string &strOutput, const bool &bChrome) {
+  const char *pBytes = (const char *)pData;
+  LdsSize iOffset = sizeof(SLdsTraceHeader);
+
+  if (iSize < iOffset) {
+    return false;
+  }
+
+  SLdsTraceHeader th;
+  memcpy(&th, pBytes, sizeof(th));
+
+  if (memcmp(th.th_aMagic, LDS_TRACE_MAGIC, 4) != 0 || th.th_iVersion != LDS_TRACE_VERSION
+   || th.th_iRecordSize != sizeof(SLdsTraceRecord) || th.th_ctBuffers < 0) {
+    return false;
+  }
+
+  const double dMicro = th.th_dTickTime * 1000000.0;
+  strOutput = (bChrome ? "{\"traceEvents\": [" : "");
+
+  bool bFirstEvent = true;
+
+  for (int iBuffer = 0; iBuffer < th.th_ctBuffers; iBuffer++) {
+    if (iSize - iOffset < sizeof(SLdsTraceBufferHeader)) {
+      return false;
+    }
+
+    SLdsTraceBufferHeader tbh;
+    memcpy(&tbh, pBytes + iOffset, sizeof(tbh));
+    iOffset += sizeof(tbh);
+
+    if (tbh.tbh_ctRecords < 0 || (iSize - iOffset) / sizeof(SLdsTraceRecord) < (LdsSize)tbh.tbh_ctRecords) {
+      return false;
+    }
+
+    if (!bChrome) {
+      strOutput += LdsPrintF("Thread %d (%d actions):\n", tbh.tbh_iThread, tbh.tbh_ctRecords);
+    }
+
+    for (int iRecord = 0; iRecord < tbh.tbh_ctRecords; iRecord++) {
+      SLdsTraceRecord tr;
+      memcpy(&tr, pBytes + iOffset, sizeof(tr));
+      iOffset += sizeof(tr);
+
+      const char *strAction = (tr.tr_uwType < LCA_SIZEOF ? _astrActionNames[tr.tr_uwType] : "?");
+      const double dTime = double(tr.tr_llTicks - th.th_llStartTicks) * dMicro;
+
+      if (!bChrome) {
+        strOutput += LdsPrintF("  %14.3f us  %-12s %-22s stack %d, calls %d\n", dTime, strAction,
+                               LdsPrintPos(tr.tr_iPos).c_str(), tr.tr_ctStack, tr.tr_uwCalls);
+        continue;
+      }
+
+      // actions last until the next one
+      double dDuration = 0.0;
+
+      if (iRecord + 1 < tbh.tbh_ctRecords) {
+        SLdsTraceRecord trNext;
+        memcpy(&trNext, pBytes + iOffset, sizeof(trNext));
+
+        dDuration = double(trNext.tr_llTicks - tr.tr_llTicks) * dMicro;
+      }
+
+      strOutput += (bFirstEvent ? "\n  " : ",\n  ");
+      strOutput += LdsPrintF("{\"name\": \"%s\", \"ph\": \"X\", \"ts\": %.3f, \"dur\": %.3f, \"pid\": 1, \"tid\": %d, "
+                             "\"args\": {\"pos\": \"%s\", \"stack\": %d, \"calls\": %d}}", strAction, dTime, dDuration,
+                             tr.tr_iThread, LdsPrintPos(tr.tr_iPos).c_str(), tr.tr_ctStack, tr.tr_uwCalls);
+      bFirstEvent = false;
+    }
+  }
+
+  if (bChrome) {
+    strOutput += "\n]}\n";
+  }
+
+  return true;
+};
@@ -0,0 +1,132 @@
+/* Copyright (c) 2021 Dreamy Cecil
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#pragma once
+
+#include "../Base/LdsBase.h"
+
+// Trace signature and format version
+#define LDS_TRACE_MAGIC "LDST"
+#define LDS_TRACE_VERSION 1
+
+// Recommended amount of records in the ring buffer of each thread
+#define LDS_TRACE_RECORDS 0x10000
+
+// Executed action
+struct SLdsTraceRecord {
+  LONG64 tr_llTicks; // when the action has started
+  int tr_iThread; // thread ID
+  int tr_iPos; // position in the script
+  unsigned short tr_uwType; // action type
+  unsigned short tr_uwCalls; // inline call depth
+  int tr_ctStack; // values on the current stack
+};
+
+// Trace header (always at offset 0)
+struct SLdsTraceHeader {
+  char th_aMagic[4]; // LDS_TRACE_MAGIC
+  int th_iVersion; // LDS_TRACE_VERSION
+  int th_iRecordSize; // size of one record in bytes
+  int th_ctBuffers; // amount of thread buffers after the header
+  double th_dTickTime; // seconds in one tick
+  LONG64 th_llStartTicks; // ticks when the tracing has started
+};
+
+// Thread buffer header (followed by records from oldest to newest)
+struct SLdsTraceBufferHeader {
+  int tbh_iThread; // thread ID
+  int tbh_ctRecords; // amount of records
+};
+
+// Ring buffer with the latest actions of one thread (only that thread writes into it)
+class LDS_API CLdsTraceBuffer {
+  public:
+    DSArray<SLdsTraceRecord> tb_atrRecords; // records (amount is a power of two)
+    int tb_iThread; // thread ID
+    volatile LONG64 tb_ctWritten; // amount of records that have been written (the next one goes here)
+
+  public:
+    // Constructor
+    CLdsTraceBuffer(const int &iThread, const int &ctRecords);
+
+    // Record one action
+    inline void Write(const int &iType, const int &iPos, const int &ctStack, const int &ctCalls) {
+      SLdsTraceRecord &tr = tb_atrRecords[int(tb_ctWritten & (tb_atrRecords.Count() - 1))];
+      tr.tr_llTicks = LdsGetTicks();
+      tr.tr_iThread = tb_iThread;
+      tr.tr_iPos = iPos;
+      tr.tr_uwType = (unsigned short)iType;
+      tr.tr_uwCalls = (unsigned short)ctCalls;
+      tr.tr_ctStack = ctStack;
+
+      // make the record available after writing it
+      tb_ctWritten++;
+    };
+
+    // Amount of stored records
+    inline int Count(void) const {
+      return (tb_ctWritten < tb_atrRecords.Count() ? int(tb_ctWritten) : tb_atrRecords.Count());
+    };
+
+    // Get stored record from oldest to newest
+    inline const SLdsTraceRecord &Record(const int &iRecord) const {
+      return tb_atrRecords[int((tb_ctWritten - Count() + iRecord) & (tb_atrRecords.Count() - 1))];
+    };
+};
+
+// Action traces of all threads of an engine
+class LDS_API CLdsTrace {
+  public:
+    DSList<CLdsTraceBuffer *> tc_aptbBuffers; // ring buffers of each thread
+    int tc_ctRecords; // amount of records in new ring buffers (0 if not tracing)
+
+    LONG64 tc_llStartTicks; // ticks when the tracing has started
+    double tc_dStartTime; // time when the tracing has started
+
+  public:
+    // Constructor
+    CLdsTrace(void) : tc_ctRecords(0), tc_llStartTicks(0), tc_dStartTime(0.0) {};
+
+    // Destructor
+    ~CLdsTrace(void) {
+      Clear();
+    };
+
+    // Start tracing actions of all threads
+    void Start(const int &ctRecords = LDS_TRACE_RECORDS);
+    // Stop tracing and keep the records
+    void Stop(void);
+    // Delete all records
+    void Clear(void);
+
+    // Check if actions are being traced
+    inline bool IsActive(void) const {
+      return (tc_ctRecords > 0);
+    };
+
+    // Ring buffer of some thread (creates a new one if needed)
+    CLdsTraceBuffer *Buffer(const int &iThread);
+
+    // Write all records into a data stream
+    void Write(CLdsWriteFunc pWrite, void *pStream);
+};
+
+// Decode written trace into readable text or Chrome trace event JSON (returns false if it's invalid)
+LDS_API bool LdsDecodeTrace(const void *pData, const LdsSize &iSize, string &strOutput, const bool &bChrome);
@@ -68,7 +68,7 @@ void CLdsScriptEngine::SetDefaultFunctions(void) {
   // set default functions
   _mapLdsDefFunc.Add("DebugOut") = SLdsFunc(1, &LDS_DebugOut);
   _mapLdsDefFunc.Add("PrintHex") = SLdsFunc(1, &LDS_PrintHex);
-  _mapLdsDefFunc.Add("Hash") = SLdsFunc(1, &LDS_HashString);
+  _mapLdsDefFunc.Add("Hash") = SLdsFunc(1, &LDS_HashString, true);
   _mapLdsDefFunc.Add("Wait") = SLdsFunc(1, &LDS_Wait);
   
   // set math functions
@@ -76,10 +76,16 @@ void CLdsScriptEngine::SetDefaultFunctions(void) {
 
   // set math operators
   SetMathOperators(_mapLdsDefUnary);
+
+  // math operators are pure
+  for (int iOperator = 0; iOperator < _mapLdsDefUnary.Count(); iOperator++) {
+    _astrDefPureUnary.Add(_mapLdsDefUnary.GetKey(iOperator));
+  }
   
   // add default functions
   _mapLdsFunctions.CopyMap(_mapLdsDefFunc);
   _mapLdsUnaryOps.CopyMap(_mapLdsDefUnary);
+  _astrPureUnary.CopyArray(_astrDefPureUnary);
 };
 
 // Set custom functions from the map
@@ -110,9 +116,10 @@ LdsReturn CLdsScriptEngine::CallFunction(CCompAction *pcaAction, CLdsArray &aArg
 
   // function name
   string strFunc = (*pcaAction)->GetString();
+  LdsFuncPtr pFunc = _mapLdsFunctions[strFunc].ef_pFunc;
 
   // function is empty
-  if (_mapLdsFunctions[strFunc].ef_pFunc == NULL) {
+  if (pFunc == NULL) {
     LdsThrow(LEX_NOFUNC, "Function '%s' is NULL", strFunc.c_str());
   }
 
@@ -126,7 +133,13 @@ LdsReturn CLdsScriptEngine::CallFunction(CCompAction *pcaAction, CLdsArray &aArg
   }
 
   // call the function
-  LdsReturn valValue = _mapLdsFunctions[strFunc].ef_pFunc(pvalFuncArgs);
+  const LONG64 llStart = (_bProfileCalls ? LdsGetTicks() : 0);
+  LdsReturn valValue = pFunc(pvalFuncArgs);
+
+  // record how long it took
+  if (_bProfileCalls) {
+    _cpCalls.Stats(strFunc).Record(LdsGetTicks() - llStart);
+  }
 
   _pcaFunctionCall = NULL;
 
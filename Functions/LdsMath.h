@@ -149,14 +149,14 @@ inline LdsReturn LdsClamp(LDS_ARGS) {
 
 // Math functions
 inline void SetMathFunctions(CLdsFuncMap &map) {
-  map.Add("atan2") = SLdsFunc(2, &LdsATan2);
+  map.Add("atan2") = SLdsFunc(2, &LdsATan2, true);
   
-  map.Add("root") = SLdsFunc(2, &LdsRoot);
-  map.Add("pow") = SLdsFunc(2, &LdsPow);
+  map.Add("root") = SLdsFunc(2, &LdsRoot, true);
+  map.Add("pow") = SLdsFunc(2, &LdsPow, true);
   
-  map.Add("min") = SLdsFunc(2, &LdsMin);
-  map.Add("max") = SLdsFunc(2, &LdsMax);
-  map.Add("clamp") = SLdsFunc(3, &LdsClamp);
+  map.Add("min") = SLdsFunc(2, &LdsMin, true);
+  map.Add("max") = SLdsFunc(2, &LdsMax, true);
+  map.Add("clamp") = SLdsFunc(3, &LdsClamp, true);
 };
 
 // Math operators
@@ -0,0 +1,127 @@
+/* Copyright (c) 2021 Dreamy Cecil
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+// Engine setup shared by the transpiler of test scripts and the test that runs them
+
+#pragma once
+
+#include "../LdsTest.h"
+
+// Everything the scripts print through the output function
+static string _strAotOutput = "";
+
+// Seed of the random number function
+static unsigned int _iAotSeed = 1;
+
+// Engine output function (ignored because transpiled scripts don't print debug context of each action)
+static void AotDebugOutput(const char *strOutput) {
+  (void)strOutput;
+};
+
+// Error output function
+static void AotErrorOutput(const char *strError) {
+  fprintf(stderr, "[LDS ERROR]: %s", strError);
+};
+
+// Random number function (always the same numbers after resetting the seed)
+static LDS_FUNC(LDS_Random) {
+  _iAotSeed = _iAotSeed * 1103515245 + 12345;
+
+  return int((_iAotSeed >> 16) & 0x7FFF);
+};
+
+// Console printing function
+static LDS_FUNC(LDS_ConsolePrint) {
+  _strAotOutput += LDS_NEXT_ARG->Print();
+  return 0;
+};
+
+// Suspend execution for some time (doesn't wait)
+static LDS_FUNC(LDS_Sleep) {
+  LDS_NEXT_NUM;
+  return 0;
+};
+
+// Return an array or an object with some data
+static LDS_FUNC(LDS_Data) {
+  int iObject = LDS_NEXT_INT;
+
+  CLdsArrayType aData;
+  aData.Add(0xFF);
+  aData.Add(0x7F);
+
+  if (iObject != 0) {
+    CLdsVars aFields;
+    aFields.Add() = SLdsVar("info", string("Two bytes"), true);
+    aFields.Add() = SLdsVar("data", aData, true);
+
+    return CLdsObjectType(-1, aFields, true);
+  }
+
+  CLdsArrayType valArray;
+  valArray.Add(string("Two bytes"));
+  valArray.Add(aData);
+
+  return valArray;
+};
+
+// Unary operation for getting value type name
+static LDS_FUNC(LDS_UnaryValueType) {
+  return LDS_NEXT_ARG->TypeName();
+};
+
+// Unary operation for adding all array entries together
+static LDS_FUNC(LDS_UnaryArrayAdd) {
+  CLdsVars &aArray = LDS_NEXT_LIST(0);
+
+  double dResult = 0.0;
+
+  for (int i = 0; i < aArray.Count(); i++) {
+    dResult += aArray[i]->GetNumber();
+  }
+
+  return dResult;
+};
+
+// Same setup as the usage example (scripts must be transpiled and interpreted with the same one)
+static void SetupAotEngine(CLdsScriptEngine &lds) {
+  lds.LdsOutputFunctions((void *)AotDebugOutput, (void *)AotErrorOutput);
+  lds._bUseScriptCaching = false;
+
+  CLdsFuncMap mapFunc;
+  mapFunc.Add("Random") = SLdsFunc(0, &LDS_Random);
+  mapFunc.Add("Out") = SLdsFunc(1, &LDS_ConsolePrint);
+  mapFunc.Add("Sleep") = SLdsFunc(1, &LDS_Sleep);
+  mapFunc.Add("GetData") = SLdsFunc(1, &LDS_Data);
+
+  lds.SetCustomFunctions(mapFunc);
+
+  CLdsVars aVars;
+  aVars.Add() = SLdsVar("MAX_COUNT", 10, true);
+  aVars.Add() = SLdsVar("strHello", string("Hello, world!"));
+
+  lds.SetCustomVariables(aVars);
+
+  CLdsFuncPtrMap mapUnary;
+  mapUnary.Add("type") = &LDS_UnaryValueType;
+  mapUnary.Add("array_add") = &LDS_UnaryArrayAdd;
+
+  lds.SetUnaryOperators(mapUnary, true);
+};
@@ -0,0 +1,69 @@
+/* Copyright (c) 2021 Dreamy Cecil
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+// Transpiles test scripts into C++ sources for the AOT test
+// Usage: TranspileScripts <output directory> <script files...>
+
+#include "AotSetup.h"
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    fprintf(stderr, "Usage: %s <output directory> <script files...>\n", argv[0]);
+    return 1;
+  }
+
+  CLdsScriptEngine lds;
+  SetupAotEngine(lds);
+
+  for (int iArg = 2; iArg < argc; iArg++) {
+    string strFile = argv[iArg];
+
+    // script becomes a function with the same name
+    string strName = strFile.substr(strFile.find_last_of("/\\") + 1);
+    strName = strName.substr(0, strName.find_last_of('.'));
+
+    string strScript = "";
+
+    if (!LdsLoadScriptFile(strFile.c_str(), strScript)) {
+      fprintf(stderr, "Couldn't load script file '%s'\n", strFile.c_str());
+      return 1;
+    }
+
+    string strSource = "";
+
+    if (lds.LdsTranspileScript(strScript, strName, CLdsInlineArgs(), strSource) != LER_OK) {
+      fprintf(stderr, "Couldn't transpile script file '%s'\n", strFile.c_str());
+      return 1;
+    }
+
+    string strOutput = string(argv[1]) + "/" + strName + ".cpp";
+    FILE *file = fopen(strOutput.c_str(), "w");
+
+    if (file == NULL) {
+      fprintf(stderr, "Couldn't create source file '%s'\n", strOutput.c_str());
+      return 1;
+    }
+
+    fputs(strSource.c_str(), file);
+    fclose(file);
+  }
+
+  return 0;
+};
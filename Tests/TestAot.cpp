@@ -0,0 +1,93 @@
+/* Copyright (c) 2021 Dreamy Cecil
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+// Transpiled test scripts give the same results as the interpreter
+
+#include "Aot/AotSetup.h"
+
+// Directory with test scripts (set by the build)
+#ifndef LDS_SOURCE_DIR
+  #define LDS_SOURCE_DIR "."
+#endif
+
+// Result of running a script
+struct SAotResult {
+  EThreadStatus eStatus;
+  string strResult;
+  string strOutput;
+};
+
+// Run the script in a clean engine
+static SAotResult RunScript(const string &strScript) {
+  CLdsScriptEngine lds;
+  SetupAotEngine(lds);
+  LdsAddAotFunctions(lds);
+
+  SAotResult ar;
+  ar.eStatus = ETS_ERROR;
+
+  CLdsProgram pg;
+  LDS_CHECK(lds.LdsCompileScript(strScript, pg) == LER_OK);
+
+  _strAotOutput = "";
+  _iAotSeed = 1;
+
+  CLdsQuickRun qr(lds, pg);
+
+  ar.eStatus = qr.GetStatus();
+  ar.strResult = qr.GetResult()->Print();
+  ar.strOutput = _strAotOutput;
+
+  return ar;
+};
+
+// Compare transpiled script against the original one
+static void CompareScript(CLdsAotScript &as) {
+  string strFile = string(LDS_SOURCE_DIR "/TestScripts/") + as.as_strName + ".lds";
+  string strScript = "";
+  LDS_CHECK(LdsLoadScriptFile(strFile.c_str(), strScript));
+
+  SAotResult arScript = RunScript(strScript);
+  SAotResult arAot = RunScript(string("return ") + as.as_strName + "();");
+
+  if (arAot.strResult != arScript.strResult || arAot.strOutput != arScript.strOutput) {
+    fprintf(stderr, "%s: interpreted \"%s\" (output: \"%s\"), transpiled \"%s\" (output: \"%s\")\n", as.as_strName,
+            arScript.strResult.c_str(), arScript.strOutput.c_str(), arAot.strResult.c_str(), arAot.strOutput.c_str());
+  }
+
+  LDS_CHECK(arScript.eStatus == ETS_FINISHED);
+  LDS_CHECK(arAot.eStatus == arScript.eStatus);
+  LDS_CHECK(arAot.strResult == arScript.strResult);
+  LDS_CHECK(arAot.strOutput == arScript.strOutput);
+};
+
+int main(void) {
+  int ctScripts = 0;
+
+  for (CLdsAotScript *pas = LDS_pAotScripts; pas != NULL; pas = pas->as_pNext) {
+    CompareScript(*pas);
+    ctScripts++;
+  }
+
+  // every test script has been linked
+  LDS_CHECK(ctScripts > 0);
+
+  return LDS_TEST_RESULT;
+};
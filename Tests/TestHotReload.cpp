@@ -0,0 +1,125 @@
+/* Copyright (c) 2021 Dreamy Cecil
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+// Hot reload of script files with paused threads
+
+#include "LdsTest.h"
+
+// Script file that gets reloaded
+#define RELOAD_FILE "TestHotReload.lds"
+
+// Status and result of the last finished thread
+static EThreadStatus _eStatus = ETS_RUNNING;
+static string _strResult = "";
+
+// Remember how the thread has finished
+static void ThreadResult(CLdsThread *psth) {
+  _eStatus = psth->sth_eStatus;
+  _strResult = psth->sth_valResult->Print();
+};
+
+// Replace contents of the script file
+static void SaveScript(const char *strScript) {
+  FILE *file = fopen(RELOAD_FILE, "w");
+  fputs(strScript, file);
+  fclose(file);
+};
+
+// Pause the script in a loop, reload it with changes and run it until the end (returns amount of migrated threads)
+static int ReloadInLoop(const char *strOld, const char *strNew) {
+  CLdsScriptEngine lds;
+
+  CLdsVars aVars;
+  aVars.Add() = SLdsVar("MAX_COUNT", 10, true);
+  lds.SetCustomVariables(aVars);
+
+  SaveScript(strOld);
+
+  CLdsProgram pgProgram;
+  LDS_CHECK(lds.LdsCompileFile(RELOAD_FILE, pgProgram) == LER_OK);
+
+  _eStatus = ETS_RUNNING;
+  _strResult = "";
+
+  // pause on the first iteration
+  CLdsVars aArgs;
+  CLdsThread *psth = lds.ThreadCreate(pgProgram, aArgs);
+  psth->sth_pResult = ThreadResult;
+  psth->Run(&psth);
+
+  LDS_CHECK(psth != NULL && psth->sth_eStatus == ETS_PAUSE);
+
+  SaveScript(strNew);
+  int ctMigrated = lds.LdsReloadFile(RELOAD_FILE);
+
+  // wait until it finishes
+  for (LONG64 llTick = 1; llTick <= 100 && _eStatus == ETS_RUNNING; llTick++) {
+    lds.HandleThreads(llTick * lds._iThreadTickRate);
+  }
+
+  LDS_CHECK(_eStatus == ETS_FINISHED);
+
+  remove(RELOAD_FILE);
+  return ctMigrated;
+};
+
+int main(void) {
+  // condition with a loop-invariant expression that didn't exist before
+  int ctMigrated = ReloadInLoop(
+    "var i = 0;\n" "while (i < 3) {\n" "  Wait(1);\n" "  i = i + 1;\n" "}\n" "return i;\n",
+    "var i = 0;\n" "while (i < MAX_COUNT / 2) {\n" "  Wait(1);\n" "  i = i + 1;\n" "}\n" "return i;\n");
+
+  LDS_CHECK(ctMigrated == 0);
+  LDS_CHECK(_strResult == "3");
+
+  // loop-invariant expression that is computed differently
+  ctMigrated = ReloadInLoop(
+    "var i = 0;\n" "while (i < MAX_COUNT - 7) {\n" "  Wait(1);\n" "  i = i + 1;\n" "}\n" "return i;\n",
+    "var i = 0;\n" "while (i < MAX_COUNT - 4) {\n" "  Wait(1);\n" "  i = i + 1;\n" "}\n" "return i;\n");
+
+  LDS_CHECK(ctMigrated == 0);
+  LDS_CHECK(_strResult == "3");
+
+  // new local variable before the paused statement
+  ctMigrated = ReloadInLoop(
+    "var i = 0;\n" "while (i < 3) {\n" "  Wait(1);\n" "  i = i + 1;\n" "}\n" "return i;\n",
+    "var i = 0;\n" "var j = 2;\n" "while (i < 3) {\n" "  Wait(1);\n" "  i = i + j;\n" "}\n" "return i;\n");
+
+  LDS_CHECK(ctMigrated == 0);
+  LDS_CHECK(_strResult == "3");
+
+  // same loop-invariant expression with a different loop body
+  ctMigrated = ReloadInLoop(
+    "var i = 0;\n" "while (i < MAX_COUNT - 7) {\n" "  Wait(1);\n" "  i = i + 1;\n" "}\n" "return i;\n",
+    "var i = 0;\n" "while (i < MAX_COUNT - 7) {\n" "  Wait(1);\n" "  i = i + 2;\n" "}\n" "return i;\n");
+
+  LDS_CHECK(ctMigrated == 1);
+  LDS_CHECK(_strResult == "4");
+
+  // same statement of an expanded function with another value on the stack under it
+  ctMigrated = ReloadInLoop(
+    "var a = F();\n" "return a;\n" "function F() {\n" "  var y = 2;\n" "  Wait(1);\n" "  return y;\n" "};\n",
+    "var a = 5 + F();\n" "return a;\n" "function F() {\n" "  var y = 2;\n" "  Wait(1);\n" "  return y;\n" "};\n");
+
+  LDS_CHECK(ctMigrated == 0);
+  LDS_CHECK(_strResult == "2");
+
+  return LDS_TEST_RESULT;
+};
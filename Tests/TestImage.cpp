@@ -0,0 +1,131 @@
+/* Copyright (c) 2021 Dreamy Cecil
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+// Flat program images written into a stream and read back
+
+#include "LdsTest.h"
+
+// Script with constants of each type and inline functions
+static const char *_strScript =
+  "var str = \"ab\";\n"
+  "var fSum = 0.5;\n"
+  "for (var i = 0; i < 4; i++) {\n"
+  "  fSum += Twice(i);\n"
+  "}\n"
+  "return str + fSum;\n"
+  "function Twice(iValue) {\n"
+  "  return iValue * 2;\n"
+  "};\n";
+
+// Amount of reads from the stream
+static int _ctReads = 0;
+
+// Count reads from the buffer
+static void CountedRead(void *pStream, void *pData, const LdsSize &iSize) {
+  _ctReads++;
+  LdsBufferRead(pStream, pData, iSize);
+};
+
+// Read the image from the stream (returns false if it's been rejected)
+static bool ReadImage(CLdsScriptEngine &lds, CLdsBufferStream &bs, CLdsProgram &pg) {
+  CLdsProgramImage piImage;
+  bs.Rewind();
+  _ctReads = 0;
+
+  try {
+    lds.LdsReadImage(&bs, piImage);
+    lds.LdsLoadImage(piImage, pg);
+
+  } catch (SLdsError leError) {
+    return (leError.le_eError != LER_READ);
+  }
+
+  return true;
+};
+
+int main(void) {
+  CLdsScriptEngine lds;
+  lds.LdsStreamFunctions((void *)LdsBufferWrite, (void *)CountedRead, (void *)LdsBufferTell);
+
+  CLdsProgram pgCompiled;
+  LDS_CHECK(lds.LdsCompileScript(_strScript, pgCompiled) == LER_OK);
+
+  CLdsQuickRun qrCompiled(lds, pgCompiled);
+  LDS_CHECK(qrCompiled.GetResult()->Print() == "ab12.5");
+
+  CLdsBufferStream bsImage;
+  lds.LdsWriteImage(&bsImage, pgCompiled);
+
+  // same program after reading it back
+  CLdsProgram pgLoaded;
+  LDS_CHECK(ReadImage(lds, bsImage, pgLoaded));
+  LDS_CHECK(pgLoaded.Count() == pgCompiled.Count());
+
+  CLdsQuickRun qrLoaded(lds, pgLoaded);
+  LDS_CHECK(qrLoaded.GetStatus() == ETS_FINISHED);
+  LDS_CHECK(qrLoaded.GetResult()->Print() == qrCompiled.GetResult()->Print());
+
+  SLdsImageHeader &ih = *(SLdsImageHeader *)bsImage.bs_pData;
+  const SLdsImageHeader ihValid = ih;
+
+  // size that is too big is rejected before reading the rest
+  ih.ih_iSize = 0x7FFFFFFF;
+  LDS_CHECK(!ReadImage(lds, bsImage, pgLoaded));
+  LDS_CHECK(_ctReads == 1);
+
+  // tables out of bounds
+  ih = ihValid;
+  ih.ih_tblActions.it_ctCount = ihValid.ih_iSize;
+  LDS_CHECK(!ReadImage(lds, bsImage, pgLoaded));
+  LDS_CHECK(_ctReads == 1);
+
+  // cut off in the middle
+  ih = ihValid;
+
+  CLdsBufferStream bsCut;
+  bsCut.FromMemory(bsImage.bs_pData, ihValid.ih_iSize / 2);
+  LDS_CHECK(!ReadImage(lds, bsCut, pgLoaded));
+
+  // unknown action type
+  SLdsImageAction &ia = *(SLdsImageAction *)(bsImage.bs_pData + ihValid.ih_tblActions.it_iOffset);
+  const int iValidType = ia.ia_iType;
+
+  ia.ia_iType = LCA_SIZEOF;
+  LDS_CHECK(!ReadImage(lds, bsImage, pgLoaded));
+
+  // jump outside of the program
+  ia.ia_iType = iValidType;
+  bool bJump = false;
+
+  for (int iAction = 0; iAction < ihValid.ih_tblActions.it_ctCount; iAction++) {
+    SLdsImageAction &iaJump = (&ia)[iAction];
+
+    if (iaJump.ia_iType == LCA_JUMP) {
+      iaJump.ia_iArg = ihValid.ih_ctMain + 100;
+      bJump = true;
+      break;
+    }
+  }
+
+  LDS_CHECK(bJump);
+  LDS_CHECK(!ReadImage(lds, bsImage, pgLoaded));
+
+  return LDS_TEST_RESULT;
+};
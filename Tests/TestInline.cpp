@@ -0,0 +1,215 @@
+/* Copyright (c) 2021 Dreamy Cecil
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+// Expansion of inline function calls in the main program
+
+#include "LdsTest.h"
+
+// Amount of actions of some type in the main program
+static int CountActions(CLdsProgram &pg, const int &iType) {
+  CActionList &aca = pg.Actions();
+  int ctActions = 0;
+
+  for (int iAction = 0; iAction < aca.Count(); iAction++) {
+    if (aca[iAction].lt_eType == iType) {
+      ctActions++;
+    }
+  }
+
+  return ctActions;
+};
+
+// Compile the script and run it (returns the result)
+static string RunScript(CLdsScriptEngine &lds, const char *strScript, CLdsProgram &pg, LONG64 &ctActions) {
+  LDS_CHECK(lds.LdsCompileScript(strScript, pg) == LER_OK);
+
+  CLdsQuickRun qr(lds, pg);
+  LDS_CHECK(qr.GetStatus() == ETS_FINISHED);
+
+  ctActions = qr.qr_psthThread->sth_ctActions;
+  return qr.GetResult()->Print();
+};
+
+// Small function that gets expanded
+static const char *_strSmall =
+  "var iSum = 0;\n"
+  "for (var i = 0; i < 10; i++) {\n"
+  "  iSum += Twice(i);\n"
+  "}\n"
+  "return iSum;\n"
+  "function Twice(iValue) {\n"
+  "  return iValue * 2;\n"
+  "};\n";
+
+// Function with a loop that stays a call
+static const char *_strLoop =
+  "var ct = 0;\n"
+  "for (var i = 2; i <= 20; i++) {\n"
+  "  if (IsPrime(i)) { ct++; }\n"
+  "}\n"
+  "return ct;\n"
+  "function IsPrime(iNumber) {\n"
+  "  for (var iLower = 2; iLower < iNumber; iLower++) {\n"
+  "    if (iNumber % iLower == 0) { return false; }\n"
+  "  }\n"
+  "  return true;\n"
+  "};\n";
+
+// Function that reads a variable of the caller before defining its own one with the same name
+static const char *_strCallerVar =
+  "var x = 5;\n"
+  "return F();\n"
+  "function F() {\n"
+  "  var y = x;\n"
+  "  var x = 1;\n"
+  "  return y + x;\n"
+  "};\n";
+
+// Function that defines a local in a branch and uses the caller's variable after it
+static const char *_strBranchVar =
+  "var x = 5;\n"
+  "return F(0);\n"
+  "function F(b) {\n"
+  "  if (b) { var x = 1; }\n"
+  "  return x;\n"
+  "};\n";
+
+// Constant local that is defined again on each pass of the loop
+static const char *_strLoopConst =
+  "var iSum = 0;\n"
+  "for (var i = 0; i < 3; i++) {\n"
+  "  const c = i;\n"
+  "  iSum += c;\n"
+  "}\n"
+  "return iSum;\n";
+
+// Recursive function that stays a call
+static const char *_strRecursive =
+  "return Factorial(5);\n"
+  "function Factorial(i) {\n"
+  "  if (i <= 1) { return 1; }\n"
+  "  return i * Factorial(i - 1);\n"
+  "};\n";
+
+// Script that is compiled by a pure function during compilation of another script
+static const char *_strNested =
+  "return Half(8);\n"
+  "function Half(i) {\n"
+  "  return i / 2;\n"
+  "};\n";
+
+// Function body with a pure call that compiles another script in the middle of its expansion
+static const char *_strOuter =
+  "return Sum(1);\n"
+  "function Sum(x) {\n"
+  "  var y = Nested();\n"
+  "  return x + y;\n"
+  "};\n";
+
+// Compile and run another script in a separate engine
+static LDS_FUNC(LDS_Nested) {
+  CLdsScriptEngine ldsNested;
+  CLdsProgram pg;
+
+  if (ldsNested.LdsCompileScript(_strNested, pg) != LER_OK) {
+    return -1;
+  }
+
+  CLdsQuickRun qr(ldsNested, pg);
+  return qr.GetResult();
+};
+
+int main(void) {
+  CLdsScriptEngine lds;
+  CLdsProgram pgInlined, pgCalled;
+  LONG64 ctInlined, ctCalled;
+
+  // small function is expanded with its argument as a local variable
+  LDS_CHECK(RunScript(lds, _strSmall, pgInlined, ctInlined) == "90");
+  LDS_CHECK(CountActions(pgInlined, LCA_INLINE) == 0);
+  LDS_CHECK(CountActions(pgInlined, LCA_RETURN) == 1);
+
+  bool bArgLocal = false;
+  CActionList &aca = pgInlined.Actions();
+
+  for (int iAction = 0; iAction < aca.Count(); iAction++) {
+    if (aca[iAction].lt_eType == LCA_VAR && aca[iAction]->GetString() == "Twice:iValue") {
+      bArgLocal = true;
+    }
+  }
+
+  LDS_CHECK(bArgLocal);
+
+  // same result without expansion but with more actions
+  lds._ctInlineNodes = 0;
+
+  LDS_CHECK(RunScript(lds, _strSmall, pgCalled, ctCalled) == "90");
+  LDS_CHECK(CountActions(pgCalled, LCA_INLINE) == 1);
+  LDS_CHECK(ctInlined <= ctCalled);
+
+  lds._ctInlineNodes = LDS_INLINE_NODES;
+
+  // functions with loops aren't expanded
+  LDS_CHECK(RunScript(lds, _strLoop, pgInlined, ctInlined) == "8");
+  LDS_CHECK(CountActions(pgInlined, LCA_INLINE) == 1);
+
+  lds._ctInlineNodes = 0;
+
+  LDS_CHECK(RunScript(lds, _strLoop, pgCalled, ctCalled) == "8");
+  LDS_CHECK(ctInlined == ctCalled);
+
+  lds._ctInlineNodes = LDS_INLINE_NODES;
+
+  // recursive functions aren't expanded
+  LDS_CHECK(RunScript(lds, _strRecursive, pgInlined, ctInlined) == "120");
+  LDS_CHECK(CountActions(pgInlined, LCA_INLINE) == 1);
+
+  // functions that use variables of the caller aren't expanded
+  LDS_CHECK(RunScript(lds, _strCallerVar, pgInlined, ctInlined) == "6");
+  LDS_CHECK(CountActions(pgInlined, LCA_INLINE) == 1);
+
+  LDS_CHECK(RunScript(lds, _strBranchVar, pgInlined, ctInlined) == "5");
+  LDS_CHECK(CountActions(pgInlined, LCA_INLINE) == 1);
+
+  // script locals are still added again instead of being reset like the ones of expanded functions
+  CLdsProgram pgConst;
+  LDS_CHECK(lds.LdsCompileScript(_strLoopConst, pgConst) == LER_OK);
+
+  CLdsQuickRun qrConst(lds, pgConst);
+  LDS_CHECK(qrConst.GetStatus() == ETS_ERROR);
+
+  // compiling in another engine doesn't affect expansion of the current function
+  CLdsScriptEngine ldsOuter;
+
+  CLdsFuncMap mapFunc;
+  mapFunc.Add("Nested") = SLdsFunc(0, &LDS_Nested, true);
+  ldsOuter.SetCustomFunctions(mapFunc);
+
+  LDS_CHECK(RunScript(ldsOuter, _strOuter, pgInlined, ctInlined) == "5");
+  LDS_CHECK(CountActions(pgInlined, LCA_INLINE) == 0);
+
+  // functions over the limit aren't expanded
+  lds._ctInlineNodes = 2;
+
+  LDS_CHECK(RunScript(lds, _strSmall, pgCalled, ctCalled) == "90");
+  LDS_CHECK(CountActions(pgCalled, LCA_INLINE) == 1);
+
+  return LDS_TEST_RESULT;
+};
@@ -0,0 +1,144 @@
+/* Copyright (c) 2021 Dreamy Cecil
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+// Native code of hot loops compared against the interpreter
+
+#include "LdsTest.h"
+
+// Result of running the script in one engine
+struct SJitRun {
+  EThreadStatus eStatus;
+  ELdsError eError;
+  string strResult;
+  LONG64 ctActions;
+  int ctCompiled; // how many times native code has been compiled
+};
+
+// Compile the script and run it with some JIT threshold (0 for the interpreter only)
+static SJitRun RunScript(const char *strScript, const int &ctHits, const LONG64 &ctQuota) {
+  CLdsScriptEngine lds;
+  lds._ctJitHits = ctHits;
+  lds._qtThreads.qt_ctActions = ctQuota;
+
+  SJitRun run;
+  run.ctCompiled = 0;
+
+  CLdsProgram pg;
+  LDS_CHECK(lds.LdsCompileScript(strScript, pg) == LER_OK);
+
+  CLdsQuickRun qr(lds, pg);
+  run.eStatus = qr.GetStatus();
+  run.eError = qr.qr_psthThread->sth_eError;
+  run.strResult = qr.GetResult()->Print();
+  run.ctActions = qr.qr_psthThread->sth_ctActions;
+
+  SLdsJitData *pjd = pg.Jit();
+
+  if (pjd != NULL) {
+    for (int iSpot = 0; iSpot < pjd->jd_aSpots.Count(); iSpot++) {
+      run.ctCompiled += pjd->jd_aSpots[iSpot].js_ctCompiled;
+    }
+  }
+
+  return run;
+};
+
+// Run the script with and without native code and compare the results (returns native code run)
+static SJitRun CompareRuns(const char *strScript, const LONG64 &ctQuota = 0) {
+  SJitRun runInterp = RunScript(strScript, 0, ctQuota);
+  SJitRun runJit = RunScript(strScript, 1, ctQuota);
+
+  LDS_CHECK(runInterp.ctCompiled == 0);
+  LDS_CHECK(runJit.eStatus == runInterp.eStatus);
+  LDS_CHECK(runJit.eError == runInterp.eError);
+
+#if LDS_JIT
+  LDS_CHECK(runJit.ctCompiled > 0);
+#endif
+
+  // limits are only checked before jumping back
+  if (ctQuota <= 0) {
+    LDS_CHECK(runJit.strResult == runInterp.strResult);
+    LDS_CHECK(runJit.ctActions == runInterp.ctActions);
+  }
+
+  return runJit;
+};
+
+// Integer arithmetic
+static const char *_strArithmetic =
+  "var s = 0;\n"
+  "for (var i = 1; i < 200; i++) {\n"
+  "  s = s + i * 3 - (i div 2) + (i mod 7) + i / 3;\n"
+  "  s = s + (i << 2) - (i >> 1) + (i & 5) + (i | 2) + (i ^ 3);\n"
+  "  if (i >= 100 && i != 150) { s = s - 1; }\n"
+  "}\n"
+  "return s;\n";
+
+// Integer division by zero
+static const char *_strDivZero =
+  "var s = 0;\n"
+  "var z = 0;\n"
+  "for (var i = 1; i < 100; i++) {\n"
+  "  s = s + (i div z) + (i mod z) + 1;\n"
+  "}\n"
+  "return s;\n";
+
+// Loop that runs longer than native code may run at once
+static const char *_strLongLoop =
+  "var s = 0;\n"
+  "for (var i = 0; i < 300000; i++) {\n"
+  "  s = s + 2;\n"
+  "}\n"
+  "return s;\n";
+
+// Variable that becomes a float in the middle of the loop
+static const char *_strTypeChange =
+  "var x = 0;\n"
+  "for (var i = 0; i < 100; i++) {\n"
+  "  x = x + 1;\n"
+  "  if (i == 50) { x = 2.5; }\n"
+  "}\n"
+  "return x;\n";
+
+int main(void) {
+  CompareRuns(_strArithmetic);
+  CompareRuns(_strDivZero);
+
+  // native code returns to the interpreter after spending its budget
+  LDS_CHECK(CompareRuns(_strLongLoop).strResult == "600000");
+
+  // quota is reached in native code
+  const LONG64 ctQuota = 5000;
+  SJitRun runQuota = CompareRuns(_strLongLoop, ctQuota);
+
+  LDS_CHECK(runQuota.eStatus == ETS_ERROR);
+  LDS_CHECK(runQuota.ctActions >= ctQuota && runQuota.ctActions < ctQuota + 100);
+
+  // native code is dropped and compiled again for the new type
+  SJitRun runType = CompareRuns(_strTypeChange);
+  LDS_CHECK(runType.strResult == "51.5");
+
+#if LDS_JIT
+  LDS_CHECK(runType.ctCompiled > 1);
+#endif
+
+  return LDS_TEST_RESULT;
+};
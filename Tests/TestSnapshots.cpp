@@ -0,0 +1,134 @@
+/* Copyright (c) 2021 Dreamy Cecil
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+// Compaction of delta snapshots
+
+#include "LdsTest.h"
+
+// Script that changes a global variable between pauses
+static const char *_strScript =
+  "gVar = 1;\n"
+  "Wait(1);\n"
+  "gVar = 2;\n"
+  "Wait(1);\n"
+  "gVar = 3;\n"
+  "Wait(1);\n"
+  "gVar = 4;\n";
+
+// Prepare the engine for snapshots
+static void SetupEngine(CLdsScriptEngine &lds) {
+  lds.LdsBufferStreamFunctions();
+
+  CLdsVars aVars;
+  aVars.Add() = SLdsVar("gVar", 0);
+  lds.SetCustomVariables(aVars);
+};
+
+// Current value of the global variable
+static string GlobalValue(CLdsScriptEngine &lds) {
+  SLdsVar *pvar = lds._aLdsVariables.Find("gVar");
+  return (pvar != NULL ? pvar->var_valValue->Print() : "");
+};
+
+int main(void) {
+  CLdsScriptEngine lds;
+  SetupEngine(lds);
+
+  CLdsProgram pgProgram;
+  LDS_CHECK(lds.LdsCompileScript(_strScript, pgProgram) == LER_OK);
+
+  CLdsVars aArgs;
+  CLdsThread *psth = lds.ThreadCreate(pgProgram, aArgs);
+  psth->Run(&psth);
+
+  // base snapshot and deltas after each pause
+  CLdsBufferStream bsBase, bsDelta1, bsDelta2, bsDelta3;
+  lds.LdsWriteSnapshot(&bsBase, false);
+
+  lds.HandleThreads(lds._iThreadTickRate);
+  lds.LdsWriteSnapshot(&bsDelta1, true);
+
+  lds.HandleThreads(lds._iThreadTickRate * 2);
+  lds.LdsWriteSnapshot(&bsDelta2, true);
+
+  // thread finishes
+  lds.HandleThreads(lds._iThreadTickRate * 3);
+  lds.LdsWriteSnapshot(&bsDelta3, true);
+
+  const int iVersion = lds._iStateVersion;
+
+  LDS_CHECK(GlobalValue(lds) == "4");
+  LDS_CHECK(lds._athhThreadHandlers.Count() == 0);
+
+  // compact the base with the first two deltas
+  CLdsBufferStream bsCompact;
+  void *apDeltas[2] = { &bsDelta1, &bsDelta2 };
+
+  lds.LdsCompactSnapshots(&bsBase, apDeltas, 2, &bsCompact);
+
+  // live state stays the same
+  LDS_CHECK(lds._iStateVersion == iVersion);
+  LDS_CHECK(GlobalValue(lds) == "4");
+  LDS_CHECK(lds._athhThreadHandlers.Count() == 0);
+
+  // compacted snapshot has the state after the second delta
+  CLdsScriptEngine ldsRestored;
+  SetupEngine(ldsRestored);
+
+  ldsRestored.LdsReadSnapshot(&bsCompact);
+
+  LDS_CHECK(GlobalValue(ldsRestored) == "3");
+  LDS_CHECK(ldsRestored._athhThreadHandlers.Count() == 1);
+
+  // following deltas still apply to it
+  ldsRestored.LdsReadSnapshot(&bsDelta3);
+
+  LDS_CHECK(GlobalValue(ldsRestored) == "4");
+  LDS_CHECK(ldsRestored._athhThreadHandlers.Count() == 0);
+  LDS_CHECK(ldsRestored._iStateVersion == iVersion);
+
+  // engine streams of another format version aren't read
+  CLdsBufferStream bsEngine;
+  lds.LdsWriteEngine(&bsEngine);
+  LDS_CHECK(LdsBufferTell(&bsEngine) == (int)bsEngine.bs_ctSize);
+
+  CLdsScriptEngine ldsEngine;
+  ldsEngine.LdsBufferStreamFunctions();
+
+  ldsEngine.LdsReadEngine(&bsEngine);
+  LDS_CHECK(GlobalValue(ldsEngine) == "4");
+
+  ((int *)bsEngine.bs_pData)[1] = LDS_STREAM_VERSION - 1;
+  bsEngine.Rewind();
+  LDS_CHECK(LdsBufferTell(&bsEngine) == 0);
+
+  ELdsError eError = LER_OK;
+
+  try {
+    ldsEngine.LdsReadEngine(&bsEngine);
+
+  } catch (SLdsError leError) {
+    eError = leError.le_eError;
+  }
+
+  LDS_CHECK(eError == LER_READ);
+
+  return LDS_TEST_RESULT;
+};
@@ -0,0 +1,71 @@
+/* Copyright (c) 2021 Dreamy Cecil
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+// Inline function calls that replace the current call
+
+#include "LdsTest.h"
+
+// Compile the script and run it (returns the result)
+static string RunScript(const char *strScript, const int &ctInlineNodes) {
+  CLdsScriptEngine lds;
+  lds._ctInlineNodes = ctInlineNodes;
+
+  // stop endless calls instead of hanging
+  lds._qtThreads.qt_ctActions = 100000;
+
+  CLdsProgram pg;
+  LDS_CHECK(lds.LdsCompileScript(strScript, pg) == LER_OK);
+
+  CLdsQuickRun qr(lds, pg);
+  LDS_CHECK(qr.GetStatus() == ETS_FINISHED);
+
+  return qr.GetResult()->Print();
+};
+
+// Tail call from another function while an outer call of the same function is still running
+static const char *_strOuterCall =
+  "return B(1);\n"
+  "function B(x) {\n"
+  "  if (x > 1) { return x; }\n"
+  "  var r = A(x + 1);\n"
+  "  return r;\n"
+  "};\n"
+  "function A(y) {\n"
+  "  return B(y + 5);\n"
+  "};\n";
+
+// Function that calls itself in place
+static const char *_strSelfCall =
+  "return Sum(100, 0);\n"
+  "function Sum(i, iTotal) {\n"
+  "  if (i <= 0) { return iTotal; }\n"
+  "  return Sum(i - 1, iTotal + i);\n"
+  "};\n";
+
+int main(void) {
+  // arguments of the outer call are replaced
+  LDS_CHECK(RunScript(_strOuterCall, 0) == "7");
+  LDS_CHECK(RunScript(_strOuterCall, LDS_INLINE_NODES) == "7");
+
+  LDS_CHECK(RunScript(_strSelfCall, 0) == "5050");
+  LDS_CHECK(RunScript(_strSelfCall, LDS_INLINE_NODES) == "5050");
+
+  return LDS_TEST_RESULT;
+};
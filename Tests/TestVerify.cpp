@@ -0,0 +1,74 @@
+/* Copyright (c) 2021 Dreamy Cecil
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+// Programs that are changed after verification
+
+#include "LdsTest.h"
+
+int main(void) {
+  CLdsScriptEngine lds;
+
+  CLdsProgram pg;
+  LDS_CHECK(lds.LdsCompileScript("var i = 2;\nreturn i * 3;\n", pg) == LER_OK);
+  LDS_CHECK(pg.IsVerified());
+
+  // shared copy keeps the original verified
+  CLdsProgram pgChanged = pg;
+  CActionList &aca = pgChanged.Modify();
+
+  LDS_CHECK(pg.IsVerified());
+  LDS_CHECK(!pgChanged.IsVerified());
+  LDS_CHECK(!pgChanged.SharesWith(pg));
+
+  // take away the first operand of the multiplication
+  int iBin = -1;
+
+  for (int iAction = 0; iAction < aca.Count(); iAction++) {
+    if (aca[iAction].lt_eType == LCA_BIN || aca[iAction].lt_eType == LCA_BIN_NUM) {
+      iBin = iAction;
+      break;
+    }
+  }
+
+  LDS_CHECK(iBin >= 2);
+
+  if (iBin >= 2) {
+    aca.Delete(iBin - 2);
+  }
+
+  // changed program is checked while running instead of crashing
+  CLdsQuickRun qrChanged(lds, pgChanged);
+  LDS_CHECK(qrChanged.GetStatus() == ETS_ERROR);
+
+  // original program still works
+  CLdsQuickRun qr(lds, pg);
+  LDS_CHECK(qr.GetStatus() == ETS_FINISHED);
+  LDS_CHECK(qr.GetResult()->Print() == "6");
+
+  // unique program is changed in place
+  CLdsProgram pgUnique;
+  LDS_CHECK(lds.LdsCompileScript("return 1;\n", pgUnique) == LER_OK);
+  LDS_CHECK(pgUnique.IsVerified());
+
+  pgUnique.Modify();
+  LDS_CHECK(!pgUnique.IsVerified());
+
+  return LDS_TEST_RESULT;
+};
@@ -52,10 +52,22 @@ enum ELdsAction {
   LCA_DUP, // duplicate the last entry
   
   LCA_DIR, // thread directive
+
+  LCA_SWITCH_TABLE, // jump table for the following switch cases (arg: amount of cases)
+  LCA_TAILCALL, // inline function call that replaces the current one (returning its result)
+  LCA_BIN_NUM, // binary operation on numbers of expected types (arg: LDS_BIN_NUM_ARG)
   
   LCA_SIZEOF,
 };
 
+// Argument of LCA_BIN_NUM made out of the operation and types of both operands (EVT_INDEX or EVT_FLOAT)
+#define LDS_BIN_NUM_ARG(_Operation, _Type1, _Type2) (((_Operation) << 2) | ((_Type1) << 1) | (_Type2))
+
+// Parts of the LCA_BIN_NUM argument
+#define LDS_BIN_NUM_OP(_Arg) ((_Arg) >> 2)
+#define LDS_BIN_NUM_TYPE1(_Arg) (((_Arg) >> 1) & 1)
+#define LDS_BIN_NUM_TYPE2(_Arg) ((_Arg) & 1)
+
 // Action names
 static const char *_astrActionNames[LCA_SIZEOF] = {
   "UNKNOWN",
@@ -63,28 +75,72 @@ static const char *_astrActionNames[LCA_SIZEOF] = {
   "SET", "GET", "SET_ACCESS",
   "JUMP", "JUMPIF", "JUMPUNLESS", "AND", "OR", "SWITCH",
   "RETURN", "DISCARD", "DUP", "DIR",
+  "SWITCH_TABLE", "TAILCALL", "BIN_NUM",
+};
+
+// Jump table made out of constant switch cases
+struct LDS_API SLdsJumpTable {
+  bool jt_bValid; // cases can be used for the table
+  int jt_iMin; // lowest integer case
+  DSArray<int> jt_aiJumps; // positions for integer cases starting from the lowest one (-1 if no case)
+  CLdsSymbolTable jt_stStrings; // string cases
+  DSList<int> jt_aiStringJumps; // positions for string cases by their IDs
+
+  // Constructor
+  SLdsJumpTable(void) : jt_bValid(false), jt_iMin(0) {};
+
+  // Make the table from cases that follow the table action
+  void Build(CActionList &aca, const int &iTable);
+
+  // Find position for some value (-1 if no case)
+  int Find(CLdsValue &val);
 };
 
 // Compiler action
 class LDS_API CCompAction : public CLdsToken {
   public:
     SLdsInlineFunc ca_inFunc; // inline function
+    SLdsJumpTable *ca_pjtTable; // jump table for LCA_SWITCH_TABLE (made on first use)
     
     // Default constructor
-    CCompAction(void) : CLdsToken() {};
+    CCompAction(void) : CLdsToken(), ca_pjtTable(NULL) {};
     
     // Constructors
     CCompAction(const int &iType, const int &iLine, const int &iArg) :
-      CLdsToken(iType, iLine, iArg) {};
+      CLdsToken(iType, iLine, iArg), ca_pjtTable(NULL) {};
       
     CCompAction(const int &iType, const int &iLine, const CLdsValue &val, const int &iArg) :
-      CLdsToken(iType, iLine, val, iArg) {};
+      CLdsToken(iType, iLine, val, iArg), ca_pjtTable(NULL) {};
+
+    // Copy constructor
+    // Jump table isn't copied on purpose: actions are copied into unique programs that are about to be changed
+    // (same as native code and stack size in CLdsProgram::Modify), so old jump positions can't be trusted
+    CCompAction(const CCompAction &caOther) :
+      CLdsToken(caOther), ca_inFunc(caOther.ca_inFunc), ca_pjtTable(NULL) {};
+
+    // Destructor
+    ~CCompAction(void) {
+      ClearTable();
+    };
 
     // Assignment
     CCompAction &operator=(const CCompAction &caOther) {
+      if (this == &caOther) {
+        return *this;
+      }
+
       CLdsToken::operator=(caOther);
 
       ca_inFunc = caOther.ca_inFunc;
+      ClearTable();
       return *this;
     };
+
+    // Delete the jump table
+    inline void ClearTable(void) {
+      if (ca_pjtTable != NULL) {
+        delete ca_pjtTable;
+        ca_pjtTable = NULL;
+      }
+    };
 };
@@ -21,13 +21,18 @@ SOFTWARE. */
 #include "StdH.h"
 #include "LdsBuildNode.h"
 
-// Copy from another node
+#include <new>
+
+// Arena for nodes that are being built
+extern CBuildNodeArena *_pbnaCurrent = NULL;
+
+// Copy from another node (shares referenced nodes)
 CBuildNode &CBuildNode::operator=(const CBuildNode &bnOther) {
   if (this == &bnOther) {
     return *this;
   }
       
-  // delete old pointers
+  // forget old nodes
   RemoveReferences(-1);
 
   // copy parameters
@@ -36,49 +41,50 @@ CBuildNode &CBuildNode::operator=(const CBuildNode &bnOther) {
   lt_iArg = bnOther.lt_iArg;
   lt_valValue = bnOther.lt_valValue;
 
-  // copy referenced nodes
+  // share referenced nodes
   CopyNodes(bnOther.bn_abnNodes);
 
   return *this;
 };
 
-// Add new node reference
+// Add new node reference (copies the node into the current arena)
 void CBuildNode::AddReference(CBuildNode *pbn) {
-  if (pbn != NULL) {
-    bn_abnNodes.Add(new CBuildNode(*pbn));
+  if (pbn == NULL) {
+    return;
   }
+
+  if (_pbnaCurrent == NULL) {
+    LdsThrow(LEC_NODE, "Cannot reference build nodes outside of compilation");
+  }
+
+  // only the node itself is copied because referenced nodes never change
+  bn_abnNodes.Add(_pbnaCurrent->New(*pbn));
 };
 
 // Remove node references
 void CBuildNode::RemoveReferences(int iPos) {
   // remove one node
   if (iPos != -1) {
-    delete bn_abnNodes[iPos];
     bn_abnNodes.Delete(iPos);
     return;
   }
 
-  // remove all nodes
-  int ctNodes = bn_abnNodes.Count();
-
-  while (ctNodes-- > 0) {
-    delete bn_abnNodes[0];
-    bn_abnNodes.Delete(0);
-  }
+  // remove all nodes (they are freed with the arena)
+  bn_abnNodes.Clear();
 };
 
-// Copy nodes from some dynamic list
+// Share nodes from some dynamic list
 int CBuildNode::CopyNodes(const CDynamicNodeList &abnNodes) {
   int ctNodes = abnNodes.Count();
 
   for (int iNode = 0; iNode < ctNodes; iNode++) {
-    AddReference(abnNodes[iNode]);
+    bn_abnNodes.Add(abnNodes[iNode]);
   }
 
   return ctNodes;
 };
     
-// Copy nodes from some list
+// Copy nodes from some list into the current arena
 int CBuildNode::CopyNodes(CNodeList &abnNodes) {
   int ctNodes = abnNodes.Count();
 
@@ -150,4 +156,47 @@ string CBuildNode::Print(string strTab) {
   str += strTab + "}==\n";
 
   return str;
-};
\ No newline at end of file
+};
+
+// Create a copy of the node in the arena
+CBuildNode *CBuildNodeArena::New(const CBuildNode &bn) {
+  // allocate a new chunk without constructing the nodes
+  if (bna_ctUsed >= LDS_NODE_CHUNK) {
+    bna_apChunks.Add((CBuildNode *)::operator new(sizeof(CBuildNode) * LDS_NODE_CHUNK));
+    bna_ctUsed = 0;
+  }
+
+  CBuildNode *pbnChunk = bna_apChunks[bna_apChunks.Count() - 1];
+
+  return new (pbnChunk + bna_ctUsed++) CBuildNode(bn);
+};
+
+// Free all nodes
+void CBuildNodeArena::Clear(void) {
+  const int ctChunks = bna_apChunks.Count();
+
+  for (int iChunk = 0; iChunk < ctChunks; iChunk++) {
+    CBuildNode *pbnChunk = bna_apChunks[iChunk];
+
+    // only the last chunk may be partially used
+    int ctNodes = (iChunk == ctChunks - 1 ? bna_ctUsed : LDS_NODE_CHUNK);
+
+    for (int iNode = 0; iNode < ctNodes; iNode++) {
+      pbnChunk[iNode].~CBuildNode();
+    }
+
+    ::operator delete(pbnChunk);
+  }
+
+  bna_apChunks.Clear();
+  bna_ctUsed = LDS_NODE_CHUNK;
+};
+
+// Amount of nodes in the arena
+int CBuildNodeArena::Count(void) const {
+  if (bna_apChunks.Count() <= 0) {
+    return 0;
+  }
+
+  return (bna_apChunks.Count() - 1) * LDS_NODE_CHUNK + bna_ctUsed;
+};
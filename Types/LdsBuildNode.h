@@ -98,10 +98,10 @@ enum EThreadDir {
 #define LBF_NOOPS (1 << 0) // don't apply operations to the expression
 #define LBF_SCOPE (1 << 1) // build only identifiers
 
-// Build Node
+// Build Node (immutable once referenced by another node)
 class LDS_API CBuildNode : public CLdsToken {
   public:
-    // Optional node references
+    // Optional node references (owned by the build node arena)
     CDynamicNodeList bn_abnNodes;
     
     // Default constructor
@@ -116,29 +116,58 @@ class LDS_API CBuildNode : public CLdsToken {
       }
     };
     
-    // Copy constructor
+    // Copy constructor (shares referenced nodes)
     CBuildNode(const CBuildNode &bnOther) : CLdsToken() {
       operator=(bnOther);
     };
-    
-    // Destructor
-    ~CBuildNode(void) {
-      RemoveReferences(-1);
-    };
 
-    // Copy from another node
+    // Copy from another node (shares referenced nodes)
     CBuildNode &operator=(const CBuildNode &bnOther);
 
-    // Add new node reference
+    // Add new node reference (copies the node into the current arena)
     void AddReference(CBuildNode *pbn);
     // Remove node references
     void RemoveReferences(int iPos);
 
-    // Copy nodes from some dynamic list
+    // Share nodes from some dynamic list
     int CopyNodes(const CDynamicNodeList &abnNodes);
-    // Copy nodes from some list
+    // Copy nodes from some list into the current arena
     int CopyNodes(CNodeList &abnNodes);
 
     // Print out the node
     string Print(string strTab);
 };
+
+// Build nodes per chunk of the arena
+#define LDS_NODE_CHUNK 256
+
+// Storage for all build nodes of one compilation that's freed at once
+class LDS_API CBuildNodeArena {
+  private:
+    DSList<CBuildNode *> bna_apChunks; // allocated chunks
+    int bna_ctUsed; // used nodes in the last chunk
+
+  public:
+    // Constructor
+    CBuildNodeArena(void) : bna_ctUsed(LDS_NODE_CHUNK) {};
+
+    // Destructor
+    ~CBuildNodeArena(void) {
+      Clear();
+    };
+
+    // Assignment (illegal)
+    CBuildNodeArena &operator=(const CBuildNodeArena &bnaOther);
+
+    // Create a copy of the node in the arena
+    CBuildNode *New(const CBuildNode &bn);
+
+    // Free all nodes
+    void Clear(void);
+
+    // Amount of nodes in the arena
+    int Count(void) const;
+};
+
+// Arena for nodes that are being built
+LDS_API extern CBuildNodeArena *_pbnaCurrent;
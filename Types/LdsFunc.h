@@ -30,10 +30,14 @@ typedef DSList<string> CLdsInlineArgs;
 struct LDS_API SLdsFunc {
   int ef_iArgs; // amount of arguments
   LdsFuncPtr ef_pFunc; // pointer to the function
+  bool ef_bPure; // always returns the same value for the same arguments and has no side effects
 
   // Constructors
-  SLdsFunc(void) : ef_iArgs(0), ef_pFunc(NULL) {};
-  SLdsFunc(int ct, void *pFunc) : ef_iArgs(ct), ef_pFunc((LdsReturn (*)(CLdsValue *))pFunc) {};
+  SLdsFunc(void) : ef_iArgs(0), ef_pFunc(NULL), ef_bPure(false) {};
+  SLdsFunc(int ct, void *pFunc, bool bPure = false) :
+    ef_iArgs(ct), ef_pFunc((LdsReturn (*)(CLdsValue *))pFunc), ef_bPure(bPure) {};
+  SLdsFunc(int ct, LdsFuncPtr pFunc, bool bPure = false) :
+    ef_iArgs(ct), ef_pFunc(pFunc), ef_bPure(bPure) {};
 };
 
 // Inline function
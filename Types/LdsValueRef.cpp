@@ -48,6 +48,18 @@ CLdsValueRef::CLdsValueRef(void) :
 CLdsValueRef::CLdsValueRef(const CLdsValue &val) :
   vr_val(val), vr_pvar(NULL), vr_pvarAccess(NULL), vr_ubFlags(0) {};
 
+CLdsValueRef::CLdsValueRef(const ILdsValueBase &val) :
+  vr_val(val), vr_pvar(NULL), vr_pvarAccess(NULL), vr_ubFlags(0) {};
+
+CLdsValueRef::CLdsValueRef(const int &i) :
+  vr_val(i), vr_pvar(NULL), vr_pvarAccess(NULL), vr_ubFlags(0) {};
+
+CLdsValueRef::CLdsValueRef(const double &d) :
+  vr_val(d), vr_pvar(NULL), vr_pvarAccess(NULL), vr_ubFlags(0) {};
+
+CLdsValueRef::CLdsValueRef(const string &str) :
+  vr_val(str), vr_pvar(NULL), vr_pvarAccess(NULL), vr_ubFlags(0) {};
+
 CLdsValueRef::CLdsValueRef(const CLdsValue &val, SLdsVar *pvar, SLdsVar *pvarAccess, const LdsFlags &ubFlags) :
   vr_val(val), vr_pvar(pvar), vr_pvarAccess(pvarAccess), vr_ubFlags(ubFlags) {};
 
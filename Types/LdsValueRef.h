@@ -61,6 +61,10 @@ class LDS_API CLdsValueRef {
     // Constructors
     CLdsValueRef(void);
     CLdsValueRef(const CLdsValue &val);
+    CLdsValueRef(const ILdsValueBase &val);
+    CLdsValueRef(const int &i);
+    CLdsValueRef(const double &d);
+    CLdsValueRef(const string &str);
     CLdsValueRef(const CLdsValue &val, SLdsVar *pvar, SLdsVar *pvarAccess, const LdsFlags &ubFlags);
 
     // Assignment
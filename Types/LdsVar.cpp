@@ -96,16 +96,51 @@ int CLdsVars::FindIndex(const string &strVar) const {
   return -1;
 };
 
+// Approximate memory used by the variables and their values
+LdsSize CLdsVars::MemoryUsage(void) const {
+  LdsSize iSize = 0;
+
+  for (int iVar = 0; iVar < aVars.Count(); iVar++) {
+    const SLdsVar &var = aVars[iVar];
+
+    // value shell is a part of the variable
+    iSize += sizeof(SLdsVar) + var.var_strName.capacity() + var.var_valValue->MemoryUsage();
+  }
+
+  return iSize;
+};
+
 // Default constructor
-SLdsVar::SLdsVar(void) : var_strName(""), var_valValue(0), var_bConst(0) {};
+SLdsVar::SLdsVar(void) : var_strName(""), var_valValue(0), var_bConst(0), var_iVersion(0) {
+  LDS_alAllocs.al_acVars.Alloc();
+};
   
 // Property constructor
 SLdsVar::SLdsVar(const string &strName, const CLdsValue &val, const bool &bConst) :
-  var_strName(strName), var_valValue(val), var_bConst(bConst) {};
+  var_strName(strName), var_valValue(val), var_bConst(bConst), var_iVersion(0)
+{
+  LDS_alAllocs.al_acVars.Alloc();
+};
 
 // Value constructor
 SLdsVar::SLdsVar(const CLdsValue &val) :
-  var_strName(""), var_valValue(val), var_bConst(false) {};
+  var_strName(""), var_valValue(val), var_bConst(false), var_iVersion(0)
+{
+  LDS_alAllocs.al_acVars.Alloc();
+};
+
+// Copy constructor
+SLdsVar::SLdsVar(const SLdsVar &varOther) :
+  var_strName(varOther.var_strName), var_valValue(varOther.var_valValue),
+  var_bConst(varOther.var_bConst), var_iVersion(varOther.var_iVersion)
+{
+  LDS_alAllocs.al_acVars.Alloc();
+};
+
+// Destructor
+SLdsVar::~SLdsVar(void) {
+  LDS_alAllocs.al_acVars.Free();
+};
   
 // Mark constants as set
 void SLdsVar::SetConst(void) {
@@ -119,6 +154,7 @@ SLdsVar &SLdsVar::operator=(const SLdsVar &varOther) {
   var_strName = varOther.var_strName;
   var_valValue = varOther.var_valValue;
   var_bConst = varOther.var_bConst;
+  var_iVersion = varOther.var_iVersion;
 
   return *this;
 };
@@ -83,6 +83,9 @@ class LDS_API CLdsVars {
 
     // Get variable index by name
     int FindIndex(const string &strVar) const;
+
+    // Approximate memory used by the variables and their values in bytes
+    LdsSize MemoryUsage(void) const;
 };
 
 // Script variable
@@ -91,6 +94,7 @@ struct LDS_API SLdsVar {
   CLdsValue var_valValue; // value
 
   char var_bConst; // is value constant (0 - no, 1 - yes, not set, 2 - yes, set)
+  int var_iVersion; // snapshot version of the last change (see CLdsScriptEngine::_iStateVersion)
 
   // Default constructor
   SLdsVar(void);
@@ -100,6 +104,12 @@ struct LDS_API SLdsVar {
 
   // Value constructor
   SLdsVar(const CLdsValue &val);
+
+  // Copy constructor
+  SLdsVar(const SLdsVar &varOther);
+
+  // Destructor
+  ~SLdsVar(void);
   
   // Mark constants as set
   void SetConst(void);
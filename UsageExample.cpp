@@ -121,7 +121,7 @@ LDS_FUNC(LDS_UnaryArrayAdd) {
 // Initial LDS setup
 void SetupLDS(void) {
   // hook the error output function
-  _ldsEngine.LdsOutputFunctions(NULL, ErrorOutput);
+  _ldsEngine.LdsOutputFunctions(NULL, (void *)ErrorOutput);
 
   // cache scripts
   _ldsEngine._bUseScriptCaching = true;
@@ -142,12 +142,12 @@ void SetupLDS(void) {
   
   _ldsEngine.SetCustomVariables(aVars);
 
-  // custom unary operations
+  // custom unary operations (pure ones can be computed during compilation)
   CLdsFuncPtrMap mapUnary;
   mapUnary.Add("type") = &LDS_UnaryValueType;
   mapUnary.Add("array_add") = &LDS_UnaryArrayAdd;
 
-  _ldsEngine.SetUnaryOperators(mapUnary);
+  _ldsEngine.SetUnaryOperators(mapUnary, true);
 };
 
 
@@ -184,7 +184,7 @@ static bool RunScript(string strFile, const bool &bInfo)
 
   // display action count
   if (bInfo) {
-    printf("[LDS]: Compiled %d actions\n", pgProgram.acaProgram.Count());
+    printf("[LDS]: Compiled %d actions\n", pgProgram.Count());
 
     if (!_bAllScriptsTest) {
       printf("--------------------------------\n");
@@ -207,9 +207,9 @@ static bool RunScript(string strFile, const bool &bInfo)
     }
 
     // action count
-    int ctActions = qrScript.qr_psthThread->sth_ctActions;
+    LONG64 ctActions = qrScript.qr_psthThread->sth_ctActions;
     
-    printf("[LDS]: Executed %d actions\n", ctActions);
+    printf("[LDS]: Executed %lld actions\n", ctActions);
     printf("[RESULT]: %s\n\n", qrScript.GetResult()->Print().c_str());
   }
 
@@ -217,6 +217,42 @@ static bool RunScript(string strFile, const bool &bInfo)
   return true;
 };
 
+// Transpile one script into C++ source of a script function
+static void TranspileScript(const string &strName) {
+  string strFile = string("TestScripts\\") + strName + ".lds";
+
+  // load script from the file
+  string strScript = "";
+
+  if (!LdsLoadScriptFile(strFile.c_str(), strScript)) {
+    ErrorOutput("Couldn't load the script file\n\n");
+    return;
+  }
+
+  // script becomes a function with the same name
+  string strSource = "";
+  ELdsError eResult = _ldsEngine.LdsTranspileScript(strScript, strName, CLdsInlineArgs(), strSource);
+
+  if (eResult != LER_OK) {
+    printf("\n");
+    return;
+  }
+
+  // save next to the script
+  string strOutput = string("TestScripts\\") + strName + ".cpp";
+  FILE *file = fopen(strOutput.c_str(), "w");
+
+  if (file == NULL) {
+    ErrorOutput("Couldn't create the source file\n\n");
+    return;
+  }
+
+  fputs(strSource.c_str(), file);
+  fclose(file);
+
+  printf("[LDS]: Transpiled into \"%s\"\n\n", strOutput.c_str());
+};
+
 // Test all scripts
 static void RunAllScripts(void) {
   #ifndef WIN32
@@ -311,7 +347,7 @@ int main() {
         } else {
           for (int iCache = 0; iCache < _ldsEngine._mapScriptCache.Count(); iCache++) {
             LdsHash iHash = _ldsEngine._mapScriptCache.GetKey(iCache);
-            CActionList &aca = _ldsEngine._mapScriptCache.GetValue(iCache).pgCache.acaProgram;
+            CActionList &aca = _ldsEngine._mapScriptCache.GetValue(iCache).pgCache.Actions();
 
             printf("%d - %.8X (%d actions)\n", iCache + 1, iHash, aca.Count());
           }
@@ -320,8 +356,17 @@ int main() {
         printf("\n");
         break;
 
+      // transpile one script
+      case 4:
+        printf("Enter script name: ");
+        std::cin >> strInput;
+
+        printf("\n");
+        TranspileScript(strInput);
+        break;
+
       // quit
-      case 4: return 0;
+      case 5: return 0;
 
       default:
         printf("- Invalid action number\n\n");
@@ -132,6 +132,8 @@ CLdsValueRef CLdsArrayType::BinaryOp(CLdsValueRef &valRef1, CLdsValueRef &valRef
       // expand the array
       int ctAdd = val2->GetIndex();
 
+      LdsQuotaValue(double(ctAdd) * (sizeof(SLdsVar) + sizeof(CLdsIntType)));
+
       while (--ctAdd >= 0) {
         val1->GetVars()->Add();
       }
@@ -159,6 +161,8 @@ CLdsValueRef CLdsArrayType::BinaryOp(CLdsValueRef &valRef1, CLdsValueRef &valRef
       int ctOld = val1->GetVars()->Count();
       int ctNew = int(ctOld * val2->GetNumber());
 
+      LdsQuotaValue(double(val1->MemoryUsage()) * val2->GetNumber());
+
       CLdsVars &aOldArray = *val1->GetVars();
       CLdsArrayType valNewArray(ctNew, 0);
 
@@ -81,6 +81,9 @@ class LDS_API CLdsArrayType : public ILdsValueBase {
 
     // Get variables
     virtual CLdsVars *GetVars(void) { return &aArray; };
+
+    // Approximate memory used by the value
+    virtual LdsSize MemoryUsage(void) { return sizeof(CLdsArrayType) + aArray.MemoryUsage(); };
     
     // Perform a unary operation
     virtual CLdsValueRef UnaryOp(CLdsValueRef &valRef, const CLdsToken &tkn);
@@ -69,6 +69,9 @@ class LDS_API CLdsFloatType : public ILdsValueBase {
     virtual int GetIndex(void) { return (int)dValue; };
     // Get float value
     virtual double GetNumber(void) { return dValue; };
+
+    // Approximate memory used by the value
+    virtual LdsSize MemoryUsage(void) { return sizeof(CLdsFloatType); };
     
     // Perform a unary operation
     virtual CLdsValueRef UnaryOp(CLdsValueRef &valRef, const CLdsToken &tkn);
@@ -69,6 +69,9 @@ class LDS_API CLdsIntType : public ILdsValueBase {
     virtual int GetIndex(void) { return iValue; };
     // Get float value
     virtual double GetNumber(void) { return (double)iValue; };
+
+    // Approximate memory used by the value
+    virtual LdsSize MemoryUsage(void) { return sizeof(CLdsIntType); };
     
     // Perform a unary operation
     virtual CLdsValueRef UnaryOp(CLdsValueRef &valRef, const CLdsToken &tkn);
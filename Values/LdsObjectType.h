@@ -75,6 +75,9 @@ class LDS_API CLdsObjectType : public ILdsValueBase {
     
     // Get variables
     virtual CLdsVars *GetVars(void) { return &aProps; };
+
+    // Approximate memory used by the value
+    virtual LdsSize MemoryUsage(void) { return sizeof(CLdsObjectType) + aProps.MemoryUsage(); };
     
     // Perform a unary operation
     virtual CLdsValueRef UnaryOp(CLdsValueRef &valRef, const CLdsToken &tkn);
@@ -35,7 +35,7 @@ void CLdsStringType::Read(LdsEnginePtr pEngine, void *pStream, CLdsValue &val) {
   string str = "";
   pEngine->LdsReadString(pStream, str);
 
-  strValue = str;
+  val = str;
 };
 
 // Print the value
@@ -78,7 +78,12 @@ CLdsValueRef CLdsStringType::BinaryOp(CLdsValueRef &valRef1, CLdsValueRef &valRe
   switch (iOperation) {
     // append to the string
     case LOP_ADD: {
-      val1 = val1->Print() + val2->Print();
+      string str1 = val1->Print();
+      string str2 = val2->Print();
+
+      LdsQuotaValue(double(str1.length() + str2.length()));
+
+      val1 = str1 + str2;
     } break;
 
     // remove characters from the end
@@ -100,10 +105,15 @@ CLdsValueRef CLdsStringType::BinaryOp(CLdsValueRef &valRef1, CLdsValueRef &valRe
         LdsBinaryError(val1, val2, tkn);
       }
 
+      string str = val1->GetString();
+      int ctCopies = val2->GetIndex();
+
+      LdsQuotaValue(double(str.length()) * ctCopies);
+
       string strMul = "";
 
-      for (int iCopy = 0; iCopy < val2->GetIndex(); iCopy++) {
-        strMul += val1->GetString();
+      for (int iCopy = 0; iCopy < ctCopies; iCopy++) {
+        strMul += str;
       }
 
       val1 = strMul;
@@ -67,6 +67,9 @@ class LDS_API CLdsStringType : public ILdsValueBase {
 
     // Get string value
     virtual string GetString(void) { return strValue; };
+
+    // Approximate memory used by the value
+    virtual LdsSize MemoryUsage(void) { return sizeof(CLdsStringType) + strValue.capacity(); };
     
     // Perform a unary operation
     virtual CLdsValueRef UnaryOp(CLdsValueRef &valRef, const CLdsToken &tkn);
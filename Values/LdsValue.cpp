@@ -44,23 +44,47 @@ string ILdsValueBase::GetString(void) { return ""; };
 // Get variables
 CLdsVars *ILdsValueBase::GetVars(void) { return NULL; };
 
+// Approximate memory used by the value
+LdsSize ILdsValueBase::MemoryUsage(void) {
+  CLdsVars *paVars = GetVars();
+  return sizeof(ILdsValueBase) + (paVars != NULL ? paVars->MemoryUsage() : 0);
+};
+
+// Allocations of the whole process
+extern SLdsAllocStats LDS_alAllocs = SLdsAllocStats();
+
 // Constructor
 CLdsValue::CLdsValue(void) :
-  val_pBase(new CLdsIntType(0)) {};
+  val_pBase(new CLdsIntType(0))
+{
+  LDS_alAllocs.AddValue(EVT_INDEX);
+};
 
 // Value constructor
 CLdsValue::CLdsValue(const ILdsValueBase &val) :
-  val_pBase(val.MakeCopy()) {};
+  val_pBase(val.MakeCopy())
+{
+  LDS_alAllocs.AddValue(val.GetType());
+};
 
 // Simple constructors
 CLdsValue::CLdsValue(const int &i) :
-  val_pBase(new CLdsIntType(i)) {};
+  val_pBase(new CLdsIntType(i))
+{
+  LDS_alAllocs.AddValue(EVT_INDEX);
+};
 
 CLdsValue::CLdsValue(const double &d) :
-  val_pBase(new CLdsFloatType(d)) {};
+  val_pBase(new CLdsFloatType(d))
+{
+  LDS_alAllocs.AddValue(EVT_FLOAT);
+};
 
 CLdsValue::CLdsValue(const string &str) :
-  val_pBase(new CLdsStringType(str)) {};
+  val_pBase(new CLdsStringType(str))
+{
+  LDS_alAllocs.AddValue(EVT_STRING);
+};
 
 // Copy constructor
 CLdsValue::CLdsValue(const CLdsValue &valOther) : val_pBase(NULL) {
@@ -75,6 +99,8 @@ CLdsValue::~CLdsValue(void) {
 // Delete the value
 void CLdsValue::DeleteValue(void) {
   if (val_pBase != NULL) {
+    LDS_alAllocs.RemoveValue(val_pBase->GetType());
+
     delete val_pBase;
     val_pBase = NULL;
   }
@@ -126,6 +152,8 @@ CLdsValue &CLdsValue::operator=(const CLdsValue &valOther) {
   DeleteValue();
   val_pBase = valOther->MakeCopy();
 
+  LDS_alAllocs.AddValue(val_pBase->GetType());
+
   return *this;
 };
 
@@ -133,16 +161,22 @@ CLdsValue &CLdsValue::operator=(const CLdsValue &valOther) {
 void CLdsValue::FromInt(const int &i) {
   DeleteValue();
   val_pBase = new CLdsIntType(i);
+
+  LDS_alAllocs.AddValue(EVT_INDEX);
 };
 
 void CLdsValue::FromFloat(const double &d) {
   DeleteValue();
   val_pBase = new CLdsFloatType(d);
+
+  LDS_alAllocs.AddValue(EVT_FLOAT);
 };
 
 void CLdsValue::FromString(const string &str) {
   DeleteValue();
   val_pBase = new CLdsStringType(str);
+
+  LDS_alAllocs.AddValue(EVT_STRING);
 };
   
 bool CLdsValue::operator==(const CLdsValue &valOther) const {
@@ -80,6 +80,9 @@ class LDS_API ILdsValueBase {
     virtual string GetString(void);
     // Get variables
     virtual CLdsVars *GetVars(void);
+
+    // Approximate memory used by the value in bytes
+    virtual LdsSize MemoryUsage(void);
     
     // Perform a unary operation
     virtual class CLdsValueRef UnaryOp(CLdsValueRef &valRef, const CLdsToken &tkn) = 0;
@@ -117,6 +120,11 @@ class LDS_API CLdsValue {
     // Delete the value
     void DeleteValue(void);
 
+    // Approximate memory used by the value and its shell in bytes
+    inline LdsSize MemoryUsage(void) const {
+      return sizeof(CLdsValue) + val_pBase->MemoryUsage();
+    };
+
     // Quick value access
     inline ILdsValueBase *operator->(void) const {
       return val_pBase;
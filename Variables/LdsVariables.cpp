@@ -35,10 +35,21 @@ void CLdsScriptEngine::SetCustomVariables(CLdsVars &aFrom) {
   
   // add custom variables
   _aLdsVariables.AddFrom(aFrom, true);
+
+  MarkAllChanged();
 };
 
 // Add more variables and replace ones that already exist
 void CLdsScriptEngine::AddCustomVariables(CLdsVars &aFrom) {
   // add custom variables
   _aLdsVariables.AddFrom(aFrom, true);
+
+  MarkAllChanged();
+};
+
+// Mark all variables as changed since the last snapshot
+void CLdsScriptEngine::MarkAllChanged(void) {
+  for (int iVar = 0; iVar < _aLdsVariables.Count(); iVar++) {
+    MarkChanged(_aLdsVariables[iVar]);
+  }
 };